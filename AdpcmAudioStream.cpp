@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <cstring>
+
+#include "AdpcmAudioStream.h"
+#include "AdpcmCodec.h"
+#include "AudioException.h"
+
+namespace Audio
+{
+    namespace
+    {
+        constexpr std::uint32_t NO_BLOCK = ~0u;
+    }
+
+    AdpcmAudioStream::AdpcmAudioStream(const AudioMemory& memory, const AudioFormat& format)
+        : AudioStreamBase( memory, format )
+        , m_header( GetAdpcmHeader( memory.m_data, memory.m_size ) )
+        , m_decodedBlock( NO_BLOCK )
+        , m_samplePos( 0 )
+    {
+        if (!m_header)
+            throw AudioException("Not An ADPCM Buffer");
+        if (m_header->m_numChannels != format.m_channels || format.m_format != audio_format_s16)
+            throw AudioException("ADPCM Stream Format Mismatch");
+
+        m_decoded.resize(std::size_t(ADPCM_DECODE_BLOCKS) * ADPCM_SAMPLES_PER_BLOCK * m_header->m_numChannels);
+    }
+
+    void AdpcmAudioStream::decodeBlocks(std::uint32_t firstBlock)
+    {
+        const auto numBlocks = std::min(ADPCM_DECODE_BLOCKS, m_header->m_numBlocks - firstBlock);
+        DecodeAdpcm(*m_header, firstBlock, numBlocks, m_decoded.data());
+        m_decodedBlock = firstBlock;
+    }
+
+    bool AdpcmAudioStream::seek(std::uint32_t sample)
+    {
+        if (sample > m_header->m_numSamples)
+            return false;
+        m_samplePos = sample;
+        return true;
+    }
+
+    std::uint32_t AdpcmAudioStream::getData(void* dest, std::uint32_t numBytes)
+    {
+        const auto numChannels = m_header->m_numChannels;
+        const auto frameSize   = numChannels * std::uint32_t( sizeof(std::int16_t) );
+        const auto cacheFrames = ADPCM_DECODE_BLOCKS * ADPCM_SAMPLES_PER_BLOCK;
+
+        auto* destPtr = reinterpret_cast<std::int16_t*>( dest );
+        auto  frames  = numBytes / frameSize;
+        std::uint32_t result = 0;
+        while (frames)
+        {
+            if (m_samplePos >= m_header->m_numSamples)
+            {
+                //avoid spinning on an empty asset
+                if (!isLooping() || !m_header->m_numSamples)
+                    break;
+                m_samplePos = 0;
+            }
+
+            const auto block = m_samplePos / ADPCM_SAMPLES_PER_BLOCK;
+            if (m_decodedBlock == NO_BLOCK || block < m_decodedBlock || block >= m_decodedBlock + ADPCM_DECODE_BLOCKS)
+                decodeBlocks(block);
+
+            const auto cacheOffset = m_samplePos - m_decodedBlock * ADPCM_SAMPLES_PER_BLOCK;
+            const auto available   = std::min(cacheFrames - cacheOffset, m_header->m_numSamples - m_samplePos);
+            const auto toCopy      = std::min(available, frames);
+            memcpy(destPtr, &m_decoded[std::size_t(cacheOffset) * numChannels], toCopy * frameSize);
+
+            destPtr     += toCopy * numChannels;
+            frames      -= toCopy;
+            result      += toCopy * frameSize;
+            m_samplePos += toCopy;
+        }
+        return result;
+    }
+
+    std::uint32_t AdpcmAudioStream::getSamplePos() const
+    {
+        return m_samplePos;
+    }
+
+    std::uint32_t AdpcmAudioStream::getTotalSamples() const
+    {
+        return m_header->m_numSamples;
+    }
+
+    std::uint32_t AdpcmAudioStream::numBytesAvailable() const
+    {
+        const auto frameSize = m_header->m_numChannels * std::uint32_t( sizeof(std::int16_t) );
+        return (m_header->m_numSamples - std::min(m_samplePos, m_header->m_numSamples)) * frameSize;
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <vector>
+
+#include "AudioStream.h"
+
+namespace Audio
+{
+    struct AdpcmHeader;
+
+    //blocks decoded per refill, a multiple of four channel blocks for the SIMD decoder
+    constexpr std::uint32_t ADPCM_DECODE_BLOCKS = 4;
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Streams an in-memory IMA ADPCM asset( see AdpcmCodec.h ) as
+    // interleaved s16, decoding a few blocks ahead of the read position
+    //////////////////////////////////////////////////////////////////////////
+    class AdpcmAudioStream : public AudioStreamBase
+    {
+    public:
+        AdpcmAudioStream(const AudioMemory& memory, const AudioFormat& format);
+
+        bool            seek( std::uint32_t sample ) final override;
+        std::uint32_t   getData( void* dest, std::uint32_t numBytes ) final override;
+        std::uint32_t   getSamplePos() const final override;
+
+        /*
+            @brief: Decoded s16 frames & bytes, not the compressed asset size
+        */
+        std::uint32_t   getTotalSamples() const final override;
+        std::uint32_t   numBytesAvailable() const final override;
+
+    private:
+        void            decodeBlocks( std::uint32_t firstBlock );
+
+        const AdpcmHeader*          m_header;
+        std::vector<std::int16_t>   m_decoded;      //ADPCM_DECODE_BLOCKS decoded blocks
+        std::uint32_t               m_decodedBlock; //first block in 'm_decoded'
+        std::uint32_t               m_samplePos;    //per channel
+    };
+}
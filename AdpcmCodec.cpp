@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUDIO_ADPCM_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "AdpcmCodec.h"
+#include "AudioException.h"
+#include "OggFile.h"
+#include "VorbisSetup.h"
+#include "WavFile.h"
+
+namespace Audio
+{
+    namespace
+    {
+        constexpr std::uint8_t ADPCM_MAGIC[4] = { 'I', 'M', 'A', '4' };
+        constexpr int          ADPCM_MAX_INDEX = 88;
+
+        constexpr std::int32_t StepTable[ADPCM_MAX_INDEX + 1] =
+        {
+            7,     8,     9,     10,    11,    12,    13,    14,    16,    17,
+            19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+            50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+            130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+            337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+            876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+            2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+            5894,  6484,  7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
+            15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+        };
+
+        constexpr std::int32_t IndexTable[16] =
+        {
+            -1, -1, -1, -1, 2, 4, 6, 8,
+            -1, -1, -1, -1, 2, 4, 6, 8
+        };
+
+        struct ChannelState
+        {
+            std::int32_t    m_predictor;
+            std::int32_t    m_index;
+        };
+
+        inline void DecodeNibble(std::int32_t nibble, ChannelState& state)
+        {
+            const auto step = StepTable[state.m_index];
+            auto diff = step >> 3;
+            if (nibble & 4) diff += step;
+            if (nibble & 2) diff += step >> 1;
+            if (nibble & 1) diff += step >> 2;
+
+            state.m_predictor += (nibble & 8) ? -diff : diff;
+            state.m_predictor  = std::min(32767, std::max(-32768, state.m_predictor));
+            state.m_index      = std::min(ADPCM_MAX_INDEX, std::max(0, state.m_index + IndexTable[nibble]));
+        }
+
+        inline std::int32_t EncodeNibble(std::int32_t sample, ChannelState& state)
+        {
+            auto step   = StepTable[state.m_index];
+            auto diff   = sample - state.m_predictor;
+            auto nibble = 0;
+            if (diff < 0) {
+                nibble = 8;
+                diff   = -diff;
+            }
+            if (diff >= step) { nibble |= 4; diff -= step; }
+            step >>= 1;
+            if (diff >= step) { nibble |= 2; diff -= step; }
+            step >>= 1;
+            if (diff >= step) { nibble |= 1; }
+
+            //track the decoder so rounding errors do not accumulate
+            DecodeNibble(nibble, state);
+            return nibble;
+        }
+
+        std::int16_t ReadPredictor(const std::uint8_t* channelBlock)
+        {
+            return static_cast<std::int16_t>(channelBlock[0] | (channelBlock[1] << 8));
+        }
+
+        void DecodeChannelBlock(const std::uint8_t* src, std::int16_t* dest, std::uint32_t stride)
+        {
+            ChannelState state = { ReadPredictor(src), std::min<std::int32_t>(src[2], ADPCM_MAX_INDEX) };
+            *dest = static_cast<std::int16_t>(state.m_predictor);
+            dest += stride;
+
+            const auto* nibbles = src + 4;
+            for (std::uint32_t i = 0; i < (ADPCM_SAMPLES_PER_BLOCK - 1) / 2; ++i)
+            {
+                DecodeNibble(nibbles[i] & 0xF, state);
+                *dest = static_cast<std::int16_t>(state.m_predictor);
+                dest += stride;
+                DecodeNibble(nibbles[i] >> 4, state);
+                *dest = static_cast<std::int16_t>(state.m_predictor);
+                dest += stride;
+            }
+        }
+
+#ifdef AUDIO_ADPCM_SSE2
+        //////////////////////////////////////////////////////////////////////////
+        //\Brief: Decodes four independent channel blocks at once, one per lane.
+        // Same integer math as 'DecodeNibble', the step table is the only per
+        // lane lookup
+        //////////////////////////////////////////////////////////////////////////
+        void DecodeChannelBlocksSSE2(const std::uint8_t* const src[4], std::int16_t* const dest[4], std::uint32_t stride)
+        {
+            alignas(16) std::int32_t index[4];
+            alignas(16) std::int16_t out[8];
+
+            const __m128i one   = _mm_set1_epi32(1);
+            const __m128i two   = _mm_set1_epi32(2);
+            const __m128i three = _mm_set1_epi32(3);
+            const __m128i four  = _mm_set1_epi32(4);
+            const __m128i seven = _mm_set1_epi32(7);
+            const __m128i eight = _mm_set1_epi32(8);
+            const __m128i mask  = _mm_set1_epi32(0xF);
+            const __m128i zero  = _mm_setzero_si128();
+            const __m128i maxIndex = _mm_set1_epi32(ADPCM_MAX_INDEX);
+
+            __m128i predictor = _mm_set_epi32(ReadPredictor(src[3]), ReadPredictor(src[2]), ReadPredictor(src[1]), ReadPredictor(src[0]));
+            __m128i stepIndex = _mm_min_epi16(_mm_set_epi32(src[3][2], src[2][2], src[1][2], src[0][2]), maxIndex);
+
+            for (int lane = 0; lane < 4; ++lane)
+                dest[lane][0] = ReadPredictor(src[lane]);
+
+            std::size_t offset = stride;
+            for (std::uint32_t word = 0; word < (ADPCM_SAMPLES_PER_BLOCK - 1) / 8; ++word)
+            {
+                std::uint32_t bits[4];
+                for (int lane = 0; lane < 4; ++lane)
+                    memcpy(&bits[lane], src[lane] + 4 + word * 4, 4);
+                __m128i nibbles = _mm_set_epi32(bits[3], bits[2], bits[1], bits[0]);
+
+                for (int i = 0; i < 8; ++i, offset += stride)
+                {
+                    const __m128i nibble = _mm_and_si128(nibbles, mask);
+                    nibbles = _mm_srli_epi32(nibbles, 4);
+
+                    _mm_store_si128(reinterpret_cast<__m128i*>(index), stepIndex);
+                    const __m128i step = _mm_set_epi32(StepTable[index[3]], StepTable[index[2]], StepTable[index[1]], StepTable[index[0]]);
+
+                    //diff = step/8 + (b2 ? step) + (b1 ? step/2) + (b0 ? step/4)
+                    __m128i diff = _mm_srai_epi32(step, 3);
+                    diff = _mm_add_epi32(diff, _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(nibble, four), four), step));
+                    diff = _mm_add_epi32(diff, _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(nibble, two), two), _mm_srai_epi32(step, 1)));
+                    diff = _mm_add_epi32(diff, _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(nibble, one), one), _mm_srai_epi32(step, 2)));
+
+                    //conditional negate on the sign bit, then saturate to 16 bit
+                    const __m128i sign = _mm_cmpeq_epi32(_mm_and_si128(nibble, eight), eight);
+                    predictor = _mm_add_epi32(predictor, _mm_sub_epi32(_mm_xor_si128(diff, sign), sign));
+                    const __m128i packed = _mm_packs_epi32(predictor, predictor);
+                    predictor = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+
+                    //index += (n & 7) < 4 ? -1 : ((n & 7) - 3) * 2, clamped to [0, 88]
+                    const __m128i magnitude = _mm_and_si128(nibble, seven);
+                    const __m128i large = _mm_cmpgt_epi32(magnitude, three);
+                    const __m128i delta = _mm_or_si128(_mm_and_si128(large, _mm_slli_epi32(_mm_sub_epi32(magnitude, three), 1)),
+                                                       _mm_andnot_si128(large, _mm_set1_epi32(-1)));
+                    //values stay far inside 16 bit, so the 16 bit min/max work per 32 bit lane
+                    stepIndex = _mm_min_epi16(_mm_max_epi16(_mm_add_epi32(stepIndex, delta), zero), maxIndex);
+
+                    _mm_store_si128(reinterpret_cast<__m128i*>(out), packed);
+                    for (int lane = 0; lane < 4; ++lane)
+                        dest[lane][offset] = out[lane];
+                }
+            }
+        }
+#endif
+    }
+
+    const AdpcmHeader* GetAdpcmHeader(const void* data, std::size_t size)
+    {
+        if (size < sizeof(AdpcmHeader))
+            return nullptr;
+
+        const auto* header = static_cast<const AdpcmHeader*>( data );
+        if (memcmp(header->m_magic, ADPCM_MAGIC, sizeof(ADPCM_MAGIC)) != 0 || !header->m_numChannels)
+            return nullptr;
+
+        const auto dataSize = std::uint64_t(header->m_numBlocks) * header->m_numChannels * ADPCM_CHANNEL_BLOCK_SIZE;
+        if (sizeof(AdpcmHeader) + dataSize > size ||
+            std::uint64_t(header->m_numBlocks) * ADPCM_SAMPLES_PER_BLOCK < header->m_numSamples)
+            return nullptr;
+        return header;
+    }
+
+    AudioBufferPtr EncodeAdpcm(const std::int16_t* pcm, std::uint32_t numSamples, std::uint32_t numChannels, std::uint32_t sampleRate)
+    {
+        if (!numChannels)
+            throw AudioException("Invalid Channel Count");
+
+        const auto numBlocks = (numSamples + ADPCM_SAMPLES_PER_BLOCK - 1) / ADPCM_SAMPLES_PER_BLOCK;
+        auto result = std::make_shared<AudioBuffer>( sizeof(AdpcmHeader) + std::size_t(numBlocks) * numChannels * ADPCM_CHANNEL_BLOCK_SIZE );
+
+        auto* header = reinterpret_cast<AdpcmHeader*>( result->data() );
+        memcpy(header->m_magic, ADPCM_MAGIC, sizeof(ADPCM_MAGIC));
+        header->m_numChannels = numChannels;
+        header->m_sampleRate  = sampleRate;
+        header->m_numSamples  = numSamples;
+        header->m_numBlocks   = numBlocks;
+
+        //the tail of the last block repeats the last sample
+        auto getSample = [&](std::uint32_t sample, std::uint32_t channel) -> std::int32_t
+        {
+            if (!numSamples)
+                return 0;
+            return pcm[std::size_t(std::min(sample, numSamples - 1)) * numChannels + channel];
+        };
+
+        auto* dest = reinterpret_cast<std::uint8_t*>( result->data() ) + sizeof(AdpcmHeader);
+        std::vector<ChannelState> states(numChannels, ChannelState{ 0, 0 });
+        for (std::uint32_t block = 0; block < numBlocks; ++block)
+        {
+            const auto first = block * ADPCM_SAMPLES_PER_BLOCK;
+            for (std::uint32_t channel = 0; channel < numChannels; ++channel, dest += ADPCM_CHANNEL_BLOCK_SIZE)
+            {
+                //the step index carries over, the predictor restarts exact
+                auto& state = states[channel];
+                state.m_predictor = getSample(first, channel);
+
+                dest[0] = static_cast<std::uint8_t>(state.m_predictor & 0xFF);
+                dest[1] = static_cast<std::uint8_t>((state.m_predictor >> 8) & 0xFF);
+                dest[2] = static_cast<std::uint8_t>(state.m_index);
+                dest[3] = 0;
+
+                for (std::uint32_t i = 0; i < (ADPCM_SAMPLES_PER_BLOCK - 1) / 2; ++i)
+                {
+                    const auto lo = EncodeNibble(getSample(first + 1 + i * 2, channel), state);
+                    const auto hi = EncodeNibble(getSample(first + 2 + i * 2, channel), state);
+                    dest[4 + i] = static_cast<std::uint8_t>(lo | (hi << 4));
+                }
+            }
+        }
+        return result;
+    }
+
+    AudioBufferPtr EncodeAdpcm(const WavFile& wav)
+    {
+        constexpr std::uint16_t WAVE_FORMAT_PCM = 1;
+
+        const auto& header = wav.m_header;
+        if (header.m_format != WAVE_FORMAT_PCM || header.m_bits != 16 || !header.m_channels || !wav.m_waveData)
+            throw AudioException("Unsupported Wave Format");
+
+        const auto numSamples = static_cast<std::uint32_t>(wav.m_waveData->size() / (2u * header.m_channels));
+        const auto* pcm = reinterpret_cast<const std::int16_t*>( wav.m_waveData->data() );
+        return EncodeAdpcm(pcm, numSamples, header.m_channels, header.m_frequency);
+    }
+
+    AudioBufferPtr EncodeAdpcm(const OggFile& ogg)
+    {
+        if (!ogg.m_setup)
+            throw AudioException("Not A Vorbis File");
+
+        const auto pcmBuffer  = ogg.m_setup->decodeAll();
+        const auto numSamples = static_cast<std::uint32_t>(pcmBuffer->size() / (2u * ogg.m_numChannels));
+        const auto* pcm = reinterpret_cast<const std::int16_t*>( pcmBuffer->data() );
+        return EncodeAdpcm(pcm, numSamples, ogg.m_numChannels, ogg.m_frequency);
+    }
+
+    void DecodeAdpcm(const AdpcmHeader& header, std::uint32_t firstBlock, std::uint32_t numBlocks, std::int16_t* dest)
+    {
+        const auto numChannels = header.m_numChannels;
+        const auto* blocks = reinterpret_cast<const std::uint8_t*>( &header + 1 );
+
+        //channel blocks are independent, walk them in storage order
+        const auto first = std::size_t(firstBlock) * numChannels;
+        const auto count = std::size_t(numBlocks) * numChannels;
+        auto channelBlock = [&](std::size_t i) { return blocks + (first + i) * ADPCM_CHANNEL_BLOCK_SIZE; };
+        auto output       = [&](std::size_t i) { return dest + (i / numChannels) * ADPCM_SAMPLES_PER_BLOCK * numChannels + i % numChannels; };
+
+        std::size_t i = 0;
+#ifdef AUDIO_ADPCM_SSE2
+        for (; i + 4 <= count; i += 4)
+        {
+            const std::uint8_t* src[4] = { channelBlock(i), channelBlock(i + 1), channelBlock(i + 2), channelBlock(i + 3) };
+            std::int16_t* out[4]       = { output(i), output(i + 1), output(i + 2), output(i + 3) };
+            DecodeChannelBlocksSSE2(src, out, numChannels);
+        }
+#endif
+        for (; i < count; ++i)
+            DecodeChannelBlock(channelBlock(i), output(i), numChannels);
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+
+#include "AudioBuffer.h"
+
+namespace Audio
+{
+    struct WavFile;
+    struct OggFile;
+
+    //samples per channel in a block, the first one is stored in the block header
+    constexpr std::uint32_t ADPCM_SAMPLES_PER_BLOCK = 257;
+    //4 byte header( predictor, step index ) followed by two nibbles per byte
+    constexpr std::uint32_t ADPCM_CHANNEL_BLOCK_SIZE = 4 + ( ADPCM_SAMPLES_PER_BLOCK - 1 ) / 2;
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Leading header of an ADPCM asset buffer, followed by the blocks.
+    // A block holds ADPCM_SAMPLES_PER_BLOCK samples of every channel, stored
+    // as one independent channel block after the other
+    //////////////////////////////////////////////////////////////////////////
+    struct AdpcmHeader
+    {
+        std::uint8_t        m_magic[4];      //"IMA4"
+        std::uint32_t       m_numChannels;
+        std::uint32_t       m_sampleRate;
+        std::uint32_t       m_numSamples;    //per channel
+        std::uint32_t       m_numBlocks;
+    };
+
+    /*
+        @brief: Returns the header of an ADPCM asset, nullptr if 'data' does
+        not hold a valid one
+    */
+    const AdpcmHeader*  GetAdpcmHeader( const void* data, std::size_t size );
+
+    /*
+        @brief: IMA ADPCM encode interleaved s16 pcm, ~4:1 compression
+    */
+    AudioBufferPtr      EncodeAdpcm( const std::int16_t* pcm, std::uint32_t numSamples, std::uint32_t numChannels, std::uint32_t sampleRate );
+    AudioBufferPtr      EncodeAdpcm( const WavFile& wav );
+    AudioBufferPtr      EncodeAdpcm( const OggFile& ogg );
+
+    /*
+        @brief: Decodes 'numBlocks' blocks starting at 'firstBlock' to
+        interleaved s16 pcm, 'dest' must hold numBlocks * ADPCM_SAMPLES_PER_BLOCK
+        samples of every channel. Independent channel blocks are decoded four
+        at a time with SSE2 when available
+    */
+    void                DecodeAdpcm( const AdpcmHeader& header, std::uint32_t firstBlock, std::uint32_t numBlocks, std::int16_t* dest );
+}
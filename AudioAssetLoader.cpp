@@ -0,0 +1,299 @@
+#include <new>
+
+#include <IO/FileSystem.h>
+
+#include "AdpcmCodec.h"
+#include "AudioAssetLoader.h"
+#include "AudioConversion.h"
+#include "AudioException.h"
+#include "AudioHelper.h"
+#include "AudioMemoryStats.h"
+#include "OggFile.h"
+#include "VorbisSetup.h"
+#include "WavFile.h"
+
+using namespace Common;
+using namespace IO;
+
+namespace Audio
+{
+    namespace
+    {
+        eAudioLoadError LoadWav(const std::string& path, AudioAsset& asset)
+        {
+            WavFile wav;
+            if (!wav.read(path))
+                return AUDIO_LOAD_INVALID_FILE;
+
+            asset.m_format.m_type       = AUDIO_TYPE_WAV;
+            asset.m_format.m_format     = wav.getSampleFormat();
+            asset.m_format.m_channels   = wav.m_header.m_channels;
+            asset.m_format.m_sampleRate = wav.m_header.m_frequency;
+            if (asset.m_format.m_format == audio_format_unknown || !asset.m_format.m_channels)
+                return AUDIO_LOAD_UNSUPPORTED_FORMAT;
+
+            asset.m_waveData    = wav.m_waveData;
+            asset.m_totalLength = GetLength( std::uint32_t(wav.m_waveData->size()), asset.m_format.m_sampleRate, asset.m_format.getBytesPerSample() );
+            return AUDIO_LOAD_OK;
+        }
+
+        eAudioLoadError LoadOgg(const std::string& path, std::uint32_t flags, AudioMetadataCache& cache, AudioAsset& asset)
+        {
+            OggFile ogg;
+            if (!ogg.read(path, &cache))
+                return AUDIO_LOAD_INVALID_FILE;
+
+            asset.m_format.m_type       = AUDIO_TYPE_OGG;
+            asset.m_format.m_format     = audio_format_s16;
+            asset.m_format.m_channels   = ogg.m_numChannels;
+            asset.m_format.m_sampleRate = ogg.m_frequency;
+            asset.m_totalLength         = ogg.m_totalLength;
+
+            //short assets prepared for the device are decoded by the conversion
+            const bool prepare = (flags & AUDIO_LOAD_PREPARE_FOR_DEVICE) && asset.m_totalLength <= MAX_PREPARED_VORBIS_LENGTH;
+            if ((flags & AUDIO_LOAD_PREDECODE) && !prepare) {
+                //the pool already runs one file per thread, decode on this one only
+                asset.m_waveData        = ogg.m_setup->decodeAll(1);
+                asset.m_format.m_type   = AUDIO_TYPE_WAV;
+            }
+            else {
+                asset.m_waveData = ogg.m_waveData;
+                asset.m_setup    = ogg.m_setup;
+            }
+            return AUDIO_LOAD_OK;
+        }
+
+        void PrepareForDevice(AudioAsset& asset, const AudioConfig& device)
+        {
+            if (asset.m_setup) {
+                if (asset.m_totalLength > MAX_PREPARED_VORBIS_LENGTH)
+                    return;
+                asset.m_waveData = AcquireDeviceBuffer(asset.m_setup, device, 1);
+                asset.m_setup.reset();
+            }
+            else if (asset.m_format.m_type == AUDIO_TYPE_WAV) {
+                asset.m_waveData = AcquireDeviceBuffer(asset.m_waveData, asset.m_format, device);
+            }
+            else {
+                return;
+            }
+            asset.m_format = GetDeviceFormat(asset.m_format, device);
+        }
+
+        eAudioLoadError TranscodeAdpcm(AudioAsset& asset)
+        {
+            //ogg assets are decoded on this thread first, like a pre-decode
+            auto pcm = asset.m_setup ? asset.m_setup->decodeAll(1) : asset.m_waveData;
+            if (asset.m_format.m_format != audio_format_s16 || !pcm)
+                return AUDIO_LOAD_UNSUPPORTED_FORMAT;
+
+            const auto numChannels = asset.m_format.getNumChannels();
+            const auto numSamples  = static_cast<std::uint32_t>(pcm->size() / (sizeof(std::int16_t) * numChannels));
+            asset.m_waveData        = EncodeAdpcm(reinterpret_cast<const std::int16_t*>(pcm->data()), numSamples, numChannels, asset.m_format.m_sampleRate);
+            asset.m_setup.reset();
+            asset.m_format.m_type   = AUDIO_TYPE_ADPCM;
+            return AUDIO_LOAD_OK;
+        }
+
+        AudioAsset LoadAsset(const std::string& path, std::uint32_t flags, const AudioConfig& device, AudioMetadataCache& cache)
+        {
+            AudioAsset asset;
+            asset.m_path = path;
+
+            const auto type = GetAudioType(path);
+            if (type == AUDIO_TYPE_NONE) {
+                asset.m_error = AUDIO_LOAD_UNKNOWN_TYPE;
+                return asset;
+            }
+
+            //nothing escapes the worker, the future must not throw
+            try {
+                if (FileSystem::GetFileSize(path) == 0)
+                    asset.m_error = AUDIO_LOAD_FILE_NOT_FOUND;
+                else
+                    asset.m_error = type == AUDIO_TYPE_WAV ? LoadWav(path, asset) : LoadOgg(path, flags, cache, asset);
+                if (asset.m_error == AUDIO_LOAD_OK && (flags & AUDIO_LOAD_ADPCM))
+                    asset.m_error = TranscodeAdpcm(asset);
+                else if (asset.m_error == AUDIO_LOAD_OK && (flags & AUDIO_LOAD_PREPARE_FOR_DEVICE))
+                    PrepareForDevice(asset, device);
+
+                //decoded & converted data is attributed to the file it came from
+                if (asset.m_error == AUDIO_LOAD_OK)
+                    asset.m_waveData = TrackAudioBuffer(asset.m_waveData, AUDIO_MEMORY_ASSET, path);
+            }
+            catch (const AudioException&) {
+                asset.m_error = AUDIO_LOAD_DECODE_FAILED;
+            }
+            catch (const std::bad_alloc&) {
+                asset.m_error = AUDIO_LOAD_OUT_OF_MEMORY;
+            }
+            catch (const std::exception&) {
+                asset.m_error = AUDIO_LOAD_INVALID_FILE;
+            }
+            catch (...) {
+                asset.m_error = AUDIO_LOAD_INVALID_FILE;
+            }
+
+            if (asset.m_error != AUDIO_LOAD_OK) {
+                asset.m_waveData.reset();
+                asset.m_setup.reset();
+            }
+            return asset;
+        }
+    }
+
+    std::uint32_t AudioLoadBatch::getNumAssets() const
+    {
+        return static_cast<std::uint32_t>(m_futures.size());
+    }
+
+    std::uint32_t AudioLoadBatch::getNumCompleted() const
+    {
+        return m_numCompleted.load(std::memory_order_acquire);
+    }
+
+    std::uint32_t AudioLoadBatch::getNumFailed() const
+    {
+        return m_numFailed.load(std::memory_order_acquire);
+    }
+
+    float AudioLoadBatch::getProgress() const
+    {
+        const auto numAssets = getNumAssets();
+        return numAssets ? float(getNumCompleted()) / float(numAssets) : 1.0f;
+    }
+
+    bool AudioLoadBatch::isDone() const
+    {
+        return getNumCompleted() == getNumAssets();
+    }
+
+    void AudioLoadBatch::wait() const
+    {
+        for (const auto& future : m_futures)
+            future.wait();
+    }
+
+    const AudioAssetFuture& AudioLoadBatch::getFuture(std::uint32_t index) const
+    {
+        return m_futures.at(index);
+    }
+
+    AudioAssetLoader::AudioAssetLoader(std::uint32_t numThreads)
+        : m_device( GetDefaultAudioConfig() )
+        , m_stop( false )
+    {
+        if (!numThreads)
+            numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+        m_workers.reserve(numThreads);
+        for (std::uint32_t i = 0; i < numThreads; ++i)
+            m_workers.emplace_back(&AudioAssetLoader::workerLoop, this);
+    }
+
+    AudioAssetLoader::~AudioAssetLoader()
+    {
+        std::deque<LoadJob> cancelled;
+        {
+            std::unique_lock<Mutex> lock(m_mutex);
+            m_stop = true;
+            cancelled.swap(m_jobs);
+        }
+        m_jobAdded.notify_all();
+        for (auto& worker : m_workers)
+            worker.join();
+
+        for (auto& job : cancelled) {
+            AudioAsset asset;
+            asset.m_path  = job.m_path;
+            asset.m_error = AUDIO_LOAD_CANCELLED;
+            job.m_promise.set_value(std::move(asset));
+            if (job.m_batch) {
+                job.m_batch->m_numFailed.fetch_add(1, std::memory_order_release);
+                job.m_batch->m_numCompleted.fetch_add(1, std::memory_order_release);
+            }
+        }
+    }
+
+    AudioLoadBatchPtr AudioAssetLoader::load(const std::vector<std::string>& paths, std::uint32_t flags)
+    {
+        auto batch = std::make_shared<AudioLoadBatch>();
+        batch->m_futures.reserve(paths.size());
+        {
+            std::unique_lock<Mutex> lock(m_mutex);
+            for (const auto& path : paths) {
+                LoadJob job;
+                job.m_path   = path;
+                job.m_flags  = flags;
+                job.m_device = m_device;
+                job.m_batch  = batch;
+                batch->m_futures.push_back(job.m_promise.get_future().share());
+                m_jobs.push_back(std::move(job));
+            }
+        }
+        m_jobAdded.notify_all();
+        return batch;
+    }
+
+    AudioAssetFuture AudioAssetLoader::load(const std::string& path, std::uint32_t flags)
+    {
+        LoadJob job;
+        job.m_path  = path;
+        job.m_flags = flags;
+        auto future = job.m_promise.get_future().share();
+        {
+            std::unique_lock<Mutex> lock(m_mutex);
+            job.m_device = m_device;
+            m_jobs.push_back(std::move(job));
+        }
+        m_jobAdded.notify_one();
+        return future;
+    }
+
+    std::uint32_t AudioAssetLoader::getNumThreads() const
+    {
+        return static_cast<std::uint32_t>(m_workers.size());
+    }
+
+    void AudioAssetLoader::setDeviceConfig(const AudioConfig& config)
+    {
+        std::unique_lock<Mutex> lock(m_mutex);
+        m_device = config;
+    }
+
+    AudioConfig AudioAssetLoader::getDeviceConfig() const
+    {
+        std::unique_lock<Mutex> lock(m_mutex);
+        return m_device;
+    }
+
+    AudioMetadataCache& AudioAssetLoader::getMetadataCache()
+    {
+        return m_metadataCache;
+    }
+
+    void AudioAssetLoader::workerLoop()
+    {
+        for (;;)
+        {
+            LoadJob job;
+            {
+                std::unique_lock<Mutex> lock(m_mutex);
+                m_jobAdded.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+                if (m_stop)
+                    return;
+                job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+            }
+
+            auto asset = LoadAsset(job.m_path, job.m_flags, job.m_device, m_metadataCache);
+            const bool failed = asset.m_error != AUDIO_LOAD_OK;
+            job.m_promise.set_value(std::move(asset));
+            if (job.m_batch) {
+                if (failed)
+                    job.m_batch->m_numFailed.fetch_add(1, std::memory_order_release);
+                job.m_batch->m_numCompleted.fetch_add(1, std::memory_order_release);
+            }
+        }
+    }
+}
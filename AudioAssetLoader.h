@@ -0,0 +1,148 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Common/Thread.h>
+
+#include "AudioConfig.h"
+#include "AudioBuffer.h"
+#include "AudioMetadataCache.h"
+#include "VorbisSetupPtr.h"
+
+namespace Audio
+{
+    enum eAudioLoadError : std::uint32_t
+    {
+        AUDIO_LOAD_OK = 0,
+        AUDIO_LOAD_FILE_NOT_FOUND,
+        AUDIO_LOAD_UNKNOWN_TYPE,
+        AUDIO_LOAD_INVALID_FILE,
+        AUDIO_LOAD_UNSUPPORTED_FORMAT,
+        AUDIO_LOAD_DECODE_FAILED,
+        AUDIO_LOAD_OUT_OF_MEMORY,
+        AUDIO_LOAD_CANCELLED
+    };
+
+    enum eAudioLoadFlags : std::uint32_t
+    {
+        AUDIO_LOAD_FLAGS_NONE = 0x0,
+        AUDIO_LOAD_PREDECODE  = 0x01, //decode compressed assets to pcm on the loader thread
+        AUDIO_LOAD_PREPARE_FOR_DEVICE = 0x02, //convert pcm and short ogg assets to the device format
+        AUDIO_LOAD_ADPCM      = 0x04  //transcode 16 bit pcm and ogg assets to IMA ADPCM, overrides the device preparation
+    };
+
+    //longer ogg assets keep streaming when prepared for the device
+    constexpr float MAX_PREPARED_VORBIS_LENGTH = 10.0f;
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Result of loading one file. 'm_waveData' holds raw pcm for
+    // AUDIO_TYPE_WAV( including pre-decoded ogg files ), the file for
+    // AUDIO_TYPE_OGG, in which case 'm_setup' holds its parsed headers, and
+    // the encoded blocks for AUDIO_TYPE_ADPCM( see AdpcmCodec.h ), streamed
+    // by an AdpcmAudioStream
+    //////////////////////////////////////////////////////////////////////////
+    struct AudioAsset
+    {
+        std::string         m_path;
+        eAudioLoadError     m_error       = AUDIO_LOAD_OK;
+        AudioFormat         m_format;
+        AudioBufferPtr      m_waveData;
+        VorbisSetupPtr      m_setup;
+        float               m_totalLength = 0.0f;
+    };
+
+    using AudioAssetFuture = std::shared_future<AudioAsset>;
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Handle of a batch passed to AudioAssetLoader::load, futures are
+    // in the order of the requested paths and never throw
+    //////////////////////////////////////////////////////////////////////////
+    class AudioLoadBatch
+    {
+    public:
+        friend class AudioAssetLoader;
+
+        std::uint32_t               getNumAssets() const;
+        std::uint32_t               getNumCompleted() const;
+        std::uint32_t               getNumFailed() const;
+
+        /*
+            @brief: Fraction of completed assets in [0, 1]
+        */
+        float                       getProgress() const;
+        bool                        isDone() const;
+        void                        wait() const;
+
+        const AudioAssetFuture&     getFuture( std::uint32_t index ) const;
+
+    private:
+        std::vector<AudioAssetFuture>   m_futures;
+        std::atomic<std::uint32_t>      m_numCompleted = {0};
+        std::atomic<std::uint32_t>      m_numFailed    = {0};
+    };
+
+    using AudioLoadBatchPtr = std::shared_ptr<AudioLoadBatch>;
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Reads, validates and optionally decodes wav/ogg files on a pool
+    // of worker threads. Errors are reported per asset instead of thrown,
+    // batches still queued when the loader is destroyed are cancelled
+    //////////////////////////////////////////////////////////////////////////
+    class AudioAssetLoader
+    {
+    public:
+        /*
+            @brief: 0 threads uses one per hardware thread
+        */
+        AudioAssetLoader( std::uint32_t numThreads = 0 );
+        ~AudioAssetLoader();
+
+        AudioAssetLoader(const AudioAssetLoader&) = delete;
+        AudioAssetLoader& operator=(const AudioAssetLoader&) = delete;
+
+        AudioLoadBatchPtr           load( const std::vector<std::string>& paths, std::uint32_t flags = AUDIO_LOAD_FLAGS_NONE );
+        AudioAssetFuture            load( const std::string& path, std::uint32_t flags = AUDIO_LOAD_FLAGS_NONE );
+
+        std::uint32_t               getNumThreads() const;
+
+        /*
+            @brief: Output config used by AUDIO_LOAD_PREPARE_FOR_DEVICE, applies
+            to batches queued afterwards
+        */
+        void                        setDeviceConfig( const AudioConfig& config );
+        AudioConfig                 getDeviceConfig() const;
+
+        /*
+            @brief: Probed metadata of the loaded files, shared by the workers.
+            Load it before queuing to skip the probes of a previous run
+        */
+        AudioMetadataCache&         getMetadataCache();
+
+    private:
+        struct LoadJob
+        {
+            std::string                 m_path;
+            std::uint32_t               m_flags;
+            AudioConfig                 m_device;
+            std::promise<AudioAsset>    m_promise;
+            AudioLoadBatchPtr           m_batch;
+        };
+
+        void                        workerLoop();
+
+        mutable Common::Mutex           m_mutex;
+        std::condition_variable_any     m_jobAdded;
+        std::deque<LoadJob>             m_jobs;
+        std::vector<std::thread>        m_workers;
+        AudioConfig                     m_device;
+        AudioMetadataCache              m_metadataCache;
+        bool                            m_stop;
+    };
+}
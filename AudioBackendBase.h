@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "AudioCapturePtr.h"
+#include "AudioConfig.h"
+
+namespace Audio
+{
+    /*
+        @brief: Writes up to 'numFrames' interleaved frames of the output
+        format to 'data', returns # frames written
+    */
+    using AudioRenderFunc = std::function<std::uint32_t(std::uint32_t numFrames, void* data)>;
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Output the AudioSystem pulls mixed audio through, either an
+    // audio device or a stand-in for hosts that have none
+    //////////////////////////////////////////////////////////////////////////
+    class AudioBackendBase
+    {
+    public:
+        virtual ~AudioBackendBase() = default;
+
+        /*
+            @brief: Opens the output for 'config', returns false if there is
+            none. 'render' is called from the backend's own thread once started
+        */
+        virtual bool            initialize( const AudioDeviceConfig& config, const AudioRenderFunc& render ) = 0;
+        virtual bool            start() = 0;
+
+        /*
+            @brief: Returns once 'render' is no longer called
+        */
+        virtual void            stop() = 0;
+        virtual void            shutDown() = 0;
+
+        /*
+            @brief: Reopens the output with 'periodSize' frames per period, the
+            backend is stopped afterwards
+        */
+        virtual bool            setPeriodSize( std::uint32_t periodSize ) = 0;
+
+        /*
+            @brief: As negotiated, 0 if unknown
+        */
+        virtual std::uint32_t   getPeriodSize() const = 0;
+        virtual std::uint32_t   getNumPeriods() const = 0;
+        virtual std::uint32_t   getSampleRate() const = 0;
+
+        virtual const char*     getName() const = 0;
+
+        /*
+            @brief: Names of the input devices, indices are valid for 'createCapture'
+        */
+        virtual std::vector<std::string>    getCaptureDevices() const { return {}; }
+
+        /*
+            @brief: Opens input 'device' in 'format', empty if the backend has
+            no input. The capture is started by the caller
+        */
+        virtual AudioCapturePtr             createCapture( const AudioDeviceConfig& /*format*/, std::uint32_t /*device*/ = 0 ) { return nullptr; }
+    };
+}
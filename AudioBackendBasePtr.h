@@ -0,0 +1,8 @@
+#pragma once
+#include <memory>
+
+namespace Audio
+{
+    class AudioBackendBase;
+    using AudioBackendBasePtr = std::shared_ptr<AudioBackendBase>;
+}
@@ -0,0 +1,231 @@
+#define MINI_AL_IMPLEMENTATION
+#include <al/mini_al.h>
+#include <algorithm>
+#include <string>
+
+#include <Common/Thread.h>
+#include <Console/Logger.h>
+#include <Console/LogLevel.h>
+
+#include "AudioBackendMiniAl.h"
+#include "AudioMixerBase.h"
+#include "AudioException.h"
+
+using namespace Engine;
+using namespace Log;
+
+namespace Audio
+{
+    namespace
+    {
+        inline void onDeviceStop( mal_device* devicePtr )
+        {
+            (devicePtr);
+        }
+
+        void onAudiolog(mal_context* pContext, mal_device* pDevice, const char* message)
+        {
+            (void)pContext;
+            (void)pDevice;
+            printf("mini_al: %s\n", message);
+        }
+
+        bool LogMessageOnFail( Logger* logger, const std::string& msg, mal_result result )
+        {
+            if (MAL_SUCCESS != result)
+            {
+                logger->addMessage(msg.c_str(), LOG_LEVEL_ERROR);
+                return false;
+            }
+            return true;
+        }
+    }
+
+    BackendMiniAl::BackendMiniAl(EngineContext* context)
+        : m_context( context )
+        , m_contextInitialized( false )
+        , m_deviceInitialized( false )
+        , m_playbackDeviceInfos( nullptr )
+        , m_playbackDeviceCount( 0 )
+        , m_captureDeviceInfos( nullptr )
+        , m_captureDeviceCount( 0 )
+    {
+    }
+
+    BackendMiniAl::~BackendMiniAl()
+    {
+        shutDown();
+    }
+
+    bool BackendMiniAl::initialize(const AudioDeviceConfig& config, const AudioRenderFunc& render)
+    {
+        m_render = render;
+        const auto& logger = m_context->getSystem<Logger>();
+
+        //init context  config
+        m_audioContextConfig = mal_context_config_init(onAudiolog);
+
+        //init device
+        m_audioDeviceConfig = mal_device_config_init_playback((mal_format)config.m_format,
+            config.m_channels, config.m_sampleRate, onSendFramesToDevice );
+        m_audioDeviceConfig.onStopCallback = onDeviceStop;
+
+        //requested buffering, the backend may round or ignore it. Periods
+        //stay within what the mixer renders in one pass
+        const auto maxBufferSize = AUDIO_MIX_MAX_FRAMES * std::max(config.m_periods, 1u);
+        m_audioDeviceConfig.bufferSizeInFrames = std::min(config.getBufferSize(), maxBufferSize);
+        m_audioDeviceConfig.periods            = config.m_periods;
+        m_audioDeviceConfig.performanceProfile = (config.m_flags & AUDIO_LOW_LATENCY)
+            ? mal_performance_profile_low_latency : mal_performance_profile_conservative;
+
+        m_contextInitialized = LogMessageOnFail(logger, "mal_context_init", mal_context_init(nullptr, 0, &m_audioContextConfig, &m_audioContext));
+        if (!m_contextInitialized ||
+            !LogMessageOnFail(logger, "mal_context_get_devices", mal_context_get_devices( &m_audioContext, &m_playbackDeviceInfos, &m_playbackDeviceCount,
+                &m_captureDeviceInfos, &m_captureDeviceCount)))
+            return false;
+
+        //print device names
+        for (mal_uint32 i = 0; i < m_playbackDeviceCount; ++i) {
+            std::string deviceName = m_playbackDeviceInfos[i].name;
+            std::string msg = "Audio Device: " + std::to_string(i) + " " + deviceName;
+            logger->addMessage(msg.c_str(), (int)eLogLevel::LOG_LEVEL_INFO);
+        }
+
+        //init playback
+        return LogMessageOnFail(logger, "mal_device_init failed", openDevice());
+    }
+
+    bool BackendMiniAl::start()
+    {
+        if (!m_deviceInitialized)
+            return false;
+        return mal_device_start(&m_playBackDevice) == MAL_SUCCESS;
+    }
+
+    void BackendMiniAl::stop()
+    {
+        if (m_deviceInitialized && mal_device_is_started(&m_playBackDevice))
+            mal_device_stop(&m_playBackDevice);
+    }
+
+    void BackendMiniAl::shutDown()
+    {
+        if (m_deviceInitialized)
+            mal_device_uninit(&m_playBackDevice);
+        if (m_contextInitialized)
+            mal_context_uninit(&m_audioContext);
+        m_deviceInitialized  = false;
+        m_contextInitialized = false;
+    }
+
+    bool BackendMiniAl::setPeriodSize(std::uint32_t periodSize)
+    {
+        if (!m_deviceInitialized)
+            return false;
+
+        const auto prevBufferSize = m_audioDeviceConfig.bufferSizeInFrames;
+        const auto numPeriods = std::max(getNumPeriods(), 1u);
+
+        //waits for the callback in flight
+        mal_device_uninit(&m_playBackDevice);
+        m_deviceInitialized = false;
+
+        m_audioDeviceConfig.bufferSizeInFrames = periodSize * numPeriods;
+        m_audioDeviceConfig.periods            = numPeriods;
+        if (openDevice() == MAL_SUCCESS)
+            return true;
+
+        m_audioDeviceConfig.bufferSizeInFrames = prevBufferSize;
+        if (!LogMessageOnFail(m_context->getSystem<Logger>(), "mal_device_init failed", openDevice()))
+            throw AudioException("mal_device_init failed");
+        return false;
+    }
+
+    std::uint32_t BackendMiniAl::getPeriodSize() const
+    {
+        if (!m_deviceInitialized || !m_playBackDevice.periods)
+            return 0;
+        return m_playBackDevice.bufferSizeInFrames / m_playBackDevice.periods;
+    }
+
+    std::uint32_t BackendMiniAl::getNumPeriods() const
+    {
+        return m_deviceInitialized ? m_playBackDevice.periods : 0;
+    }
+
+    std::uint32_t BackendMiniAl::getSampleRate() const
+    {
+        return m_deviceInitialized ? m_playBackDevice.sampleRate : 0;
+    }
+
+    mal_uint32 BackendMiniAl::onSendFramesToDevice(mal_device* pDevice, mal_uint32 sampleCount, void* pSamples)
+    {
+        auto* backend = reinterpret_cast<BackendMiniAl*>(pDevice->pUserData);
+        return backend->m_render(sampleCount, pSamples);
+    }
+
+    std::vector<std::string> BackendMiniAl::getCaptureDevices() const
+    {
+        std::vector<std::string> result;
+        for (mal_uint32 i = 0; i < m_captureDeviceCount; ++i)
+            result.emplace_back(m_captureDeviceInfos[i].name);
+        return result;
+    }
+
+    AudioCapturePtr BackendMiniAl::createCapture(const AudioDeviceConfig& format, std::uint32_t device)
+    {
+        const mal_device_id* deviceId = device < m_captureDeviceCount ? &m_captureDeviceInfos[device].id : nullptr;
+        if (!deviceId && m_captureDeviceCount)
+            return nullptr;
+        return std::make_shared<CaptureMiniAl>(format, deviceId);
+    }
+
+    mal_result BackendMiniAl::openDevice()
+    {
+        const auto result = mal_device_init(nullptr, mal_device_type_playback, nullptr, &m_audioDeviceConfig, this, &m_playBackDevice);
+        m_deviceInitialized = result == MAL_SUCCESS;
+        return result;
+    }
+
+    CaptureMiniAl::CaptureMiniAl(const AudioDeviceConfig& format, const mal_device_id* deviceId)
+        : AudioCaptureBase( format )
+    {
+        auto config = mal_device_config_init_capture((mal_format)format.m_format, format.m_channels, format.m_sampleRate, onRecvFramesFromDevice);
+        config.onStopCallback     = onDeviceStop;
+        config.bufferSizeInFrames = format.getBufferSize();
+        config.periods            = format.m_periods;
+        config.performanceProfile = (format.m_flags & AUDIO_LOW_LATENCY)
+            ? mal_performance_profile_low_latency : mal_performance_profile_conservative;
+
+        //own context, the capture may outlive the playback backend
+        if (mal_device_init(nullptr, mal_device_type_capture, deviceId, &config, this, &m_device) != MAL_SUCCESS)
+            throw AudioException("Capture Device Failed");
+
+        //the device may deliver a different format than requested
+        m_format.m_format     = m_device.format;
+        m_format.m_channels   = m_device.channels;
+        m_format.m_sampleRate = m_device.sampleRate;
+    }
+
+    CaptureMiniAl::~CaptureMiniAl()
+    {
+        mal_device_uninit(&m_device);
+    }
+
+    bool CaptureMiniAl::start()
+    {
+        return mal_device_start(&m_device) == MAL_SUCCESS;
+    }
+
+    void CaptureMiniAl::stop()
+    {
+        if (mal_device_is_started(&m_device))
+            mal_device_stop(&m_device);
+    }
+
+    void CaptureMiniAl::onRecvFramesFromDevice(mal_device* pDevice, mal_uint32 frameCount, const void* pSamples)
+    {
+        auto* capture = reinterpret_cast<CaptureMiniAl*>(pDevice->pUserData);
+        capture->pushFrames(pSamples, frameCount);
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <al/mini_al.h>
+
+#include <Engine/EngineContext.h>
+
+#include "AudioBackendBase.h"
+#include "AudioCapture.h"
+
+namespace Audio
+{
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Default backend, plays back on the system's default device
+    // through mini_al
+    //////////////////////////////////////////////////////////////////////////
+    class BackendMiniAl : public AudioBackendBase
+    {
+    public:
+        BackendMiniAl( Engine::EngineContext* context );
+        ~BackendMiniAl() override;
+
+        bool            initialize( const AudioDeviceConfig& config, const AudioRenderFunc& render ) override;
+        bool            start() override;
+        void            stop() override;
+        void            shutDown() override;
+
+        /*
+            @brief: Falls back to the previous size if the device refuses the
+            new one
+        */
+        bool            setPeriodSize( std::uint32_t periodSize ) override;
+        std::uint32_t   getPeriodSize() const override;
+        std::uint32_t   getNumPeriods() const override;
+        std::uint32_t   getSampleRate() const override;
+
+        const char*     getName() const override { return "mini_al"; }
+
+        std::vector<std::string>    getCaptureDevices() const override;
+        AudioCapturePtr             createCapture( const AudioDeviceConfig& format, std::uint32_t device = 0 ) override;
+
+    private:
+        static mal_uint32   onSendFramesToDevice( mal_device* pDevice, mal_uint32 sampleCount, void* pSamples );
+        mal_result          openDevice();
+
+        Engine::EngineContext*  m_context;
+        AudioRenderFunc         m_render;
+        bool                    m_contextInitialized;
+        bool                    m_deviceInitialized;
+
+        mal_context             m_audioContext;
+        mal_context_config      m_audioContextConfig;
+
+        mal_device_info*        m_playbackDeviceInfos;
+        mal_uint32              m_playbackDeviceCount;
+
+        mal_device_info*        m_captureDeviceInfos;
+        mal_uint32              m_captureDeviceCount;
+
+        mal_device_config       m_audioDeviceConfig;
+        mal_device              m_playBackDevice;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: mini_al capture device, the device callback writes straight
+    // into the capture ring
+    //////////////////////////////////////////////////////////////////////////
+    class CaptureMiniAl : public AudioCaptureBase
+    {
+    public:
+        /*
+            @brief: Opens 'deviceId', the default input if null. Buffering is
+            taken from 'format' like for playback
+        */
+        CaptureMiniAl( const AudioDeviceConfig& format, const mal_device_id* deviceId );
+        ~CaptureMiniAl() override;
+
+        bool            start() override;
+        void            stop() override;
+
+    private:
+        static void     onRecvFramesFromDevice( mal_device* pDevice, mal_uint32 frameCount, const void* pSamples );
+
+        mal_device      m_device;
+    };
+}
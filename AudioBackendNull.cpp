@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "AudioBackendNull.h"
+#include "AudioException.h"
+#include "AudioMixerBase.h"
+#include "SampleInfo.h"
+#include "WavFile.h"
+
+namespace Audio
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        //sleep until this long before a deadline, then yield up to it. Keeps
+        //periods precise on platforms with a coarse sleep granularity
+        constexpr auto TIMER_SPIN_TIME = std::chrono::milliseconds(1);
+
+        constexpr std::uint16_t WAVE_FORMAT_PCM        = 1;
+        constexpr std::uint16_t WAVE_FORMAT_IEEE_FLOAT = 3;
+    }
+
+    BackendNull::BackendNull(bool realtime)
+        : m_periodSize( 0 )
+        , m_numPeriods( 0 )
+        , m_realtime( realtime )
+        , m_running( false )
+    {
+    }
+
+    BackendNull::~BackendNull()
+    {
+        stop();
+    }
+
+    bool BackendNull::initialize(const AudioDeviceConfig& config, const AudioRenderFunc& render)
+    {
+        m_format     = config;
+        m_render     = render;
+        m_numPeriods = config.m_periods ? config.m_periods : 2;
+
+        const auto bufferSize = config.getBufferSize();
+        setPeriodSize(bufferSize ? bufferSize / m_numPeriods : NULL_BACKEND_PERIOD_SIZE);
+        return true;
+    }
+
+    bool BackendNull::start()
+    {
+        if (m_running || !m_render)
+            return false;
+
+        m_running = true;
+        m_thread = std::thread(&BackendNull::timerLoop, this);
+        return true;
+    }
+
+    void BackendNull::stop()
+    {
+        m_running = false;
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+
+    void BackendNull::shutDown()
+    {
+        stop();
+    }
+
+    bool BackendNull::setPeriodSize(std::uint32_t periodSize)
+    {
+        stop();
+        //a period is rendered by one mixer pass
+        m_periodSize = std::min(std::max(periodSize, 1u), AUDIO_MIX_MAX_FRAMES);
+        m_period.resize(m_periodSize * m_format.getBytesPerSample());
+        return true;
+    }
+
+    std::uint32_t BackendNull::getPeriodSize() const
+    {
+        return m_periodSize;
+    }
+
+    std::uint32_t BackendNull::getNumPeriods() const
+    {
+        return m_numPeriods;
+    }
+
+    std::uint32_t BackendNull::getSampleRate() const
+    {
+        return m_format.m_sampleRate;
+    }
+
+    void BackendNull::timerLoop()
+    {
+        const auto frameSize = m_format.getBytesPerSample();
+        const auto period = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(m_periodSize) / m_format.m_sampleRate));
+
+        auto deadline = Clock::now();
+        while (m_running)
+        {
+            const auto numFrames = std::min(m_render(m_periodSize, m_period.data()), m_periodSize);
+            if (numFrames < m_periodSize)
+                memset(m_period.data() + numFrames * frameSize, 0, (m_periodSize - numFrames) * frameSize);
+            onPeriod(m_period.data(), static_cast<std::uint32_t>(m_period.size()));
+
+            if (!m_realtime)
+                continue;
+
+            //deadlines advance by whole periods so the rate doesn't drift, a
+            //backlog beyond the buffer is dropped like a device would
+            deadline += period;
+            const auto now = Clock::now();
+            if (now - deadline > period * m_numPeriods)
+                deadline = now;
+
+            if (now < deadline - TIMER_SPIN_TIME)
+                std::this_thread::sleep_until(deadline - TIMER_SPIN_TIME);
+            while (Clock::now() < deadline)
+                std::this_thread::yield();
+        }
+    }
+
+    BackendWav::BackendWav(const std::string& fileName, bool realtime)
+        : BackendNull( realtime )
+        , m_fileName( fileName )
+        , m_numDataBytes( 0 )
+    {
+    }
+
+    BackendWav::~BackendWav()
+    {
+        shutDown();
+    }
+
+    bool BackendWav::initialize(const AudioDeviceConfig& config, const AudioRenderFunc& render)
+    {
+        if (!BackendNull::initialize(config, render))
+            return false;
+
+        m_file.open(m_fileName, std::ios::binary | std::ios::trunc);
+        if (!m_file)
+            return false;
+
+        //sizes are patched on shut down
+        m_numDataBytes = 0;
+        writeHeader();
+        return m_file.good();
+    }
+
+    void BackendWav::shutDown()
+    {
+        BackendNull::shutDown();
+        if (!m_file.is_open())
+            return;
+
+        m_file.seekp(0);
+        writeHeader();
+        m_file.close();
+    }
+
+    void BackendWav::onPeriod(const char* data, std::uint32_t numBytes)
+    {
+        m_file.write(data, numBytes);
+        m_numDataBytes += numBytes;
+    }
+
+    void BackendWav::writeHeader()
+    {
+        const auto bytesPerSample = SampleInformation[m_format.m_format].m_bytesPerSample;
+
+        WaveHeader header;
+        memcpy(header.m_riffText,   "RIFF", 4);
+        memcpy(header.m_waveText,   "WAVE", 4);
+        memcpy(header.m_formatText, "fmt ", 4);
+        memcpy(header.m_dataText,   "data", 4);
+        header.m_totalLength  = sizeof(WaveHeader) - 8 + m_numDataBytes;
+        header.m_formatLength = 16;
+        header.m_format       = m_format.m_format == audio_format_f32 ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM;
+        header.m_channels     = static_cast<std::uint16_t>(m_format.m_channels);
+        header.m_frequency    = m_format.m_sampleRate;
+        header.m_avgBytes     = m_format.getBytesPerSecond();
+        header.m_blockAlign   = static_cast<std::uint16_t>(m_format.getBytesPerSample());
+        header.m_bits         = static_cast<std::uint16_t>(bytesPerSample * 8);
+        header.m_dataLength   = m_numDataBytes;
+        m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AudioBackendBase.h"
+
+namespace Audio
+{
+    //period used when the config leaves buffering to the backend
+    constexpr std::uint32_t NULL_BACKEND_PERIOD_SIZE = 512;
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Output without a device, pulls one period at a time from the
+    // mixer on its own thread. Paced by a timer at the configured rate, so
+    // anything depending on audio timing behaves as with a device, or back
+    // to back for offline rendering
+    //////////////////////////////////////////////////////////////////////////
+    class BackendNull : public AudioBackendBase
+    {
+    public:
+        BackendNull( bool realtime = true );
+        ~BackendNull() override;
+
+        bool            initialize( const AudioDeviceConfig& config, const AudioRenderFunc& render ) override;
+        bool            start() override;
+        void            stop() override;
+        void            shutDown() override;
+
+        bool            setPeriodSize( std::uint32_t periodSize ) override;
+        std::uint32_t   getPeriodSize() const override;
+        std::uint32_t   getNumPeriods() const override;
+        std::uint32_t   getSampleRate() const override;
+
+        const char*     getName() const override { return "null"; }
+
+    protected:
+        /*
+            @brief: Timer thread, receives every rendered period
+        */
+        virtual void    onPeriod( const char* /*data*/, std::uint32_t /*numBytes*/ ) {}
+
+        AudioConfig                 m_format;
+
+    private:
+        void            timerLoop();
+
+        AudioRenderFunc             m_render;
+        std::vector<char>           m_period;
+        std::uint32_t               m_periodSize;
+        std::uint32_t               m_numPeriods;
+        bool                        m_realtime;
+
+        std::thread                 m_thread;
+        std::atomic<bool>           m_running;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Null backend streaming the output to a WAV file, the header is
+    // completed on shut down
+    //////////////////////////////////////////////////////////////////////////
+    class BackendWav : public BackendNull
+    {
+    public:
+        BackendWav( const std::string& fileName, bool realtime = true );
+        ~BackendWav() override;
+
+        bool            initialize( const AudioDeviceConfig& config, const AudioRenderFunc& render ) override;
+        void            shutDown() override;
+
+        const char*     getName() const override { return "wav"; }
+
+    protected:
+        void            onPeriod( const char* data, std::uint32_t numBytes ) override;
+
+    private:
+        void            writeHeader();
+
+        std::string                 m_fileName;
+        std::ofstream               m_file;
+        std::uint32_t               m_numDataBytes;
+    };
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <array>
 #include "AudioConfig.h"
+#include "AudioMemoryStats.h"
 namespace Audio
 {
     template<int BUF_SIZE>
@@ -10,6 +11,7 @@ namespace Audio
             : m_dataPos(0)
             , m_totalSamples( 0 )
         {       
+            TrackAudioAlloc( AUDIO_MEMORY_BLOCK, sizeof(*this) );
             clear();
         }
 
@@ -18,9 +20,16 @@ namespace Audio
             , m_dataPos(rhs.m_dataPos)
             , m_totalSamples( rhs.m_totalSamples)
         {
+            TrackAudioAlloc( AUDIO_MEMORY_BLOCK, sizeof(*this) );
+        }
 
+        ~AudioBlock()
+        {
+            TrackAudioFree( AUDIO_MEMORY_BLOCK, sizeof(*this) );
         }
 
+        AudioBlock& operator = ( const AudioBlock<BUF_SIZE>& ) = default;
+
         inline void                rewind()
         {
             setPosition(0);
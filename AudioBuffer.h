@@ -6,6 +6,38 @@ namespace Audio
 {
 	using AudioBuffer = std::vector<std::int8_t>;
 	using AudioBufferPtr = std::shared_ptr<AudioBuffer>;
+
+	//////////////////////////////////////////////////////////////////////////
+	//\Brief: Read-only view of asset memory, either an AudioBuffer or memory
+	// owned by something else( e.g. a mapped sound bank ) that 'm_owner'
+	// keeps alive
+	//////////////////////////////////////////////////////////////////////////
+	struct AudioMemory
+	{
+		AudioMemory() = default;
+
+		AudioMemory(const AudioBufferPtr& buffer)
+			: m_data( buffer ? buffer->data() : nullptr )
+			, m_size( buffer ? buffer->size() : 0 )
+			, m_owner( buffer )
+			, m_buffer( buffer )
+		{
+		}
+
+		AudioMemory(const std::int8_t* data, std::size_t size, const std::shared_ptr<const void>& owner)
+			: m_data( data )
+			, m_size( size )
+			, m_owner( owner )
+		{
+		}
+
+		bool							empty() const { return m_size == 0; }
+
+		const std::int8_t*				m_data = nullptr;
+		std::size_t						m_size = 0;
+		std::shared_ptr<const void>		m_owner;
+		AudioBufferPtr					m_buffer; //set if the memory is an AudioBuffer
+	};
 }
 
  
\ No newline at end of file
@@ -0,0 +1,348 @@
+#include <algorithm>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUDIO_BUS_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "AudioBus.h"
+#include "AudioException.h"
+#include "AudioMemoryStats.h"
+#include "AudioSampleConversion.h"
+
+namespace Audio
+{
+    namespace
+    {
+        template<typename T>
+        void Deinterleave(const std::uint8_t* src, std::uint32_t sampleSize, std::uint32_t numChannels,
+            std::uint32_t first, std::uint32_t numFrames, AudioBus& dest)
+        {
+            src += std::size_t(first) * numChannels * sampleSize;
+            for (std::uint32_t c = 0; c < numChannels; ++c)
+            {
+                const auto* srcPtr = src + std::size_t(c) * sampleSize;
+                auto* destPtr = dest.getChannel(c);
+                for (std::uint32_t i = first; i < numFrames; ++i, srcPtr += numChannels * sampleSize)
+                    destPtr[i] = SampleToFloat<T>(srcPtr);
+            }
+        }
+
+#ifdef AUDIO_BUS_SSE2
+        //returns the number of frames converted, the caller finishes the tail
+        std::uint32_t DeinterleaveS16SSE2(const std::int16_t* src, std::uint32_t numChannels, std::uint32_t numFrames, AudioBus& dest)
+        {
+            const auto scale = _mm_set1_ps(1.0f / 32768.0f);
+            const auto numVector = numFrames & ~7u;
+            if (numChannels == 1)
+            {
+                auto* out = dest.getChannel(0);
+                for (std::uint32_t i = 0; i < numVector; i += 8)
+                {
+                    const auto val = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                    const auto lo  = _mm_srai_epi32(_mm_unpacklo_epi16(val, val), 16);
+                    const auto hi  = _mm_srai_epi32(_mm_unpackhi_epi16(val, val), 16);
+                    _mm_store_ps(out + i,     _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+                    _mm_store_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+                }
+                return numVector;
+            }
+            if (numChannels == 2)
+            {
+                auto* left  = dest.getChannel(0);
+                auto* right = dest.getChannel(1);
+                for (std::uint32_t i = 0; i < numVector; i += 8)
+                {
+                    const auto v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+                    const auto v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2 + 8));
+                    //sign extended left samples sit in the low, right samples in the high halves
+                    const auto l0 = _mm_srai_epi32(_mm_slli_epi32(v0, 16), 16);
+                    const auto l1 = _mm_srai_epi32(_mm_slli_epi32(v1, 16), 16);
+                    const auto r0 = _mm_srai_epi32(v0, 16);
+                    const auto r1 = _mm_srai_epi32(v1, 16);
+                    _mm_store_ps(left  + i,     _mm_mul_ps(_mm_cvtepi32_ps(l0), scale));
+                    _mm_store_ps(left  + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(l1), scale));
+                    _mm_store_ps(right + i,     _mm_mul_ps(_mm_cvtepi32_ps(r0), scale));
+                    _mm_store_ps(right + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(r1), scale));
+                }
+                return numVector;
+            }
+            return 0;
+        }
+
+        std::uint32_t DeinterleaveF32SSE2(const float* src, std::uint32_t numChannels, std::uint32_t numFrames, AudioBus& dest)
+        {
+            const auto numVector = numFrames & ~3u;
+            if (numChannels == 1)
+            {
+                auto* out = dest.getChannel(0);
+                for (std::uint32_t i = 0; i < numVector; i += 4)
+                    _mm_store_ps(out + i, _mm_loadu_ps(src + i));
+                return numVector;
+            }
+            if (numChannels == 2)
+            {
+                auto* left  = dest.getChannel(0);
+                auto* right = dest.getChannel(1);
+                for (std::uint32_t i = 0; i < numVector; i += 4)
+                {
+                    const auto v0 = _mm_loadu_ps(src + i * 2);
+                    const auto v1 = _mm_loadu_ps(src + i * 2 + 4);
+                    _mm_store_ps(left  + i, _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 0, 2, 0)));
+                    _mm_store_ps(right + i, _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 3, 1)));
+                }
+                return numVector;
+            }
+            return 0;
+        }
+#endif
+    }
+
+    AudioBus::AudioBus()
+        : m_numChannels( 0 )
+        , m_maxFrames( 0 )
+        , m_stride( 0 )
+    {
+    }
+
+    AudioBus::AudioBus(std::uint32_t numChannels, std::uint32_t maxFrames)
+        : AudioBus()
+    {
+        resize(numChannels, maxFrames);
+    }
+
+    AudioBus::~AudioBus()
+    {
+        if (m_data.capacity())
+            TrackAudioFree(AUDIO_MEMORY_MIXER, m_data.capacity() * sizeof(FloatQuad));
+    }
+
+    void AudioBus::resize(std::uint32_t numChannels, std::uint32_t maxFrames)
+    {
+        if (m_data.capacity())
+            TrackAudioFree(AUDIO_MEMORY_MIXER, m_data.capacity() * sizeof(FloatQuad));
+
+        m_numChannels = numChannels;
+        m_maxFrames   = maxFrames;
+        m_stride      = (maxFrames + 3) / 4;
+        m_data.assign(std::size_t(m_stride) * numChannels, FloatQuad());
+
+        if (m_data.capacity())
+            TrackAudioAlloc(AUDIO_MEMORY_MIXER, m_data.capacity() * sizeof(FloatQuad));
+    }
+
+    void AudioBus::clear()
+    {
+        if (!m_data.empty())
+            memset(m_data.data(), 0, m_data.size() * sizeof(FloatQuad));
+    }
+
+    float* AudioBus::getChannel(std::uint32_t channel)
+    {
+        return m_data[std::size_t(m_stride) * channel].m_val;
+    }
+
+    const float* AudioBus::getChannel(std::uint32_t channel) const
+    {
+        return m_data[std::size_t(m_stride) * channel].m_val;
+    }
+
+    std::uint32_t AudioBus::getNumChannels() const
+    {
+        return m_numChannels;
+    }
+
+    std::uint32_t AudioBus::getMaxFrames() const
+    {
+        return m_maxFrames;
+    }
+
+    void DeinterleaveToBus(const void* src, const AudioConfig& format, std::uint32_t numFrames, AudioBus& dest)
+    {
+        const auto numChannels = format.m_channels;
+        if (numChannels > dest.getNumChannels() || numFrames > dest.getMaxFrames())
+            throw AudioException("Audio Bus Too Small");
+
+        const auto* srcPtr     = static_cast<const std::uint8_t*>(src);
+        const auto  sampleSize = numChannels ? format.getBytesPerSample() / numChannels : 0;
+        std::uint32_t first = 0;
+        switch (format.m_format)
+        {
+            case audio_format_u8:
+                Deinterleave<std::uint8_t>(srcPtr, sampleSize, numChannels, first, numFrames, dest);
+                break;
+            case audio_format_s16:
+#ifdef AUDIO_BUS_SSE2
+                first = DeinterleaveS16SSE2(static_cast<const std::int16_t*>(src), numChannels, numFrames, dest);
+#endif
+                Deinterleave<std::int16_t>(srcPtr, sampleSize, numChannels, first, numFrames, dest);
+                break;
+            case audio_format_s24:
+                Deinterleave<Packed24>(srcPtr, sampleSize, numChannels, first, numFrames, dest);
+                break;
+            case audio_format_s32:
+                Deinterleave<std::int32_t>(srcPtr, sampleSize, numChannels, first, numFrames, dest);
+                break;
+            case audio_format_f32:
+#ifdef AUDIO_BUS_SSE2
+                first = DeinterleaveF32SSE2(static_cast<const float*>(src), numChannels, numFrames, dest);
+#endif
+                Deinterleave<float>(srcPtr, sampleSize, numChannels, first, numFrames, dest);
+                break;
+            default:
+                throw AudioException("Unsupported Sound Format");
+        }
+    }
+
+    bool IsBusFormat(const AudioConfig& format)
+    {
+        return format.m_format > audio_format_unknown && format.m_format < audio_format_count &&
+               format.m_channels && format.m_channels <= AUDIO_BUS_MAX_CHANNELS;
+    }
+
+    void RemixBus(const AudioBus& src, std::uint32_t numSrcChannels, AudioBus& dest, std::uint32_t numDstChannels, std::uint32_t numFrames)
+    {
+        const auto numBytes = numFrames * sizeof(float);
+        if (numSrcChannels == 1)
+        {
+            for (std::uint32_t c = 0; c < numDstChannels; ++c) {
+                if (c < 2)
+                    memcpy(dest.getChannel(c), src.getChannel(0), numBytes);
+                else
+                    memset(dest.getChannel(c), 0, numBytes);
+            }
+        }
+        else if (numDstChannels == 1)
+        {
+            const float scale = 1.0f / numSrcChannels;
+            auto* out = dest.getChannel(0);
+            memset(out, 0, numBytes);
+            for (std::uint32_t c = 0; c < numSrcChannels; ++c)
+            {
+                const auto* in = src.getChannel(c);
+                for (std::uint32_t i = 0; i < numFrames; ++i)
+                    out[i] += in[i] * scale;
+            }
+        }
+        else
+        {
+            for (std::uint32_t c = 0; c < numDstChannels; ++c) {
+                if (c < numSrcChannels)
+                    memcpy(dest.getChannel(c), src.getChannel(c), numBytes);
+                else
+                    memset(dest.getChannel(c), 0, numBytes);
+            }
+        }
+    }
+
+    void ResampleBus(const AudioBus& src, std::uint32_t numSrcFrames, AudioBus& dest, std::uint32_t numDstFrames, std::uint32_t numChannels)
+    {
+        if (!numSrcFrames || !numDstFrames)
+            return;
+
+        const float step = numDstFrames > 1 ? float(numSrcFrames - 1) / float(numDstFrames - 1) : 0.0f;
+        for (std::uint32_t c = 0; c < numChannels; ++c)
+        {
+            const auto* in  = src.getChannel(c);
+            auto*       out = dest.getChannel(c);
+            for (std::uint32_t i = 0; i < numDstFrames; ++i)
+            {
+                const float pos  = i * step;
+                const auto  idx  = std::min(static_cast<std::uint32_t>(pos), numSrcFrames - 1);
+                const auto  next = std::min(idx + 1, numSrcFrames - 1);
+                const float frac = pos - float(idx);
+                out[i] = in[idx] + ( in[next] - in[idx] ) * frac;
+            }
+        }
+    }
+
+    std::uint32_t GetResampleInputFrames(const AudioResampleState& state, std::uint32_t numDstFrames)
+    {
+        //the frame after the last position is read as well
+        if (!numDstFrames)
+            return 0;
+        return static_cast<std::uint32_t>(state.m_phase + (numDstFrames - 1) * double(state.m_ratio));
+    }
+
+    void ResampleBus(const AudioBus& src, std::uint32_t numSrcFrames, AudioBus& dest, std::uint32_t numDstFrames, std::uint32_t numChannels, AudioResampleState& state)
+    {
+        //positions index the history followed by the new frames
+        const double ratio = state.m_ratio;
+        for (std::uint32_t c = 0; c < numChannels; ++c)
+        {
+            const auto* in  = src.getChannel(c);
+            auto*       out = dest.getChannel(c);
+            const float h0  = state.m_history[0][c];
+            const float h1  = state.m_history[1][c];
+            const auto  at  = [=](std::uint32_t k) { return k >= 2 ? in[k - 2] : (k ? h1 : h0); };
+            for (std::uint32_t i = 0; i < numDstFrames; ++i)
+            {
+                const double pos  = state.m_phase + i * ratio;
+                const auto   idx  = static_cast<std::uint32_t>(pos);
+                const float  frac = static_cast<float>(pos - idx);
+                const float  cur  = at(idx);
+                out[i] = cur + ( at(idx + 1) - cur ) * frac;
+            }
+            state.m_history[0][c] = at(numSrcFrames);
+            state.m_history[1][c] = at(numSrcFrames + 1);
+        }
+        state.m_phase += numDstFrames * ratio - numSrcFrames;
+    }
+
+    void AccumulateBus(AudioBus& dest, const AudioBus& src, std::uint32_t numChannels, std::uint32_t numFrames, const float* gains)
+    {
+        for (std::uint32_t c = 0; c < numChannels; ++c)
+        {
+            const auto* in  = src.getChannel(c);
+            auto*       out = dest.getChannel(c);
+            std::uint32_t i = 0;
+#ifdef AUDIO_BUS_SSE2
+            //channels are padded to whole quads, no tail needed
+            const auto gain = _mm_set1_ps(gains[c]);
+            for (; i < numFrames; i += 4)
+                _mm_store_ps(out + i, _mm_add_ps(_mm_load_ps(out + i), _mm_mul_ps(_mm_load_ps(in + i), gain)));
+#endif
+            for (; i < numFrames; ++i)
+                out[i] += in[i] * gains[c];
+        }
+    }
+
+    void InterleaveBus(const AudioBus& src, std::uint32_t numChannels, std::uint32_t numFrames, float* dest)
+    {
+        std::uint32_t first = 0;
+#ifdef AUDIO_BUS_SSE2
+        if (numChannels == 2)
+        {
+            const auto* left  = src.getChannel(0);
+            const auto* right = src.getChannel(1);
+            first = numFrames & ~3u;
+            for (std::uint32_t i = 0; i < first; i += 4)
+            {
+                const auto l = _mm_load_ps(left + i);
+                const auto r = _mm_load_ps(right + i);
+                _mm_storeu_ps(dest + i * 2,     _mm_unpacklo_ps(l, r));
+                _mm_storeu_ps(dest + i * 2 + 4, _mm_unpackhi_ps(l, r));
+            }
+        }
+        else if (numChannels == 1)
+        {
+            first = numFrames & ~3u;
+            memcpy(dest, src.getChannel(0), first * sizeof(float));
+        }
+#endif
+        for (std::uint32_t c = 0; c < numChannels; ++c)
+        {
+            const auto* in = src.getChannel(c);
+            for (std::uint32_t i = first; i < numFrames; ++i)
+                dest[i * numChannels + c] = in[i];
+        }
+    }
+
+    void GetPanningGains(float panning, float attenuation, float* gains)
+    {
+        const float biasLeft = std::min(1.0f, std::max(0.0f, panning * -0.5f + 0.5f));
+        gains[0] = biasLeft * attenuation;
+        gains[1] = (1.0f - biasLeft) * attenuation;
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "AudioConfig.h"
+
+namespace Audio
+{
+    //frames a bus holds unless sized explicitly, matches AudioBlockInternal of mono fp32
+    constexpr std::uint32_t AUDIO_BUS_MAX_FRAMES   = 4096;
+    constexpr std::uint32_t AUDIO_BUS_MAX_CHANNELS = 8;
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Planar fp32 mixing bus, every channel is a contiguous 16 byte
+    // aligned array padded to a multiple of 4 frames so DSP stages run full
+    // width vector loops. Audio is interleaved only at the device boundary
+    //////////////////////////////////////////////////////////////////////////
+    class AudioBus
+    {
+    public:
+        AudioBus();
+        AudioBus( std::uint32_t numChannels, std::uint32_t maxFrames = AUDIO_BUS_MAX_FRAMES );
+        ~AudioBus();
+
+        AudioBus( const AudioBus& ) = delete;
+        AudioBus& operator = ( const AudioBus& ) = delete;
+
+        /*
+            @brief: Reallocates, contents are cleared
+        */
+        void                    resize( std::uint32_t numChannels, std::uint32_t maxFrames = AUDIO_BUS_MAX_FRAMES );
+        void                    clear();
+
+        float*                  getChannel( std::uint32_t channel );
+        const float*            getChannel( std::uint32_t channel ) const;
+
+        std::uint32_t           getNumChannels() const;
+        std::uint32_t           getMaxFrames() const;
+
+    private:
+        struct alignas(16) FloatQuad
+        {
+            float               m_val[4];
+        };
+
+        std::vector<FloatQuad>  m_data;
+        std::uint32_t           m_numChannels;
+        std::uint32_t           m_maxFrames;
+        std::uint32_t           m_stride; //in quads
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Per voice resampler state, 'm_ratio' input frames are read for
+    // every output frame. The fractional position and the last two input
+    // frames carry over between blocks, so splitting a stream into blocks
+    // of any size gives the same output
+    //////////////////////////////////////////////////////////////////////////
+    struct AudioResampleState
+    {
+        float                   m_ratio = 1.0f;
+        double                  m_phase = 2.0;  //next output position in input frames, from m_history[0]
+        float                   m_history[2][AUDIO_BUS_MAX_CHANNELS] = {}; //input frames before the next block
+    };
+
+    /*
+        @brief: Converts 'numFrames' interleaved frames of 'format' to fp32 and
+        splits them into the first format.m_channels channels of 'dest'
+    */
+    void                DeinterleaveToBus( const void* src, const AudioConfig& format, std::uint32_t numFrames, AudioBus& dest );
+
+    /*
+        @brief: True if DeinterleaveToBus converts 'format', a known sample
+        format of 1 to AUDIO_BUS_MAX_CHANNELS channels
+    */
+    bool                IsBusFormat( const AudioConfig& format );
+
+    /*
+        @brief: Mono is copied to the front pair, anything to mono is averaged,
+        otherwise matching channels are copied and the remaining cleared
+    */
+    void                RemixBus( const AudioBus& src, std::uint32_t numSrcChannels, AudioBus& dest, std::uint32_t numDstChannels, std::uint32_t numFrames );
+
+    /*
+        @brief: Linear resampling of 'numSrcFrames' frames to 'numDstFrames'
+        frames with both end points aligned, per channel
+    */
+    void                ResampleBus( const AudioBus& src, std::uint32_t numSrcFrames, AudioBus& dest, std::uint32_t numDstFrames, std::uint32_t numChannels );
+
+    /*
+        @brief: # input frames the stateful ResampleBus reads to write
+        'numDstFrames' frames, may be 0 when downsampling by a large factor
+    */
+    std::uint32_t       GetResampleInputFrames( const AudioResampleState& state, std::uint32_t numDstFrames );
+
+    /*
+        @brief: Linear resampling continuing from 'state', 'numSrcFrames' must
+        be GetResampleInputFrames( state, numDstFrames ). Advances 'state'
+    */
+    void                ResampleBus( const AudioBus& src, std::uint32_t numSrcFrames, AudioBus& dest, std::uint32_t numDstFrames, std::uint32_t numChannels, AudioResampleState& state );
+
+    /*
+        @brief: dest[c] += src[c] * gains[c] for the first 'numChannels' channels
+    */
+    void                AccumulateBus( AudioBus& dest, const AudioBus& src, std::uint32_t numChannels, std::uint32_t numFrames, const float* gains );
+
+    /*
+        @brief: Writes the first 'numChannels' channels interleaved to 'dest'
+    */
+    void                InterleaveBus( const AudioBus& src, std::uint32_t numChannels, std::uint32_t numFrames, float* dest );
+
+    /*
+        @brief: Per channel gains of a stereo source at 'panning'( -1 left, 1 right )
+    */
+    void                GetPanningGains( float panning, float attenuation, float* gains );
+}
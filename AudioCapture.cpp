@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "AudioCapture.h"
+#include "AudioException.h"
+#include "WavFile.h"
+
+namespace Audio
+{
+    namespace
+    {
+        AudioConfig GetWavConfig( const WavFile& wav )
+        {
+            AudioConfig config;
+            config.m_format     = wav.getSampleFormat();
+            config.m_channels   = wav.m_header.m_channels;
+            config.m_sampleRate = wav.m_header.m_frequency;
+            return config;
+        }
+    }
+
+    AudioCaptureBase::AudioCaptureBase(const AudioConfig& format)
+        : m_format( format )
+        , m_numDroppedFrames( 0 )
+    {
+        if (!format.getBytesPerSample())
+            throw AudioException("Invalid Capture Format");
+    }
+
+    const AudioConfig& AudioCaptureBase::getFormat() const
+    {
+        return m_format;
+    }
+
+    AudioCaptureRing& AudioCaptureBase::getRing()
+    {
+        return m_ring;
+    }
+
+    std::uint32_t AudioCaptureBase::getNumDroppedFrames() const
+    {
+        return m_numDroppedFrames.load(std::memory_order_relaxed);
+    }
+
+    void AudioCaptureBase::pushFrames(const void* data, std::uint32_t numFrames)
+    {
+        const auto frameSize = m_format.getBytesPerSample();
+        const auto numWritten = std::min(numFrames, m_ring.freeBytes() / frameSize);
+        m_ring.writeData(data, numWritten * frameSize);
+        if (numWritten < numFrames)
+            m_numDroppedFrames.fetch_add(numFrames - numWritten, std::memory_order_relaxed);
+    }
+
+    CaptureFile::CaptureFile(const std::string& fileName, std::uint32_t periodSize)
+        : CaptureFile( WavFile(fileName), periodSize )
+    {
+    }
+
+    CaptureFile::CaptureFile(const WavFile& wav, std::uint32_t periodSize)
+        : AudioCaptureBase( GetWavConfig(wav) )
+        , m_data( wav.m_waveData )
+        , m_periodSize( std::max(periodSize, 1u) )
+        , m_readPos( 0 )
+        , m_running( false )
+    {
+        if (!m_data || m_data->size() < m_format.getBytesPerSample())
+            throw AudioException("Empty Capture File");
+    }
+
+    CaptureFile::~CaptureFile()
+    {
+        stop();
+    }
+
+    bool CaptureFile::start()
+    {
+        if (m_running)
+            return false;
+        m_running = true;
+        m_thread = std::thread(&CaptureFile::captureLoop, this);
+        return true;
+    }
+
+    void CaptureFile::stop()
+    {
+        m_running = false;
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+
+    void CaptureFile::captureLoop()
+    {
+        using Clock = std::chrono::steady_clock;
+        const auto frameSize = m_format.getBytesPerSample();
+        const auto numFrames = static_cast<std::uint32_t>(m_data->size() / frameSize);
+        const auto period = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(m_periodSize) / m_format.m_sampleRate));
+
+        auto deadline = Clock::now();
+        while (m_running)
+        {
+            //one period, wrapping around the end of the file
+            auto remaining = m_periodSize;
+            while (remaining)
+            {
+                const auto count = std::min(remaining, numFrames - m_readPos);
+                pushFrames(m_data->data() + std::size_t(m_readPos) * frameSize, count);
+                m_readPos = (m_readPos + count) % numFrames;
+                remaining -= count;
+            }
+
+            deadline += period;
+            std::this_thread::sleep_until(deadline);
+        }
+    }
+
+    CaptureAudioStream::CaptureAudioStream(const AudioCapturePtr& capture, std::uint32_t maxLatency)
+        : AudioStreamBase( GetCaptureAudioFormat(capture->getFormat()) )
+        , m_capture( capture )
+        , m_frameSize( capture->getFormat().getBytesPerSample() )
+        , m_maxLatency( maxLatency )
+        , m_samplePos( 0 )
+    {
+    }
+
+    bool CaptureAudioStream::seek(std::uint32_t sample)
+    {
+        //live input, there is nothing to seek to
+        (void)sample;
+        return false;
+    }
+
+    std::uint32_t CaptureAudioStream::getData(void* dest, std::uint32_t numBytes)
+    {
+        auto& ring = m_capture->getRing();
+        const auto numFrames = numBytes / m_frameSize;
+
+        //skip the oldest frames once the backlog exceeds the latency bound
+        auto available = ring.availableBytes() / m_frameSize;
+        if (available > numFrames + m_maxLatency)
+        {
+            const auto numSkipped = available - numFrames - m_maxLatency;
+            ring.commitRead(numSkipped * m_frameSize);
+            available -= numSkipped;
+        }
+
+        const auto numRead = std::min(available, numFrames);
+        ring.readData(dest, numRead * m_frameSize);
+        if (numRead < numFrames)
+        {
+            const int silence = getInternalFormat().m_format == audio_format_u8 ? 0x80 : 0;
+            memset(static_cast<char*>(dest) + numRead * m_frameSize, silence, (numFrames - numRead) * m_frameSize);
+        }
+
+        m_samplePos += numFrames;
+        return numFrames * m_frameSize;
+    }
+
+    std::uint32_t CaptureAudioStream::getSamplePos() const
+    {
+        return m_samplePos;
+    }
+
+    std::uint32_t CaptureAudioStream::getTotalSamples() const
+    {
+        return m_samplePos + numBytesAvailable() / m_frameSize;
+    }
+
+    std::uint32_t CaptureAudioStream::numBytesAvailable() const
+    {
+        //whole frames, the capture side may be mid write
+        const auto available = m_capture->getRing().availableBytes();
+        return available - available % m_frameSize;
+    }
+}
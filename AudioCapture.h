@@ -0,0 +1,122 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "AudioCapturePtr.h"
+#include "AudioConfig.h"
+#include "AudioRingBuffer.h"
+#include "AudioStream.h"
+
+namespace Audio
+{
+    struct WavFile;
+
+    //64 KiB, 8192 stereo fp32 frames
+    constexpr int CAPTURE_RING_SIZE = 1 << 16;
+
+    using AudioCaptureRing = AudioRingBuffer<CAPTURE_RING_SIZE>;
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Source of live input. The capture thread writes whole frames
+    // into a lock free ring, a CaptureAudioStream reads them out on the mix
+    // thread
+    //////////////////////////////////////////////////////////////////////////
+    class AudioCaptureBase
+    {
+    public:
+        AudioCaptureBase( const AudioConfig& format );
+        virtual ~AudioCaptureBase() = default;
+
+        AudioCaptureBase(const AudioCaptureBase&) = delete;
+        AudioCaptureBase& operator=(const AudioCaptureBase&) = delete;
+
+        virtual bool                start() = 0;
+        virtual void                stop() = 0;
+
+        const AudioConfig&          getFormat() const;
+        AudioCaptureRing&           getRing();
+
+        /*
+            @brief: # captured frames dropped because the ring was full
+        */
+        std::uint32_t               getNumDroppedFrames() const;
+
+    protected:
+        /*
+            @brief: Capture thread, writes as many whole frames as fit
+        */
+        void                        pushFrames( const void* data, std::uint32_t numFrames );
+
+        AudioConfig                 m_format;
+
+    private:
+        AudioCaptureRing            m_ring;
+        std::atomic<std::uint32_t>  m_numDroppedFrames;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Stand-in for a capture device, plays a WAV file into the ring
+    // in real time, one period at a time and looping
+    //////////////////////////////////////////////////////////////////////////
+    class CaptureFile : public AudioCaptureBase
+    {
+    public:
+        CaptureFile( const std::string& fileName, std::uint32_t periodSize = 512 );
+        ~CaptureFile() override;
+
+        bool                        start() override;
+        void                        stop() override;
+
+    private:
+        CaptureFile( const WavFile& wav, std::uint32_t periodSize );
+
+        void                        captureLoop();
+
+        AudioBufferPtr              m_data;
+        std::uint32_t               m_periodSize;
+        std::uint32_t               m_readPos;  //in frames
+
+        std::thread                 m_thread;
+        std::atomic<bool>           m_running;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Hands captured audio to the mixer, reading straight from the
+    // capture ring into the mixer's buffer. Anything beyond 'maxLatency'
+    // frames on top of a request is skipped so latency stays bounded, a
+    // ring that runs dry is padded with silence
+    //////////////////////////////////////////////////////////////////////////
+    class CaptureAudioStream : public AudioStreamBase
+    {
+    public:
+        CaptureAudioStream( const AudioCapturePtr& capture, std::uint32_t maxLatency );
+
+        bool                        seek( std::uint32_t sample ) final override;
+        std::uint32_t               getData( void* dest, std::uint32_t numBytes ) final override;
+        std::uint32_t               getSamplePos() const final override;
+
+        /*
+            @brief: Live input has no end, the frames handed out plus those
+            readable in the ring, and the bytes readable in the ring
+        */
+        std::uint32_t               getTotalSamples() const final override;
+        std::uint32_t               numBytesAvailable() const final override;
+
+    private:
+        AudioCapturePtr             m_capture;
+        std::uint32_t               m_frameSize;
+        std::uint32_t               m_maxLatency;   //frames
+        std::uint32_t               m_samplePos;    //frames handed out
+    };
+
+    inline AudioFormat GetCaptureAudioFormat( const AudioConfig& config )
+    {
+        AudioFormat result;
+        static_cast<AudioConfig&>(result) = config;
+        result.m_type      = AUDIO_TYPE_GEN;
+        result.m_loopCount = AUDIO_LOOP_INFINITE;
+        return result;
+    }
+}
@@ -0,0 +1,8 @@
+#pragma once
+#include <memory>
+
+namespace Audio
+{
+    class AudioCaptureBase;
+    using AudioCapturePtr = std::shared_ptr<AudioCaptureBase>;
+}
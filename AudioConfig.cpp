@@ -32,6 +32,11 @@ RTTR_REGISTRATION
         val.method("getSampleRate", &Type::getSampleRate);
         val.method("getNumChannels", &Type::getNumChannels);
     }
+    {
+        using Type = AudioDeviceConfig;
+        auto val = registration::class_<Type>("AudioDeviceConfig");
+        val.method("getBufferSize", &Type::getBufferSize);
+    }
     
 };
 
@@ -90,6 +95,11 @@ namespace Audio
         return getNumSamples(period) * getBytesPerSample();
     }
 
+    std::uint32_t AudioDeviceConfig::getBufferSize() const
+    {
+        return m_targetLatency > 0.0f ? getNumSamples(m_targetLatency) : 0u;
+    }
+
     std::uint32_t AudioConfig::getSampleRate() const
     {
         return m_sampleRate;
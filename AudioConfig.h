@@ -1,7 +1,6 @@
 #pragma once
 #include <cstdint>
 #include <string>
-#include <unordered_set>
 #include <vector>
 
 #include <Scene/AudioEmitterEntityPtr.h>
@@ -33,13 +32,17 @@ namespace Audio
         AUDIO_TYPE_NONE = 0,
         AUDIO_TYPE_GEN,
         AUDIO_TYPE_WAV,
-        AUDIO_TYPE_OGG
+        AUDIO_TYPE_OGG,
+        AUDIO_TYPE_ADPCM
     };
 
     enum eConfigFlags : std::uint32_t
     {
-        AUDIO_FLAGS_NONE = 0x0,
-        AUDIO_UNIT_TEST  = 0x01
+        AUDIO_FLAGS_NONE  = 0x0,
+        AUDIO_UNIT_TEST   = 0x01,
+        AUDIO_LOW_LATENCY = 0x02, //ask the backend for its low latency profile
+        AUDIO_NULL_FALLBACK = 0x04, //use the null backend if the output can't be opened
+        AUDIO_METERING    = 0x08  //loudness, true peak & spectrum of the output, see AudioSystem::getMeterReading
     };
 
     struct AudioConfig
@@ -53,14 +56,30 @@ namespace Audio
         std::uint32_t   getNumSamples(const float period) const;
         std::uint32_t   getNumBytes(const float period) const;
         
-        
-        
         std::uint32_t   m_format     = audio_format_s16;
         std::uint32_t   m_channels   = 2;
         std::uint32_t   m_sampleRate = 44100;
         std::uint32_t   m_flags      = AUDIO_FLAGS_NONE;        
     };
 
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Format of an output or capture device plus its buffering, taken
+    // by the backend & the audio system
+    //////////////////////////////////////////////////////////////////////////
+    struct AudioDeviceConfig : public AudioConfig
+    {
+        /*
+            @brief: Device buffer size in frames for 'm_targetLatency', 0 if the
+            backend decides
+        */
+        std::uint32_t   getBufferSize() const;
+
+        float           m_targetLatency = 0.0f; //seconds buffered by the device, 0 lets the backend decide
+        std::uint32_t   m_periods       = 0;    //# periods the device buffer is split into, 0 lets the backend decide
+        float           m_xrunThreshold = 0.0f; //xruns per second that grow the period size, 0 never renegotiates
+        std::uint32_t   m_mixAheadPeriods = 0;  //periods mixed ahead on a separate thread, 0 mixes in the device callback
+    };
+
 
     struct AudioFormat : public AudioConfig
     {
@@ -75,9 +94,9 @@ namespace Audio
         int             m_loopCount  = AUDIO_LOOP_INFINITE;
     };
   
-    inline AudioConfig GetDefaultAudioConfig()
+    inline AudioDeviceConfig GetDefaultAudioConfig()
     {
-        AudioConfig result;
+        AudioDeviceConfig result;
         result.m_format      = audio_format_f32;
         result.m_channels    = 2;
         result.m_sampleRate  = 44100;
@@ -86,13 +105,13 @@ namespace Audio
     }
 
 
-    inline AudioConfig     GetTestOutputAudioConfig()
+    inline AudioDeviceConfig GetTestOutputAudioConfig()
     {
-        AudioConfig result;
+        AudioDeviceConfig result;
         result.m_format      = audio_format_f32;
         result.m_channels    = 1;
         result.m_sampleRate  = 22050;
-        result.m_flags       = AUDIO_UNIT_TEST;
+        result.m_flags       = AUDIO_UNIT_TEST | AUDIO_NULL_FALLBACK;
         return result;
     }
 
@@ -113,7 +132,6 @@ namespace Audio
 
     using AudioSource       = Components::AudioComponent;
     using AudioListener     = Components::AudioListenerComponent;
-    using ActiveAudioSet    = std::unordered_set<AudioSource*>;
     using ActiveAudioVector = std::vector<AudioSource*>;
 
 }
\ No newline at end of file
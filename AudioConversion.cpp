@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include <Common/Thread.h>
+
+#include "AudioConversion.h"
+#include "AudioException.h"
+#include "AudioSampleConversion.h"
+#include "VorbisSetup.h"
+
+using namespace Common;
+
+namespace Audio
+{
+    namespace
+    {
+        using Channel = std::vector<float>;
+
+        struct DeviceBufferKey
+        {
+            bool operator==(const DeviceBufferKey& rhs) const
+            {
+                return m_data == rhs.m_data && m_sampleRate == rhs.m_sampleRate && m_channels == rhs.m_channels;
+            }
+
+            const void*     m_data;
+            std::uint32_t   m_sampleRate;
+            std::uint32_t   m_channels;
+        };
+
+        struct DeviceBufferKeyHash
+        {
+            std::size_t operator()(const DeviceBufferKey& key) const
+            {
+                const auto rateChannels = (std::uint64_t(key.m_sampleRate) << 8) ^ key.m_channels;
+                return std::hash<const void*>()(key.m_data) ^ std::hash<std::uint64_t>()(rateChannels * 0x9e3779b97f4a7c15ull);
+            }
+        };
+
+        struct DeviceBufferEntry
+        {
+            std::weak_ptr<const void>   m_source; //a new asset may reuse the address once this expired
+            std::weak_ptr<AudioBuffer>  m_buffer;
+        };
+
+        using DeviceBufferCache = std::unordered_map<DeviceBufferKey, DeviceBufferEntry, DeviceBufferKeyHash>;
+
+        Mutex               g_deviceBufferMutex;
+        DeviceBufferCache   g_deviceBufferCache;
+
+        constexpr double    PI = 3.14159265358979323846;
+
+        template<typename T>
+        void Deinterleave(const AudioMemory& pcm, std::uint32_t numChannels, std::uint32_t sampleSize, std::vector<Channel>& dest)
+        {
+            const auto numFrames = pcm.m_size / ( std::size_t(numChannels) * sampleSize );
+            dest.assign(numChannels, Channel(numFrames));
+            const auto* src = pcm.m_data;
+            for (std::size_t i = 0; i < numFrames; ++i) {
+                for (std::uint32_t c = 0; c < numChannels; ++c, src += sampleSize)
+                    dest[c][i] = SampleToFloat<T>(src);
+            }
+        }
+
+        //mono goes to the front pair, downmixing to mono averages all channels,
+        //otherwise matching channels are kept and the remaining ones are silent
+        std::vector<Channel> RemixChannels(std::vector<Channel>&& input, std::uint32_t numChannels)
+        {
+            const auto numInput = static_cast<std::uint32_t>(input.size());
+            if (numInput == numChannels)
+                return std::move(input);
+
+            const auto numFrames = input.front().size();
+            std::vector<Channel> result(numChannels, Channel(numFrames, 0.0f));
+            if (numInput == 1) {
+                for (std::uint32_t c = 0; c < std::min(numChannels, 2u); ++c)
+                    result[c] = input.front();
+            }
+            else if (numChannels == 1) {
+                const float scale = 1.0f / numInput;
+                for (const auto& channel : input) {
+                    for (std::size_t i = 0; i < numFrames; ++i)
+                        result.front()[i] += channel[i] * scale;
+                }
+            }
+            else {
+                for (std::uint32_t c = 0; c < std::min(numInput, numChannels); ++c)
+                    result[c] = std::move(input[c]);
+            }
+            return result;
+        }
+
+        //windowed sinc( Blackman ) sampled RESAMPLE_PHASES times per zero crossing
+        std::vector<float> CreateResampleKernel()
+        {
+            std::vector<float> kernel(RESAMPLE_HALF_TAPS * RESAMPLE_PHASES + 2, 0.0f);
+            for (std::uint32_t i = 0; i <= RESAMPLE_HALF_TAPS * RESAMPLE_PHASES; ++i)
+            {
+                const double x      = double(i) / RESAMPLE_PHASES;
+                const double r      = x / RESAMPLE_HALF_TAPS;
+                const double window = 0.42 + 0.5 * std::cos(PI * r) + 0.08 * std::cos(2.0 * PI * r);
+                const double sinc   = i ? std::sin(PI * x) / (PI * x) : 1.0;
+                kernel[i] = static_cast<float>(sinc * window);
+            }
+            return kernel;
+        }
+
+        Channel Resample(const Channel& input, std::uint32_t inRate, std::uint32_t outRate, const std::vector<float>& kernel)
+        {
+            const auto numInput  = static_cast<std::int64_t>(input.size());
+            const auto numOutput = static_cast<std::size_t>(std::uint64_t(numInput) * outRate / inRate);
+            const double step    = double(inRate) / outRate;
+            //lower the cutoff below the output nyquist when downsampling
+            const double cutoff  = std::min(1.0, double(outRate) / inRate) * 0.97;
+            const auto   width   = static_cast<std::int64_t>(std::ceil(RESAMPLE_HALF_TAPS / cutoff));
+            const double scale   = cutoff * RESAMPLE_PHASES;
+
+            Channel result(numOutput);
+            for (std::size_t n = 0; n < numOutput; ++n)
+            {
+                const double t     = n * step;
+                const auto   first = std::max<std::int64_t>(std::int64_t(t) - width + 1, 0);
+                const auto   last  = std::min<std::int64_t>(std::int64_t(t) + width, numInput - 1);
+                double acc = 0.0;
+                for (auto k = first; k <= last; ++k)
+                {
+                    const double pos = std::abs(t - double(k)) * scale;
+                    const auto   idx = static_cast<std::size_t>(pos);
+                    if (idx >= RESAMPLE_HALF_TAPS * RESAMPLE_PHASES)
+                        continue;
+                    const auto   frac = static_cast<float>(pos - double(idx));
+                    const float  tap  = kernel[idx] + ( kernel[idx + 1] - kernel[idx] ) * frac;
+                    acc += double(input[std::size_t(k)]) * tap;
+                }
+                result[n] = static_cast<float>(acc * cutoff);
+            }
+            return result;
+        }
+
+        AudioBufferPtr FindDeviceBuffer(const DeviceBufferKey& key)
+        {
+            auto it = g_deviceBufferCache.find(key);
+            if (it == std::end(g_deviceBufferCache) || it->second.m_source.expired())
+                return nullptr;
+            return it->second.m_buffer.lock();
+        }
+
+        void StoreDeviceBuffer(const DeviceBufferKey& key, const std::shared_ptr<const void>& source, const AudioBufferPtr& buffer)
+        {
+            //drop entries of assets or conversions that have been unloaded
+            for (auto iter = std::begin(g_deviceBufferCache); iter != std::end(g_deviceBufferCache); )
+            {
+                if (iter->second.m_source.expired() || iter->second.m_buffer.expired())
+                    iter = g_deviceBufferCache.erase(iter);
+                else
+                    ++iter;
+            }
+            g_deviceBufferCache[key] = { source, buffer };
+        }
+    }
+
+    bool IsDeviceFormat(const AudioConfig& format, const AudioConfig& device)
+    {
+        return format.m_format     == audio_format_f32 &&
+               format.m_channels   == device.m_channels &&
+               format.m_sampleRate == device.m_sampleRate;
+    }
+
+    AudioFormat GetDeviceFormat(const AudioFormat& format, const AudioConfig& device)
+    {
+        AudioFormat result = format;
+        result.m_type       = AUDIO_TYPE_WAV;
+        result.m_format     = audio_format_f32;
+        result.m_channels   = device.m_channels;
+        result.m_sampleRate = device.m_sampleRate;
+        return result;
+    }
+
+    AudioBufferPtr ConvertToDevice(const AudioMemory& pcm, const AudioFormat& format, const AudioConfig& device)
+    {
+        if (pcm.empty() || !format.m_channels || !format.m_sampleRate || !device.m_channels || !device.m_sampleRate)
+            throw AudioException("Invalid Conversion Parameters");
+
+        std::vector<Channel> channels;
+        const auto sampleSize = format.getBytesPerSample() / format.m_channels;
+        switch (format.m_format)
+        {
+            case audio_format_u8:
+                Deinterleave<std::uint8_t>(pcm, format.m_channels, sampleSize, channels);
+                break;
+            case audio_format_s16:
+                Deinterleave<std::int16_t>(pcm, format.m_channels, sampleSize, channels);
+                break;
+            case audio_format_s24:
+                Deinterleave<Packed24>(pcm, format.m_channels, sampleSize, channels);
+                break;
+            case audio_format_s32:
+                Deinterleave<std::int32_t>(pcm, format.m_channels, sampleSize, channels);
+                break;
+            case audio_format_f32:
+                Deinterleave<float>(pcm, format.m_channels, sampleSize, channels);
+                break;
+            default:
+                throw AudioException("Unsupported Sound Format");
+        }
+
+        channels = RemixChannels(std::move(channels), device.m_channels);
+        if (format.m_sampleRate != device.m_sampleRate)
+        {
+            const auto kernel = CreateResampleKernel();
+            for (auto& channel : channels)
+                channel = Resample(channel, format.m_sampleRate, device.m_sampleRate, kernel);
+        }
+
+        const auto numFrames = channels.front().size();
+        auto result = std::make_shared<AudioBuffer>( numFrames * device.m_channels * sizeof(float) );
+        auto* dest  = reinterpret_cast<float*>( result->data() );
+        for (std::size_t i = 0; i < numFrames; ++i) {
+            for (const auto& channel : channels)
+                *dest++ = channel[i];
+        }
+        return result;
+    }
+
+    AudioBufferPtr AcquireDeviceBuffer(const AudioMemory& pcm, const AudioFormat& format, const AudioConfig& device)
+    {
+        if (pcm.m_buffer && IsDeviceFormat(format, device))
+            return pcm.m_buffer;
+        //memory without an owner may be reused behind our back, never cache it
+        if (!pcm.m_owner)
+            return ConvertToDevice(pcm, format, device);
+
+        const DeviceBufferKey key = { pcm.m_data, device.m_sampleRate, device.m_channels };
+        {
+            LockGuard lock(g_deviceBufferMutex);
+            if (auto buffer = FindDeviceBuffer(key))
+                return buffer;
+        }
+
+        //convert unlocked, two threads preparing the same asset both convert it once
+        auto buffer = ConvertToDevice(pcm, format, device);
+
+        LockGuard lock(g_deviceBufferMutex);
+        if (auto existing = FindDeviceBuffer(key))
+            return existing;
+        StoreDeviceBuffer(key, pcm.m_owner, buffer);
+        return buffer;
+    }
+
+    AudioBufferPtr AcquireDeviceBuffer(const VorbisSetupPtr& setup, const AudioConfig& device, std::uint32_t maxThreads)
+    {
+        const auto& memory = setup->getMemory();
+        const DeviceBufferKey key = { memory.m_data, device.m_sampleRate, device.m_channels };
+        {
+            LockGuard lock(g_deviceBufferMutex);
+            if (auto buffer = FindDeviceBuffer(key))
+                return buffer;
+        }
+
+        AudioFormat format;
+        format.m_format     = audio_format_s16;
+        format.m_channels   = setup->getNumChannels();
+        format.m_sampleRate = setup->getSampleRate();
+        auto buffer = ConvertToDevice(setup->decodeAll(maxThreads), format, device);
+
+        LockGuard lock(g_deviceBufferMutex);
+        if (auto existing = FindDeviceBuffer(key))
+            return existing;
+        //the setup keeps memory without an owner alive
+        StoreDeviceBuffer(key, memory.m_owner ? memory.m_owner : std::shared_ptr<const void>(setup), buffer);
+        return buffer;
+    }
+}
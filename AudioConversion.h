@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+
+#include "AudioConfig.h"
+#include "AudioBuffer.h"
+#include "VorbisSetupPtr.h"
+
+namespace Audio
+{
+    //zero crossings on each side of the windowed sinc resampling kernel
+    constexpr std::uint32_t RESAMPLE_HALF_TAPS = 16;
+    //kernel table entries between two zero crossings
+    constexpr std::uint32_t RESAMPLE_PHASES    = 512;
+
+    /*
+        @brief: True if the mixer can accumulate 'format' without converting
+        the sample format, the channel layout or the rate
+    */
+    bool                IsDeviceFormat( const AudioConfig& format, const AudioConfig& device );
+
+    /*
+        @brief: Format of an asset after 'ConvertToDevice', raw fp32 pcm at
+        the device rate and channel count. Usage and loop count are kept
+    */
+    AudioFormat         GetDeviceFormat( const AudioFormat& format, const AudioConfig& device );
+
+    /*
+        @brief: Converts interleaved pcm to fp32, remixes it to the device
+        channel count and resamples it to the device rate with a windowed
+        sinc filter. Meant for load time, throws on unsupported formats
+    */
+    AudioBufferPtr      ConvertToDevice( const AudioMemory& pcm, const AudioFormat& format, const AudioConfig& device );
+
+    /*
+        @brief: As 'ConvertToDevice', returns the converted buffer of a previous
+        call while it is alive instead of converting again. Buffers are cached
+        per source memory and device config
+    */
+    AudioBufferPtr      AcquireDeviceBuffer( const AudioMemory& pcm, const AudioFormat& format, const AudioConfig& device );
+
+    /*
+        @brief: Decodes the whole Vorbis asset on up to 'maxThreads' threads
+        and converts it, cached like the pcm version
+    */
+    AudioBufferPtr      AcquireDeviceBuffer( const VorbisSetupPtr& setup, const AudioConfig& device, std::uint32_t maxThreads = 0 );
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+
+#include "AudioBus.h"
+#include "AudioConfig.h"
+
+namespace Audio
+{
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Effect on a bus the mixer sums voices into, e.g. a reverb send.
+    // One instance is shared by every voice feeding the bus, so its cost
+    // doesn't depend on the number of voices
+    //////////////////////////////////////////////////////////////////////////
+    class AudioEffectBase
+    {
+    public:
+        virtual ~AudioEffectBase() = default;
+
+        /*
+            @brief: Prepares for the output 'format', called by the mixer before
+            the device starts
+        */
+        virtual bool            initialize( const AudioConfig& format ) = 0;
+
+        /*
+            @brief: Audio thread, replaces the first 'numChannels' channels of
+            'bus' with the effect output. Called for every block, also when
+            nothing feeds the bus so tails ring out
+        */
+        virtual void            process( AudioBus& bus, std::uint32_t numChannels, std::uint32_t numFrames ) = 0;
+
+        /*
+            @brief: Frames the output lags behind the input
+        */
+        virtual std::uint32_t   getLatency() const = 0;
+        virtual const char*     getName() const = 0;
+    };
+}
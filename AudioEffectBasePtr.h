@@ -0,0 +1,8 @@
+#pragma once
+#include <memory>
+
+namespace Audio
+{
+    class AudioEffectBase;
+    using AudioEffectBasePtr = std::shared_ptr<AudioEffectBase>;
+}
\ No newline at end of file
@@ -0,0 +1,328 @@
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include "AudioEffectConvolution.h"
+#include "AudioException.h"
+#include "AudioMixerBase.h"
+#include "WavFile.h"
+
+using namespace Common;
+
+namespace Audio
+{
+    namespace
+    {
+        constexpr std::uint32_t MIN_PARTITION_SIZE = 64;
+        constexpr std::uint32_t MAX_PARTITION_SIZE = 2048;
+        constexpr float         WORKER_POLL_FRACTION = 0.25f; //poll interval in partitions
+
+        /*
+            @brief: Best effort, above normal but below the mix thread so the
+            device is never starved by a long impulse response
+        */
+        void SetWorkerThreadPriority()
+        {
+#if defined(_WIN32)
+            SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+#else
+            sched_param param = {};
+            param.sched_priority = sched_get_priority_max(SCHED_FIFO) / 4;
+            pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+#endif
+        }
+
+        AudioConfig GetFloatFormat(std::uint32_t numChannels, std::uint32_t sampleRate)
+        {
+            AudioConfig format;
+            format.m_format     = audio_format_f32;
+            format.m_channels   = numChannels;
+            format.m_sampleRate = sampleRate;
+            return format;
+        }
+    }
+
+    EffectConvolution::EffectConvolution(const WavFile& impulseResponse, std::uint32_t partitionSize)
+        : m_irData( impulseResponse.m_waveData )
+        , m_partitionSize( partitionSize )
+        , m_numPartitions( 0 )
+        , m_numChannels( 0 )
+        , m_numIrChannels( 0 )
+        , m_frameSize( 0 )
+        , m_sampleRate( 0 )
+        , m_delayPos( 0 )
+        , m_primeFrames( 0 )
+        , m_latency( 0 )
+        , m_numLateFrames( 0 )
+        , m_wetGain( 1.0f )
+        , m_running( false )
+    {
+        m_irFormat.m_format     = impulseResponse.getSampleFormat();
+        m_irFormat.m_channels   = impulseResponse.m_header.m_channels;
+        m_irFormat.m_sampleRate = impulseResponse.m_header.m_frequency;
+
+        if (m_irFormat.m_format == audio_format_unknown || !m_irFormat.m_channels || !m_irFormat.m_sampleRate || !m_irData)
+            throw AudioException("Unsupported Impulse Response Format");
+        if (partitionSize < MIN_PARTITION_SIZE || partitionSize > MAX_PARTITION_SIZE || (partitionSize & (partitionSize - 1)))
+            throw AudioException("Partition Size Must Be A Power Of Two");
+
+        m_numIrChannels = std::min(m_irFormat.m_channels, AUDIO_BUS_MAX_CHANNELS);
+    }
+
+    EffectConvolution::EffectConvolution(const std::string& fileName, std::uint32_t partitionSize)
+        : EffectConvolution( WavFile(fileName), partitionSize )
+    {
+    }
+
+    EffectConvolution::~EffectConvolution()
+    {
+        stop();
+    }
+
+    bool EffectConvolution::initialize(const AudioConfig& format)
+    {
+        stop();
+
+        m_numChannels = std::min(format.getNumChannels(), AUDIO_BUS_MAX_CHANNELS);
+        m_frameSize   = m_numChannels * sizeof(float);
+        m_sampleRate  = format.getSampleRate();
+        if (!m_numChannels || !m_sampleRate)
+            return false;
+
+        //impulse response to fp32 at the output rate
+        const auto irFrameSize = m_irFormat.getBytesPerSample();
+        const auto maxIrFrames = static_cast<std::uint32_t>(CONVOLUTION_MAX_IR_LENGTH * m_irFormat.m_sampleRate);
+        const auto numIrFrames = std::min(static_cast<std::uint32_t>(m_irData->size() / irFrameSize), maxIrFrames);
+        if (!numIrFrames)
+            return false;
+
+        AudioBus response(m_numIrChannels, numIrFrames);
+        auto irFormat = m_irFormat;
+        irFormat.m_channels = m_numIrChannels;
+        if (m_irFormat.m_channels == m_numIrChannels)
+            DeinterleaveToBus(m_irData->data(), irFormat, numIrFrames, response);
+        else {
+            //extra channels are dropped
+            AudioBus all(m_irFormat.m_channels, numIrFrames);
+            DeinterleaveToBus(m_irData->data(), m_irFormat, numIrFrames, all);
+            for (std::uint32_t c = 0; c < m_numIrChannels; ++c)
+                memcpy(response.getChannel(c), all.getChannel(c), numIrFrames * sizeof(float));
+        }
+
+        auto numFrames = numIrFrames;
+        AudioBus resampled;
+        const AudioBus* ir = &response;
+        if (m_irFormat.m_sampleRate != m_sampleRate) {
+            numFrames = std::max(static_cast<std::uint32_t>(std::uint64_t(numIrFrames) * m_sampleRate / m_irFormat.m_sampleRate), 1u);
+            resampled.resize(m_numIrChannels, numFrames);
+            ResampleBus(response, numIrFrames, resampled, numFrames, m_numIrChannels);
+            ir = &resampled;
+        }
+
+        double energy = 0.0;
+        for (std::uint32_t c = 0; c < m_numIrChannels; ++c)
+            for (std::uint32_t i = 0; i < numFrames; ++i)
+                energy += double(ir->getChannel(c)[i]) * ir->getChannel(c)[i];
+        const auto scale = energy > 0.0 ? static_cast<float>(1.0 / std::sqrt(energy / m_numIrChannels)) : 0.0f;
+
+        //spectrum of every partition, zero padded to twice its size
+        const auto B = m_partitionSize;
+        m_fft = std::make_unique<AudioFFT>(2 * B);
+        const auto numBins = m_fft->getNumBins();
+        m_numPartitions = (numFrames + B - 1) / B;
+        m_irSpectra.resize(2 * m_numPartitions * m_numIrChannels, numBins);
+        m_output.resize(1, 2 * B);
+        for (std::uint32_t p = 0; p < m_numPartitions; ++p)
+        {
+            for (std::uint32_t c = 0; c < m_numIrChannels; ++c)
+            {
+                auto* time = m_output.getChannel(0);
+                const auto count = std::min(B, numFrames - p * B);
+                memset(time, 0, 2 * B * sizeof(float));
+                for (std::uint32_t i = 0; i < count; ++i)
+                    time[i] = ir->getChannel(c)[p * B + i] * scale;
+
+                const auto index = 2 * (p * m_numIrChannels + c);
+                m_fft->forward(time, m_irSpectra.getChannel(index), m_irSpectra.getChannel(index + 1));
+            }
+        }
+
+        m_delayLine.resize(2 * m_numPartitions * m_numChannels, numBins);
+        m_history.resize(m_numChannels, 2 * B);
+        m_spectrum.resize(2, numBins);
+        m_block.assign(B * m_numChannels, 0.0f);
+        m_scratch.assign(AUDIO_MIX_MAX_FRAMES * m_numChannels, 0.0f);
+        m_delayPos  = 0;
+        //the mixer never sends more than one pass, the period may be renegotiated
+        m_primeFrames = m_partitionSize + AUDIO_MIX_MAX_FRAMES;
+        m_inputRing.reset();
+        m_outputRing.reset();
+        m_latency.store(0, std::memory_order_relaxed);
+        m_numLateFrames.store(0, std::memory_order_relaxed);
+
+        start();
+        return true;
+    }
+
+    void EffectConvolution::process(AudioBus& bus, std::uint32_t numChannels, std::uint32_t numFrames)
+    {
+        //the rings are laid out for the channels of 'initialize'
+        assert(!m_frameSize || numChannels == m_numChannels);
+        (void)numChannels;
+        if (!m_frameSize)
+            return;
+
+        //send -> worker, a full ring means the worker stalled & the block is lost
+        numFrames = std::min(numFrames, AUDIO_MIX_MAX_FRAMES);
+        InterleaveBus(bus, m_numChannels, numFrames, m_scratch.data());
+        const auto numBytes = numFrames * m_frameSize;
+        if (m_inputRing.freeBytes() >= numBytes)
+            m_inputRing.writeData(m_scratch.data(), numBytes);
+
+        //no notify, the worker polls so the audio thread never touches a lock
+
+        //wet <- worker, silence until one partition plus the longest block
+        //built up so the worker has a whole block for every block. A block it
+        //hasn't delivered in full by then is silence too & delays the rest
+        const auto latency = m_latency.load(std::memory_order_relaxed);
+        if (latency >= m_primeFrames && m_outputRing.availableBytes() >= numBytes)
+            m_outputRing.readData(m_scratch.data(), numBytes);
+        else
+        {
+            memset(m_scratch.data(), 0, numBytes);
+            m_latency.store(latency + numFrames, std::memory_order_relaxed);
+            if (latency >= m_primeFrames)
+                m_numLateFrames.fetch_add(numFrames, std::memory_order_relaxed);
+        }
+
+        DeinterleaveToBus(m_scratch.data(), GetFloatFormat(m_numChannels, m_sampleRate), numFrames, bus);
+    }
+
+    std::uint32_t EffectConvolution::getLatency() const
+    {
+        return m_latency.load(std::memory_order_relaxed);
+    }
+
+    const char* EffectConvolution::getName() const
+    {
+        return "Convolution";
+    }
+
+    void EffectConvolution::setWetGain(float gain)
+    {
+        m_wetGain.store(gain, std::memory_order_relaxed);
+    }
+
+    float EffectConvolution::getWetGain() const
+    {
+        return m_wetGain.load(std::memory_order_relaxed);
+    }
+
+    std::uint32_t EffectConvolution::getNumPartitions() const
+    {
+        return m_numPartitions;
+    }
+
+    std::uint32_t EffectConvolution::getNumLateFrames() const
+    {
+        return m_numLateFrames.load(std::memory_order_relaxed);
+    }
+
+    void EffectConvolution::start()
+    {
+        m_running = true;
+        m_thread = std::thread(&EffectConvolution::workLoop, this);
+    }
+
+    void EffectConvolution::stop()
+    {
+        {
+            std::unique_lock<Mutex> lock(m_wakeMutex);
+            m_running = false;
+        }
+        m_wake.notify_all();
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+
+    void EffectConvolution::workLoop()
+    {
+        SetWorkerThreadPriority();
+        while (m_running)
+        {
+            while (hasBlock())
+                convolveBlock();
+
+            //polls a few times per partition, the priming leaves a whole mixer
+            //pass of slack on top of it. Only 'stop' notifies
+            const auto timeout = std::chrono::duration<float>(WORKER_POLL_FRACTION * m_partitionSize / m_sampleRate);
+            std::unique_lock<Mutex> lock(m_wakeMutex);
+            m_wake.wait_for(lock, timeout, [this]() {
+                return !m_running;
+            });
+        }
+    }
+
+    void EffectConvolution::convolveBlock()
+    {
+        const auto B = m_partitionSize;
+        const auto P = m_numPartitions;
+        const auto numBins = m_fft->getNumBins();
+        m_inputRing.readData(m_block.data(), B * m_frameSize);
+
+        //slide the input by one partition & add its spectrum to the delay line
+        for (std::uint32_t c = 0; c < m_numChannels; ++c)
+        {
+            auto* history = m_history.getChannel(c);
+            memcpy(history, history + B, B * sizeof(float));
+            for (std::uint32_t i = 0; i < B; ++i)
+                history[B + i] = m_block[i * m_numChannels + c];
+
+            const auto index = 2 * (m_delayPos * m_numChannels + c);
+            m_fft->forward(history, m_delayLine.getChannel(index), m_delayLine.getChannel(index + 1));
+        }
+
+        //partition p of the response meets the input of p blocks ago, the
+        //second half of the inverse is free of circular wrap around
+        const auto wetGain = m_wetGain.load(std::memory_order_relaxed);
+        auto* sumRe = m_spectrum.getChannel(0);
+        auto* sumIm = m_spectrum.getChannel(1);
+        const auto* time = m_output.getChannel(0);
+        for (std::uint32_t c = 0; c < m_numChannels; ++c)
+        {
+            memset(sumRe, 0, m_spectrum.getMaxFrames() * sizeof(float));
+            memset(sumIm, 0, m_spectrum.getMaxFrames() * sizeof(float));
+            for (std::uint32_t p = 0; p < P; ++p)
+            {
+                const auto input    = 2 * (((m_delayPos + P - p) % P) * m_numChannels + c);
+                const auto response = 2 * (p * m_numIrChannels + c % m_numIrChannels);
+                ComplexMultiplyAccumulate(m_delayLine.getChannel(input), m_delayLine.getChannel(input + 1),
+                                          m_irSpectra.getChannel(response), m_irSpectra.getChannel(response + 1),
+                                          sumRe, sumIm, numBins);
+            }
+
+            m_fft->inverse(sumRe, sumIm, m_output.getChannel(0));
+            for (std::uint32_t i = 0; i < B; ++i)
+                m_block[i * m_numChannels + c] = time[B + i] * wetGain;
+        }
+
+        m_delayPos = (m_delayPos + 1) % P;
+        m_outputRing.writeData(m_block.data(), B * m_frameSize);
+    }
+
+    bool EffectConvolution::hasBlock() const
+    {
+        const auto blockBytes = m_partitionSize * m_frameSize;
+        return m_inputRing.availableBytes() >= blockBytes && m_outputRing.freeBytes() >= blockBytes;
+    }
+}
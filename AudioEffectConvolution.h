@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Common/Thread.h>
+
+#include "AudioBuffer.h"
+#include "AudioBus.h"
+#include "AudioEffectBase.h"
+#include "AudioFFT.h"
+#include "AudioRingBuffer.h"
+
+namespace Audio
+{
+    struct WavFile;
+
+    //frames per partition unless given, ~10.7 ms at 48 kHz
+    constexpr std::uint32_t CONVOLUTION_PARTITION_SIZE = 512;
+    //longest impulse response used, the rest is cut off
+    constexpr float         CONVOLUTION_MAX_IR_LENGTH  = 10.0f;
+    //256 KiB, 8192 frames of 8 fp32 channels
+    constexpr int           CONVOLUTION_RING_SIZE      = 1 << 18;
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Convolution reverb, uniformly partitioned overlap-save FFT
+    // convolution with a frequency domain delay line. The impulse response
+    // is cut into partitions of 'partitionSize' frames and every partition
+    // costs one complex multiply-add per block. Blocks are convolved on a
+    // worker thread fed through lock free rings, so the audio thread only
+    // copies. The wet signal lags the send by one partition plus one
+    // mixer pass, more if the worker falls behind
+    //////////////////////////////////////////////////////////////////////////
+    class EffectConvolution : public AudioEffectBase
+    {
+    public:
+        /*
+            @brief: Input channel c is convolved with channel c of the impulse
+            response, wrapping around if it has fewer. The response is
+            normalized to unit energy
+        */
+        EffectConvolution( const WavFile& impulseResponse, std::uint32_t partitionSize = CONVOLUTION_PARTITION_SIZE );
+        EffectConvolution( const std::string& fileName, std::uint32_t partitionSize = CONVOLUTION_PARTITION_SIZE );
+        ~EffectConvolution() override;
+
+        EffectConvolution( const EffectConvolution& ) = delete;
+        EffectConvolution& operator = ( const EffectConvolution& ) = delete;
+
+        bool                initialize( const AudioConfig& format ) override;
+        void                process( AudioBus& bus, std::uint32_t numChannels, std::uint32_t numFrames ) override;
+        std::uint32_t       getLatency() const override;
+        const char*         getName() const override;
+
+        void                setWetGain( float gain );
+        float               getWetGain() const;
+
+        std::uint32_t       getNumPartitions() const;
+
+        /*
+            @brief: Frames of silence the audio thread filled in because the
+            worker was late, every one of them adds to the latency
+        */
+        std::uint32_t       getNumLateFrames() const;
+
+    private:
+        void                start();
+        void                stop();
+        void                workLoop();
+        void                convolveBlock();
+        bool                hasBlock() const;
+
+        //impulse response as loaded
+        AudioBufferPtr                          m_irData;
+        AudioConfig                             m_irFormat;
+
+        std::uint32_t                           m_partitionSize;
+        std::uint32_t                           m_numPartitions;
+        std::uint32_t                           m_numChannels;
+        std::uint32_t                           m_numIrChannels;
+        std::uint32_t                           m_frameSize;
+        std::uint32_t                           m_sampleRate;
+
+        //worker thread only
+        std::unique_ptr<AudioFFT>               m_fft;
+        AudioBus                                m_irSpectra;    //re, im per partition & channel
+        AudioBus                                m_delayLine;    //re, im per partition & channel, input spectra
+        AudioBus                                m_history;      //last two partitions of input per channel
+        AudioBus                                m_spectrum;     //re, im, sum of the delay line
+        AudioBus                                m_output;       //time domain of the sum
+        std::vector<float>                      m_block;        //interleaved
+        std::uint32_t                           m_delayPos;
+
+        //audio thread only
+        std::vector<float>                      m_scratch;
+        std::uint32_t                           m_primeFrames;  //latency built up before the first read, one partition plus one mixer pass
+
+        AudioRingBuffer<CONVOLUTION_RING_SIZE>  m_inputRing;    //audio thread -> worker
+        AudioRingBuffer<CONVOLUTION_RING_SIZE>  m_outputRing;   //worker -> audio thread
+        std::atomic<std::uint32_t>              m_latency;
+        std::atomic<std::uint32_t>              m_numLateFrames;
+        std::atomic<float>                      m_wetGain;
+
+        std::thread                             m_thread;
+        std::atomic<bool>                       m_running;
+        Common::Mutex                           m_wakeMutex;
+        std::condition_variable_any             m_wake;
+    };
+}
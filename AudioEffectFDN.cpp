@@ -0,0 +1,332 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUDIO_FDN_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "AudioEffectFDN.h"
+
+using namespace Common;
+
+namespace Audio
+{
+    namespace
+    {
+        //delay lengths at room size 1, ~11% apart, 8 line networks use every second one
+        constexpr float LINE_LENGTHS_MS[FDN_MAX_LINES] = {
+            9.7f, 10.9f, 12.1f, 13.4f, 14.9f, 16.6f, 18.4f, 20.5f,
+            22.8f, 25.3f, 28.1f, 31.2f, 34.7f, 38.6f, 42.9f, 47.7f
+        };
+        constexpr float MIN_ROOM_SIZE = 0.25f;
+        constexpr float MAX_ROOM_SIZE = 4.0f;
+        constexpr float MIN_DECAY_TIME = 0.05f;
+        constexpr float MAX_DAMPING = 0.95f;
+        constexpr std::uint32_t LINE_PADDING = 16;
+
+        const FDNReverbSettings PRESETS[FDN_PRESET_COUNT] = {
+            //lines, size, decay, damping, pre-delay, wet
+            { 8,  0.5f, 0.4f, 0.55f, 0.002f, 0.5f },
+            { 8,  1.0f, 0.8f, 0.45f, 0.008f, 0.5f },
+            { 8,  1.6f, 1.3f, 0.5f,  0.004f, 0.5f },
+            { 16, 2.0f, 2.2f, 0.3f,  0.02f,  0.5f },
+            { 16, 3.0f, 4.5f, 0.15f, 0.03f,  0.5f }
+        };
+        const char* PRESET_NAMES[FDN_PRESET_COUNT] = { "Small Room", "Room", "Corridor", "Hall", "Cave" };
+
+        bool IsPrime(std::uint32_t value)
+        {
+            if (value < 2)
+                return false;
+            for (std::uint32_t i = 2; i * i <= value; ++i)
+                if (value % i == 0)
+                    return false;
+            return true;
+        }
+
+        /*
+            @brief: Mutually prime lengths keep the echoes of different lines
+            from piling up on the same frames
+        */
+        std::uint32_t NextPrime(std::uint32_t value)
+        {
+            while (!IsPrime(value))
+                ++value;
+            return value;
+        }
+
+        std::uint32_t NextPowerOfTwo(std::uint32_t value)
+        {
+            std::uint32_t result = 1;
+            while (result < value)
+                result <<= 1;
+            return result;
+        }
+
+#ifdef AUDIO_FDN_SSE2
+        inline float HorizontalSum(__m128 value)
+        {
+            auto shuffled = _mm_shuffle_ps(value, value, _MM_SHUFFLE(2, 3, 0, 1));
+            auto sums     = _mm_add_ps(value, shuffled);
+            shuffled      = _mm_movehl_ps(shuffled, sums);
+            return _mm_cvtss_f32(_mm_add_ss(sums, shuffled));
+        }
+#endif
+    }
+
+    FDNReverbSettings GetFDNReverbPreset(eFDNReverbPreset preset)
+    {
+        return preset < FDN_PRESET_COUNT ? PRESETS[preset] : FDNReverbSettings();
+    }
+
+    const char* GetFDNReverbPresetName(eFDNReverbPreset preset)
+    {
+        return preset < FDN_PRESET_COUNT ? PRESET_NAMES[preset] : "Unknown";
+    }
+
+    EffectFDN::EffectFDN(const FDNReverbSettings& settings)
+        : m_settings( settings )
+        , m_lastSettings( settings )
+        , m_lineMask( 0 )
+        , m_preDelayMask( 0 )
+        , m_writePos( 0 )
+        , m_sampleRate( 0 )
+        , m_numLines( 0 )
+        , m_preDelay( 0 )
+        , m_damping( 0.0f )
+    {
+    }
+
+    bool EffectFDN::initialize(const AudioConfig& format)
+    {
+        m_sampleRate = format.getSampleRate();
+        if (!m_sampleRate)
+            return false;
+
+        //room for the longest line at the largest room size, prime rounding included
+        const auto maxLength = static_cast<std::uint32_t>(LINE_LENGTHS_MS[FDN_MAX_LINES - 1] * MAX_ROOM_SIZE * m_sampleRate / 1000.0f);
+        const auto lineSize  = NextPowerOfTwo(maxLength + maxLength / 16 + 1);
+        //lines are a cache line longer than used, so their write positions
+        //don't all map to the same cache set
+        m_lines.resize(FDN_MAX_LINES, lineSize + LINE_PADDING);
+        m_lineMask = lineSize - 1;
+
+        const auto preDelaySize = NextPowerOfTwo(static_cast<std::uint32_t>(FDN_MAX_PRE_DELAY * m_sampleRate) + 1);
+        m_preDelayLine.resize(1, preDelaySize);
+        m_preDelayMask = preDelaySize - 1;
+
+        m_writePos = 0;
+        std::fill(std::begin(m_states), std::end(m_states), 0.0f);
+        applySettings();
+        return true;
+    }
+
+    void EffectFDN::process(AudioBus& bus, std::uint32_t numChannels, std::uint32_t numFrames)
+    {
+        if (!m_sampleRate || !numChannels)
+            return;
+
+        //only the latest queued settings matter
+        FDNReverbSettings settings;
+        bool changed = false;
+        while (m_settingsQueue.readData(&settings, sizeof(settings)) == sizeof(settings))
+            changed = true;
+        if (changed) {
+            m_settings = settings;
+            applySettings();
+        }
+
+#ifdef AUDIO_FDN_SSE2
+        //the tail decays into denormals, flush them for the whole block
+        const auto csr = _mm_getcsr();
+        _mm_setcsr(csr | 0x8040);
+#endif
+
+        //mono input after the pre-delay, in place of the first channel
+        numChannels = std::min(numChannels, AUDIO_BUS_MAX_CHANNELS);
+        float* channels[AUDIO_BUS_MAX_CHANNELS];
+        for (std::uint32_t c = 0; c < numChannels; ++c)
+            channels[c] = bus.getChannel(c);
+
+        const auto inputScale = 1.0f / numChannels;
+        auto* preDelayLine = m_preDelayLine.getChannel(0);
+        for (std::uint32_t n = 0; n < numFrames; ++n)
+        {
+            float input = 0.0f;
+            for (std::uint32_t c = 0; c < numChannels; ++c)
+                input += channels[c][n];
+            const auto pos = m_writePos + n;
+            preDelayLine[pos & m_preDelayMask] = input * inputScale;
+            channels[0][n] = preDelayLine[(pos - m_preDelay) & m_preDelayMask];
+        }
+
+        if (m_numLines == FDN_MAX_LINES)
+            processLines<FDN_MAX_LINES / 4>(channels, numChannels, numFrames);
+        else
+            processLines<2>(channels, numChannels, numFrames);
+        m_writePos += numFrames;
+
+#ifdef AUDIO_FDN_SSE2
+        _mm_setcsr(csr);
+#endif
+    }
+
+    std::uint32_t EffectFDN::getLatency() const
+    {
+        //the pre-delay is part of the sound, not latency
+        return 0;
+    }
+
+    const char* EffectFDN::getName() const
+    {
+        return "FDN Reverb";
+    }
+
+    bool EffectFDN::setSettings(const FDNReverbSettings& settings)
+    {
+        LockGuard lock(m_settingsMutex);
+        if (m_settingsQueue.freeBytes() < sizeof(settings))
+            return false;
+        m_settingsQueue.writeData(&settings, sizeof(settings));
+        m_lastSettings = settings;
+        return true;
+    }
+
+    bool EffectFDN::setPreset(eFDNReverbPreset preset)
+    {
+        return setSettings(GetFDNReverbPreset(preset));
+    }
+
+    FDNReverbSettings EffectFDN::getSettings() const
+    {
+        LockGuard lock(m_settingsMutex);
+        return m_lastSettings;
+    }
+
+    template<std::uint32_t NUM_QUADS>
+    void EffectFDN::processLines(float* const* channels, std::uint32_t numChannels, std::uint32_t numFrames)
+    {
+        constexpr std::uint32_t N = 4 * NUM_QUADS;
+        const auto mixScale = 2.0f / N;
+        const auto wetGain  = m_settings.m_wetGain;
+        const auto mask     = m_lineMask;
+        float* lines[N];
+        for (std::uint32_t i = 0; i < N; ++i)
+            lines[i] = m_lines.getChannel(i);
+
+        auto writePos = m_writePos;
+#ifdef AUDIO_FDN_SSE2
+        //network state stays in registers for the whole block
+        const auto damping = _mm_set1_ps(m_damping);
+        __m128 states[NUM_QUADS], gains[NUM_QUADS], inputs[NUM_QUADS], left[NUM_QUADS], right[NUM_QUADS];
+        for (std::uint32_t q = 0; q < NUM_QUADS; ++q) {
+            states[q] = _mm_load_ps(m_states + 4 * q);
+            gains[q]  = _mm_load_ps(m_gains + 4 * q);
+            inputs[q] = _mm_load_ps(m_inputs + 4 * q);
+            left[q]   = _mm_load_ps(m_taps[0] + 4 * q);
+            right[q]  = _mm_load_ps(m_taps[1] + 4 * q);
+        }
+
+        for (std::uint32_t n = 0; n < numFrames; ++n, ++writePos)
+        {
+            //damp & decay every line, then reflect them on the Householder
+            //plane, x - 2/N * sum( x ), and feed them back with the input
+            __m128 decayed[NUM_QUADS];
+            auto sum      = _mm_setzero_ps();
+            auto sumLeft  = _mm_setzero_ps();
+            auto sumRight = _mm_setzero_ps();
+            for (std::uint32_t q = 0; q < NUM_QUADS; ++q)
+            {
+                //gathered in registers, a vector load of 4 scalar stores stalls
+                auto* const* quad = lines + 4 * q;
+                const auto* lengths = m_lengths + 4 * q;
+                const auto y = _mm_setr_ps(quad[0][(writePos - lengths[0]) & mask], quad[1][(writePos - lengths[1]) & mask],
+                                           quad[2][(writePos - lengths[2]) & mask], quad[3][(writePos - lengths[3]) & mask]);
+                states[q]  = _mm_add_ps(y, _mm_mul_ps(damping, _mm_sub_ps(states[q], y)));
+                decayed[q] = _mm_mul_ps(states[q], gains[q]);
+                sum      = _mm_add_ps(sum, decayed[q]);
+                sumLeft  = _mm_add_ps(sumLeft, _mm_mul_ps(y, left[q]));
+                sumRight = _mm_add_ps(sumRight, _mm_mul_ps(y, right[q]));
+            }
+
+            const auto reflect = _mm_set1_ps(HorizontalSum(sum) * mixScale);
+            const auto feed    = _mm_set1_ps(channels[0][n]);
+            alignas(16) float feedback[N];
+            for (std::uint32_t q = 0; q < NUM_QUADS; ++q)
+                _mm_store_ps(feedback + 4 * q, _mm_add_ps(_mm_sub_ps(decayed[q], reflect), _mm_mul_ps(feed, inputs[q])));
+            for (std::uint32_t i = 0; i < N; ++i)
+                lines[i][writePos & mask] = feedback[i];
+
+            //mono gets the first tap only, so it stays as loud as a single side
+            const auto outLeft  = HorizontalSum(sumLeft) * wetGain;
+            const auto outRight = HorizontalSum(sumRight) * wetGain;
+            for (std::uint32_t c = 0; c < numChannels; ++c)
+                channels[c][n] = c & 1 ? outRight : outLeft;
+        }
+
+        for (std::uint32_t q = 0; q < NUM_QUADS; ++q)
+            _mm_store_ps(m_states + 4 * q, states[q]);
+#else
+        for (std::uint32_t n = 0; n < numFrames; ++n, ++writePos)
+        {
+            float feedback[N];
+            float sum = 0.0f, outLeft = 0.0f, outRight = 0.0f;
+            for (std::uint32_t i = 0; i < N; ++i)
+            {
+                const auto y = lines[i][(writePos - m_lengths[i]) & mask];
+                m_states[i] = y + m_damping * (m_states[i] - y);
+                feedback[i] = m_states[i] * m_gains[i];
+                sum      += feedback[i];
+                outLeft  += y * m_taps[0][i];
+                outRight += y * m_taps[1][i];
+            }
+
+            const auto reflect = sum * mixScale;
+            const auto input   = channels[0][n];
+            for (std::uint32_t i = 0; i < N; ++i)
+                lines[i][writePos & mask] = feedback[i] - reflect + input * m_inputs[i];
+
+            for (std::uint32_t c = 0; c < numChannels; ++c)
+                channels[c][n] = (c & 1 ? outRight : outLeft) * wetGain;
+        }
+#endif
+    }
+
+    void EffectFDN::applySettings()
+    {
+        //lines joining the network start out silent
+        const auto numLines = m_settings.m_numLines > 8 ? FDN_MAX_LINES : 8;
+        for (auto i = m_numLines; i < numLines; ++i) {
+            memset(m_lines.getChannel(i), 0, (m_lineMask + 1) * sizeof(float));
+            m_states[i] = 0.0f;
+        }
+        m_numLines = numLines;
+        const auto roomSize  = std::min(std::max(m_settings.m_roomSize, MIN_ROOM_SIZE), MAX_ROOM_SIZE);
+        const auto decayTime = std::max(m_settings.m_decayTime, MIN_DECAY_TIME);
+        m_damping  = std::min(std::max(m_settings.m_damping, 0.0f), MAX_DAMPING);
+        m_preDelay = std::min(static_cast<std::uint32_t>(std::max(m_settings.m_preDelay, 0.0f) * m_sampleRate), m_preDelayMask);
+
+        //-60 dB after 'decayTime', spread over the passes through each line
+        const auto step = FDN_MAX_LINES / m_numLines;
+        float meanGain = 0.0f;
+        for (std::uint32_t i = 0; i < m_numLines; ++i)
+        {
+            const auto length = LINE_LENGTHS_MS[i * step + step - 1] * roomSize * m_sampleRate / 1000.0f;
+            m_lengths[i] = std::min(NextPrime(static_cast<std::uint32_t>(length)), m_lineMask);
+            m_gains[i]   = std::pow(10.0f, -3.0f * m_lengths[i] / (decayTime * m_sampleRate));
+            meanGain += m_gains[i] / m_numLines;
+        }
+
+        //input & taps are sign patterns orthogonal to each other, the taps
+        //are scaled so the response has about unit energy
+        const auto tapScale = std::sqrt((1.0f - meanGain * meanGain) / m_numLines);
+        for (std::uint32_t i = 0; i < m_numLines; ++i)
+        {
+            m_inputs[i]  = (i & 4) ? -1.0f : 1.0f;
+            m_taps[0][i] = ((i & 1) ? -1.0f : 1.0f) * tapScale;
+            m_taps[1][i] = ((i & 2) ? -1.0f : 1.0f) * tapScale;
+        }
+    }
+}
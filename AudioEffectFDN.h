@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+
+#include <Common/Thread.h>
+
+#include "AudioBus.h"
+#include "AudioEffectBase.h"
+#include "AudioRingBuffer.h"
+
+namespace Audio
+{
+    //delay lines of the largest network, processed 4 at a time
+    constexpr std::uint32_t FDN_MAX_LINES     = 16;
+    //seconds the input may be delayed before it enters the network
+    constexpr float         FDN_MAX_PRE_DELAY = 0.25f;
+
+    enum eFDNReverbPreset : std::uint32_t
+    {
+        FDN_PRESET_SMALL_ROOM,
+        FDN_PRESET_ROOM,
+        FDN_PRESET_CORRIDOR,
+        FDN_PRESET_HALL,
+        FDN_PRESET_CAVE,
+        FDN_PRESET_COUNT
+    };
+
+    struct FDNReverbSettings
+    {
+        std::uint32_t   m_numLines  = 8;     //8 or 16
+        float           m_roomSize  = 1.0f;  //scales the delay lengths, 1 is ~10 to 50 ms, [0.25..4]
+        float           m_decayTime = 0.8f;  //seconds to -60 dB
+        float           m_damping   = 0.4f;  //high frequencies decay faster, [0..0.95]
+        float           m_preDelay  = 0.01f; //seconds
+        float           m_wetGain   = 0.5f;
+    };
+
+    FDNReverbSettings   GetFDNReverbPreset( eFDNReverbPreset preset );
+    const char*         GetFDNReverbPresetName( eFDNReverbPreset preset );
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Algorithmic reverb, a feedback delay network of 8 or 16 lines
+    // mixed by a Householder matrix. Every line has its own decay gain &
+    // one-pole damping, the lines are processed 4 at a time in SSE2 lanes.
+    // The cost per frame is fixed by the number of lines, independent of
+    // the number of voices feeding the bus. Mono in, two decorrelated taps
+    // out, even channels get the first & odd ones the second
+    //////////////////////////////////////////////////////////////////////////
+    class EffectFDN : public AudioEffectBase
+    {
+    public:
+        explicit EffectFDN( const FDNReverbSettings& settings = GetFDNReverbPreset(FDN_PRESET_ROOM) );
+
+        EffectFDN( const EffectFDN& ) = delete;
+        EffectFDN& operator = ( const EffectFDN& ) = delete;
+
+        bool                initialize( const AudioConfig& format ) override;
+        void                process( AudioBus& bus, std::uint32_t numChannels, std::uint32_t numFrames ) override;
+        std::uint32_t       getLatency() const override;
+        const char*         getName() const override;
+
+        /*
+            @brief: Game side, the audio thread picks the settings up with its
+            next block & the tail keeps ringing through the new network.
+            Returns false if too many changes are still queued
+        */
+        bool                setSettings( const FDNReverbSettings& settings );
+        bool                setPreset( eFDNReverbPreset preset );
+        FDNReverbSettings   getSettings() const;
+
+    private:
+        /*
+            @brief: Audio thread, delay lengths & gains of 'm_settings'
+        */
+        void                applySettings();
+
+        /*
+            @brief: Runs the network of 4 * NUM_QUADS lines, the input is read
+            from the first channel & the output written to all of them
+        */
+        template<std::uint32_t NUM_QUADS>
+        void                processLines( float* const* channels, std::uint32_t numChannels, std::uint32_t numFrames );
+
+        static constexpr int        SETTINGS_QUEUE_SIZE = 1024;
+
+        FDNReverbSettings           m_settings;         //audio thread
+        FDNReverbSettings           m_lastSettings;     //game side, guarded by m_settingsMutex
+        mutable Common::Mutex       m_settingsMutex;
+        AudioRingBuffer<SETTINGS_QUEUE_SIZE> m_settingsQueue; //game side -> audio thread
+
+        AudioBus                    m_lines;            //one delay line per channel
+        AudioBus                    m_preDelayLine;
+        std::uint32_t               m_lineMask;
+        std::uint32_t               m_preDelayMask;
+        std::uint32_t               m_writePos;
+        std::uint32_t               m_sampleRate;
+
+        std::uint32_t               m_numLines;
+        std::uint32_t               m_lengths[FDN_MAX_LINES];
+        std::uint32_t               m_preDelay;
+        alignas(16) float           m_gains[FDN_MAX_LINES];     //per pass, from the decay time & length
+        alignas(16) float           m_states[FDN_MAX_LINES];    //damping low-pass
+        alignas(16) float           m_inputs[FDN_MAX_LINES];    //input distribution
+        alignas(16) float           m_taps[2][FDN_MAX_LINES];   //output taps, normalized
+        float                       m_damping;
+    };
+}
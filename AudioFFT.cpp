@@ -0,0 +1,198 @@
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUDIO_FFT_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "AudioException.h"
+#include "AudioFFT.h"
+
+namespace Audio
+{
+    namespace
+    {
+        constexpr double        TWO_PI       = 6.283185307179586;
+        constexpr std::uint32_t MIN_FFT_SIZE = 16;
+    }
+
+    AudioFFT::AudioFFT(std::uint32_t size)
+        : m_size( size )
+    {
+        if (size < MIN_FFT_SIZE || (size & (size - 1)))
+            throw AudioException("FFT Size Must Be A Power Of Two");
+
+        const auto half = size / 2;
+        std::uint32_t numBits = 0;
+        while ((1u << numBits) < half)
+            ++numBits;
+
+        m_bitReverse.resize(half);
+        for (std::uint32_t i = 0; i < half; ++i)
+        {
+            std::uint32_t reversed = 0;
+            for (std::uint32_t bit = 0; bit < numBits; ++bit)
+                reversed |= ((i >> bit) & 1) << (numBits - 1 - bit);
+            m_bitReverse[i] = reversed;
+        }
+
+        //stage twiddles are stored at their half size, so vector stages load aligned
+        m_twiddles.resize(2, half);
+        auto* twRe = m_twiddles.getChannel(0);
+        auto* twIm = m_twiddles.getChannel(1);
+        for (std::uint32_t h = 1; h < half; h *= 2)
+        {
+            for (std::uint32_t j = 0; j < h; ++j) {
+                twRe[h + j] = static_cast<float>( std::cos(-TWO_PI * j / (2.0 * h)) );
+                twIm[h + j] = static_cast<float>( std::sin(-TWO_PI * j / (2.0 * h)) );
+            }
+        }
+
+        m_post.resize(2, half);
+        for (std::uint32_t k = 0; k < half; ++k) {
+            m_post.getChannel(0)[k] = static_cast<float>( std::cos(-TWO_PI * k / size) );
+            m_post.getChannel(1)[k] = static_cast<float>( std::sin(-TWO_PI * k / size) );
+        }
+
+        m_work.resize(2, half);
+    }
+
+    std::uint32_t AudioFFT::getSize() const
+    {
+        return m_size;
+    }
+
+    std::uint32_t AudioFFT::getNumBins() const
+    {
+        return m_size / 2 + 1;
+    }
+
+    void AudioFFT::forward(const float* input, float* re, float* im)
+    {
+        //even samples as real, odd as imaginary part of a half size complex FFT
+        const auto half = m_size / 2;
+        auto* zRe = m_work.getChannel(0);
+        auto* zIm = m_work.getChannel(1);
+        for (std::uint32_t n = 0; n < half; ++n) {
+            zRe[n] = input[2 * m_bitReverse[n]];
+            zIm[n] = input[2 * m_bitReverse[n] + 1];
+        }
+        transform(zRe, zIm);
+
+        //split into the spectrum of the real input
+        const auto* postRe = m_post.getChannel(0);
+        const auto* postIm = m_post.getChannel(1);
+        re[0]    = zRe[0] + zIm[0];
+        im[0]    = 0.0f;
+        re[half] = zRe[0] - zIm[0];
+        im[half] = 0.0f;
+        for (std::uint32_t k = 1; k < half; ++k)
+        {
+            const auto evenRe = 0.5f * (zRe[k] + zRe[half - k]);
+            const auto evenIm = 0.5f * (zIm[k] - zIm[half - k]);
+            const auto oddRe  = 0.5f * (zIm[k] + zIm[half - k]);
+            const auto oddIm  = -0.5f * (zRe[k] - zRe[half - k]);
+            re[k] = evenRe + oddRe * postRe[k] - oddIm * postIm[k];
+            im[k] = evenIm + oddRe * postIm[k] + oddIm * postRe[k];
+        }
+    }
+
+    void AudioFFT::inverse(const float* re, const float* im, float* output)
+    {
+        //merge back into a half size complex spectrum, in bit reversed order
+        const auto half = m_size / 2;
+        const auto* postRe = m_post.getChannel(0);
+        const auto* postIm = m_post.getChannel(1);
+        auto* zRe = m_work.getChannel(0);
+        auto* zIm = m_work.getChannel(1);
+        for (std::uint32_t k = 0; k < half; ++k)
+        {
+            const auto evenRe = 0.5f * (re[k] + re[half - k]);
+            const auto evenIm = 0.5f * (im[k] - im[half - k]);
+            const auto diffRe = 0.5f * (re[k] - re[half - k]);
+            const auto diffIm = 0.5f * (im[k] + im[half - k]);
+            const auto oddRe  = diffRe * postRe[k] + diffIm * postIm[k];
+            const auto oddIm  = diffIm * postRe[k] - diffRe * postIm[k];
+            zRe[m_bitReverse[k]] = evenRe - oddIm;
+            zIm[m_bitReverse[k]] = evenIm + oddRe;
+        }
+        transform(zIm, zRe);
+
+        const float scale = 1.0f / half;
+        for (std::uint32_t n = 0; n < half; ++n) {
+            output[2 * n]     = zRe[n] * scale;
+            output[2 * n + 1] = zIm[n] * scale;
+        }
+    }
+
+    void AudioFFT::transform(float* re, float* im) const
+    {
+        const auto half = m_size / 2;
+        const auto* twRe = m_twiddles.getChannel(0);
+        const auto* twIm = m_twiddles.getChannel(1);
+
+        for (std::uint32_t h = 1; h < half; h *= 2)
+        {
+            for (std::uint32_t start = 0; start < half; start += 2 * h)
+            {
+                auto* aRe = re + start;
+                auto* aIm = im + start;
+                auto* bRe = aRe + h;
+                auto* bIm = aIm + h;
+                std::uint32_t j = 0;
+#ifdef AUDIO_FFT_SSE2
+                //butterflies of stages with a half size of 4 and up are aligned quads
+                for (; h >= 4 && j < h; j += 4)
+                {
+                    const auto wRe = _mm_load_ps(twRe + h + j);
+                    const auto wIm = _mm_load_ps(twIm + h + j);
+                    const auto xRe = _mm_load_ps(bRe + j);
+                    const auto xIm = _mm_load_ps(bIm + j);
+                    const auto tRe = _mm_sub_ps(_mm_mul_ps(xRe, wRe), _mm_mul_ps(xIm, wIm));
+                    const auto tIm = _mm_add_ps(_mm_mul_ps(xRe, wIm), _mm_mul_ps(xIm, wRe));
+                    const auto yRe = _mm_load_ps(aRe + j);
+                    const auto yIm = _mm_load_ps(aIm + j);
+                    _mm_store_ps(bRe + j, _mm_sub_ps(yRe, tRe));
+                    _mm_store_ps(bIm + j, _mm_sub_ps(yIm, tIm));
+                    _mm_store_ps(aRe + j, _mm_add_ps(yRe, tRe));
+                    _mm_store_ps(aIm + j, _mm_add_ps(yIm, tIm));
+                }
+#endif
+                for (; j < h; ++j)
+                {
+                    const auto wRe = twRe[h + j];
+                    const auto wIm = twIm[h + j];
+                    const auto tRe = bRe[j] * wRe - bIm[j] * wIm;
+                    const auto tIm = bRe[j] * wIm + bIm[j] * wRe;
+                    bRe[j] = aRe[j] - tRe;
+                    bIm[j] = aIm[j] - tIm;
+                    aRe[j] += tRe;
+                    aIm[j] += tIm;
+                }
+            }
+        }
+    }
+
+    void ComplexMultiplyAccumulate(const float* aRe, const float* aIm, const float* bRe, const float* bIm,
+                                   float* yRe, float* yIm, std::uint32_t numBins)
+    {
+        std::uint32_t i = 0;
+#ifdef AUDIO_FFT_SSE2
+        for (; i < numBins; i += 4)
+        {
+            const auto ar = _mm_load_ps(aRe + i);
+            const auto ai = _mm_load_ps(aIm + i);
+            const auto br = _mm_load_ps(bRe + i);
+            const auto bi = _mm_load_ps(bIm + i);
+            _mm_store_ps(yRe + i, _mm_add_ps(_mm_load_ps(yRe + i), _mm_sub_ps(_mm_mul_ps(ar, br), _mm_mul_ps(ai, bi))));
+            _mm_store_ps(yIm + i, _mm_add_ps(_mm_load_ps(yIm + i), _mm_add_ps(_mm_mul_ps(ar, bi), _mm_mul_ps(ai, br))));
+        }
+#endif
+        for (; i < numBins; ++i)
+        {
+            yRe[i] += aRe[i] * bRe[i] - aIm[i] * bIm[i];
+            yIm[i] += aRe[i] * bIm[i] + aIm[i] * bRe[i];
+        }
+    }
+}
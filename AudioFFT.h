@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "AudioBus.h"
+
+namespace Audio
+{
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Real FFT of a power of two size, spectra are split into real
+    // and imaginary arrays of 'getNumBins()' entries so every bin wise
+    // operation runs as a plain vector loop. Arrays passed in must be 16
+    // byte aligned and padded to a multiple of 4, e.g. AudioBus channels.
+    // Not thread safe, every thread needs its own instance
+    //////////////////////////////////////////////////////////////////////////
+    class AudioFFT
+    {
+    public:
+        explicit AudioFFT( std::uint32_t size );
+
+        AudioFFT( const AudioFFT& ) = delete;
+        AudioFFT& operator = ( const AudioFFT& ) = delete;
+
+        std::uint32_t       getSize() const;
+
+        /*
+            @brief: size / 2 + 1, DC to nyquist
+        */
+        std::uint32_t       getNumBins() const;
+
+        void                forward( const float* input, float* re, float* im );
+
+        /*
+            @brief: Normalized, inverse( forward( x ) ) == x
+        */
+        void                inverse( const float* re, const float* im, float* output );
+
+    private:
+        /*
+            @brief: Complex FFT of half the size in place, input in bit
+            reversed order. Swapping 're' and 'im' gives the inverse
+        */
+        void                transform( float* re, float* im ) const;
+
+        std::uint32_t               m_size;
+        std::vector<std::uint32_t>  m_bitReverse;
+        AudioBus                    m_twiddles;     //re, im of every stage, stage of half size h starts at h
+        AudioBus                    m_post;         //re, im of the real split twiddles
+        AudioBus                    m_work;         //re, im
+    };
+
+    /*
+        @brief: y += a * b for 'numBins' complex bins in split form, rounded
+        up to a multiple of 4
+    */
+    void                    ComplexMultiplyAccumulate( const float* aRe, const float* aIm, const float* bRe, const float* bIm,
+                                                       float* yRe, float* yIm, std::uint32_t numBins );
+}
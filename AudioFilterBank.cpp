@@ -0,0 +1,321 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUDIO_FILTER_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "AudioException.h"
+#include "AudioFilterBank.h"
+
+namespace Audio
+{
+    namespace
+    {
+        constexpr float PI                  = 3.14159265358979f;
+        constexpr float FILTER_Q            = 0.70710678f;  //butterworth
+        constexpr float MIN_CUTOFF          = 250.0f;       //fully occluded
+        constexpr float MAX_CUTOFF          = 20000.0f;     //open, clamped below nyquist
+        constexpr float CUTOFF_SMOOTH_TIME  = 0.05f;        //seconds to move ~63% towards a new occlusion
+        constexpr float OPEN_THRESHOLD      = 0.999f;       //of the max cutoff, settled open
+        constexpr float DENORMAL_THRESHOLD  = 1e-15f;
+
+        constexpr std::uint32_t NO_LANE     = ~0u;
+
+#ifdef AUDIO_FILTER_SSE2
+        //one lane group in registers, deltas ramp the coefficients per frame
+        struct BiquadLanes
+        {
+            __m128  m_b0, m_b1, m_b2, m_a1, m_a2;
+            __m128  m_db0, m_db1, m_db2, m_da1, m_da2;
+            __m128  m_z1, m_z2;
+        };
+
+        template<typename Group>
+        void LoadBiquadLanes(const Group& group, float invFrames, BiquadLanes& lanes)
+        {
+            const auto scale = _mm_set1_ps(invFrames);
+            lanes.m_b0  = _mm_load_ps(group.m_coeffs[0]);
+            lanes.m_b1  = _mm_load_ps(group.m_coeffs[1]);
+            lanes.m_b2  = _mm_load_ps(group.m_coeffs[2]);
+            lanes.m_a1  = _mm_load_ps(group.m_coeffs[3]);
+            lanes.m_a2  = _mm_load_ps(group.m_coeffs[4]);
+            lanes.m_db0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(group.m_targets[0]), lanes.m_b0), scale);
+            lanes.m_db1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(group.m_targets[1]), lanes.m_b1), scale);
+            lanes.m_db2 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(group.m_targets[2]), lanes.m_b2), scale);
+            lanes.m_da1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(group.m_targets[3]), lanes.m_a1), scale);
+            lanes.m_da2 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(group.m_targets[4]), lanes.m_a2), scale);
+            lanes.m_z1  = _mm_load_ps(group.m_z1);
+            lanes.m_z2  = _mm_load_ps(group.m_z2);
+        }
+
+        inline __m128 StepBiquadLanes(BiquadLanes& lanes, __m128 x)
+        {
+            const auto y = _mm_add_ps(_mm_mul_ps(lanes.m_b0, x), lanes.m_z1);
+            lanes.m_z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(lanes.m_b1, x), _mm_mul_ps(lanes.m_a1, y)), lanes.m_z2);
+            lanes.m_z2 = _mm_sub_ps(_mm_mul_ps(lanes.m_b2, x), _mm_mul_ps(lanes.m_a2, y));
+            lanes.m_b0 = _mm_add_ps(lanes.m_b0, lanes.m_db0);
+            lanes.m_b1 = _mm_add_ps(lanes.m_b1, lanes.m_db1);
+            lanes.m_b2 = _mm_add_ps(lanes.m_b2, lanes.m_db2);
+            lanes.m_a1 = _mm_add_ps(lanes.m_a1, lanes.m_da1);
+            lanes.m_a2 = _mm_add_ps(lanes.m_a2, lanes.m_da2);
+            return y;
+        }
+
+        //4 frames of 4 lanes, transposed so a register holds one frame of every lane
+        inline void FilterBiquadQuad(BiquadLanes& lanes, float* const* samples, std::uint32_t i)
+        {
+            auto r0 = _mm_load_ps(samples[0] + i);
+            auto r1 = _mm_load_ps(samples[1] + i);
+            auto r2 = _mm_load_ps(samples[2] + i);
+            auto r3 = _mm_load_ps(samples[3] + i);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            r0 = StepBiquadLanes(lanes, r0);
+            r1 = StepBiquadLanes(lanes, r1);
+            r2 = StepBiquadLanes(lanes, r2);
+            r3 = StepBiquadLanes(lanes, r3);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_store_ps(samples[0] + i, r0);
+            _mm_store_ps(samples[1] + i, r1);
+            _mm_store_ps(samples[2] + i, r2);
+            _mm_store_ps(samples[3] + i, r3);
+        }
+#endif
+    }
+
+    AudioFilterBank::AudioFilterBank()
+        : m_numLanes( 0 )
+        , m_sampleRate( 0 )
+        , m_maxCutoff( MAX_CUTOFF )
+    {
+        memset(m_groups, 0, sizeof(m_groups));
+    }
+
+    void AudioFilterBank::initialize(std::uint32_t sampleRate, std::uint32_t maxFrames)
+    {
+        if (!sampleRate)
+            throw AudioException("Invalid Filter Sample Rate");
+
+        m_sampleRate = sampleRate;
+        m_maxCutoff  = std::min(MAX_CUTOFF, 0.45f * sampleRate);
+        m_numLanes   = 0;
+        m_lanes.resize(FILTER_BANK_LANES, maxFrames);
+    }
+
+    bool AudioFilterBank::isBypassed(AudioFilterState& state, float occlusion) const
+    {
+        if (occlusion > 0.0f)
+            return false;
+        if (state.m_cutoff != 0.0f && state.m_cutoff < m_maxCutoff * OPEN_THRESHOLD)
+            return false;
+
+        //open again, the next occlusion starts from a clean filter
+        state = AudioFilterState();
+        return true;
+    }
+
+    std::uint32_t AudioFilterBank::addVoice(AudioFilterState& state, float occlusion, std::uint32_t numChannels, const float* gains)
+    {
+        if (getNumFreeLanes() < numChannels)
+            return NO_LANE;
+
+        const auto first = m_numLanes;
+        for (std::uint32_t c = 0; c < numChannels; ++c)
+        {
+            auto& info = m_info[m_numLanes++];
+            info.m_state     = &state;
+            info.m_channel   = c;
+            info.m_gain      = gains[c];
+            info.m_occlusion = std::min(1.0f, std::max(0.0f, occlusion));
+        }
+        return first;
+    }
+
+    float* AudioFilterBank::getLane(std::uint32_t lane)
+    {
+        return m_lanes.getChannel(lane);
+    }
+
+    std::uint32_t AudioFilterBank::getNumFreeLanes() const
+    {
+        return FILTER_BANK_LANES - m_numLanes;
+    }
+
+    void AudioFilterBank::process(AudioBus& dest, std::uint32_t numFrames)
+    {
+        if (!numFrames)
+            m_numLanes = 0;
+        if (!m_numLanes)
+            return;
+        if (numFrames > m_lanes.getMaxFrames())
+            throw AudioException("Audio Bus Too Small");
+
+        //gather, the cutoff of a voice moves once per block
+        float targets[5] = {};
+        const auto smoothing = 1.0f - std::exp(-float(numFrames) / (CUTOFF_SMOOTH_TIME * m_sampleRate));
+        for (std::uint32_t lane = 0; lane < m_numLanes; ++lane)
+        {
+            const auto& info = m_info[lane];
+            auto& state = *info.m_state;
+            if (info.m_channel == 0)
+            {
+                if (state.m_cutoff == 0.0f) {
+                    state.m_cutoff = m_maxCutoff;
+                    getCoefficients(m_maxCutoff, state.m_coeffs);
+                }
+                const auto target = getTargetCutoff(info.m_occlusion);
+                state.m_cutoff = std::exp(std::log(state.m_cutoff) + (std::log(target) - std::log(state.m_cutoff)) * smoothing);
+                getCoefficients(state.m_cutoff, targets);
+            }
+
+            auto& group = m_groups[lane / FILTER_BANK_WIDTH];
+            const auto k = lane % FILTER_BANK_WIDTH;
+            for (int j = 0; j < 5; ++j) {
+                group.m_coeffs[j][k]  = state.m_coeffs[j];
+                group.m_targets[j][k] = targets[j];
+            }
+            group.m_z1[k] = state.m_z1[info.m_channel];
+            group.m_z2[k] = state.m_z2[info.m_channel];
+        }
+
+        //unused lanes of the last group run silent with a zero filter
+        const auto numGroups = (m_numLanes + FILTER_BANK_WIDTH - 1) / FILTER_BANK_WIDTH;
+        for (auto lane = m_numLanes; lane < numGroups * FILTER_BANK_WIDTH; ++lane)
+        {
+            auto& group = m_groups[lane / FILTER_BANK_WIDTH];
+            const auto k = lane % FILTER_BANK_WIDTH;
+            for (int j = 0; j < 5; ++j)
+                group.m_coeffs[j][k] = group.m_targets[j][k] = 0.0f;
+            group.m_z1[k] = group.m_z2[k] = 0.0f;
+            memset(m_lanes.getChannel(lane), 0, sizeof(float) * numFrames);
+        }
+
+        float* lanes[FILTER_BANK_LANES];
+        for (std::uint32_t lane = 0; lane < numGroups * FILTER_BANK_WIDTH; ++lane)
+            lanes[lane] = m_lanes.getChannel(lane);
+
+        //two groups at a time, a single one if odd
+        std::uint32_t g = 0;
+        for (; g + 2 <= numGroups; g += 2)
+            processGroups<2>(&m_groups[g], &lanes[g * FILTER_BANK_WIDTH], numFrames);
+        if (g < numGroups)
+            processGroups<1>(&m_groups[g], &lanes[g * FILTER_BANK_WIDTH], numFrames);
+
+        //scatter state & accumulate
+        for (std::uint32_t lane = 0; lane < m_numLanes; ++lane)
+        {
+            const auto& info  = m_info[lane];
+            auto&       state = *info.m_state;
+            const auto& group = m_groups[lane / FILTER_BANK_WIDTH];
+            const auto  k     = lane % FILTER_BANK_WIDTH;
+
+            if (info.m_channel == 0) {
+                for (int j = 0; j < 5; ++j)
+                    state.m_coeffs[j] = group.m_targets[j][k];
+            }
+            state.m_z1[info.m_channel] = std::abs(group.m_z1[k]) < DENORMAL_THRESHOLD ? 0.0f : group.m_z1[k];
+            state.m_z2[info.m_channel] = std::abs(group.m_z2[k]) < DENORMAL_THRESHOLD ? 0.0f : group.m_z2[k];
+
+            const auto* in  = m_lanes.getChannel(lane);
+            auto*       out = dest.getChannel(info.m_channel);
+            std::uint32_t i = 0;
+#ifdef AUDIO_FILTER_SSE2
+            //channels are padded to whole quads, no tail needed
+            const auto gain = _mm_set1_ps(info.m_gain);
+            for (; i < numFrames; i += 4)
+                _mm_store_ps(out + i, _mm_add_ps(_mm_load_ps(out + i), _mm_mul_ps(_mm_load_ps(in + i), gain)));
+#endif
+            for (; i < numFrames; ++i)
+                out[i] += in[i] * info.m_gain;
+        }
+        m_numLanes = 0;
+    }
+
+    template<std::uint32_t NUM_GROUPS>
+    void AudioFilterBank::processGroups(LaneGroup* groups, float* const* lanes, std::uint32_t numFrames)
+    {
+        //transposed direct form II, coefficients ramp linearly to their targets over the block
+        const float invFrames = 1.0f / float(numFrames);
+#ifdef AUDIO_FILTER_SSE2
+        //independent groups interleaved, hides the latency of the recursion
+        BiquadLanes state[NUM_GROUPS];
+        for (std::uint32_t g = 0; g < NUM_GROUPS; ++g)
+            LoadBiquadLanes(groups[g], invFrames, state[g]);
+
+        const auto numQuads = numFrames & ~3u;
+        for (std::uint32_t i = 0; i < numQuads; i += 4)
+        {
+            for (std::uint32_t g = 0; g < NUM_GROUPS; ++g)
+                FilterBiquadQuad(state[g], lanes + g * FILTER_BANK_WIDTH, i);
+        }
+
+        //padding frames must not advance the state
+        for (std::uint32_t i = numQuads; i < numFrames; ++i)
+        {
+            for (std::uint32_t g = 0; g < NUM_GROUPS; ++g)
+            {
+                auto* const* group = lanes + g * FILTER_BANK_WIDTH;
+                alignas(16) float y[4];
+                _mm_store_ps(y, StepBiquadLanes(state[g], _mm_setr_ps(group[0][i], group[1][i], group[2][i], group[3][i])));
+                for (std::uint32_t k = 0; k < FILTER_BANK_WIDTH; ++k)
+                    group[k][i] = y[k];
+            }
+        }
+
+        for (std::uint32_t g = 0; g < NUM_GROUPS; ++g) {
+            _mm_store_ps(groups[g].m_z1, state[g].m_z1);
+            _mm_store_ps(groups[g].m_z2, state[g].m_z2);
+        }
+#else
+        for (std::uint32_t lane = 0; lane < NUM_GROUPS * FILTER_BANK_WIDTH; ++lane)
+        {
+            auto& group = groups[lane / FILTER_BANK_WIDTH];
+            const auto k = lane % FILTER_BANK_WIDTH;
+            float coeffs[5], deltas[5];
+            for (int j = 0; j < 5; ++j) {
+                coeffs[j] = group.m_coeffs[j][k];
+                deltas[j] = (group.m_targets[j][k] - coeffs[j]) * invFrames;
+            }
+            auto z1 = group.m_z1[k];
+            auto z2 = group.m_z2[k];
+
+            auto* samples = lanes[lane];
+            for (std::uint32_t i = 0; i < numFrames; ++i)
+            {
+                const auto x = samples[i];
+                const auto y = coeffs[0] * x + z1;
+                z1 = coeffs[1] * x - coeffs[3] * y + z2;
+                z2 = coeffs[2] * x - coeffs[4] * y;
+                for (int j = 0; j < 5; ++j)
+                    coeffs[j] += deltas[j];
+                samples[i] = y;
+            }
+            group.m_z1[k] = z1;
+            group.m_z2[k] = z2;
+        }
+#endif
+    }
+
+    void AudioFilterBank::getCoefficients(float cutoff, float* coeffs) const
+    {
+        //RBJ low-pass
+        const auto w0    = 2.0f * PI * cutoff / float(m_sampleRate);
+        const auto cosW0 = std::cos(w0);
+        const auto alpha = std::sin(w0) / (2.0f * FILTER_Q);
+        const auto invA0 = 1.0f / (1.0f + alpha);
+
+        coeffs[0] = (1.0f - cosW0) * 0.5f * invA0;
+        coeffs[1] = (1.0f - cosW0) * invA0;
+        coeffs[2] = coeffs[0];
+        coeffs[3] = -2.0f * cosW0 * invA0;
+        coeffs[4] = (1.0f - alpha) * invA0;
+    }
+
+    float AudioFilterBank::getTargetCutoff(float occlusion) const
+    {
+        //exponential, so equal occlusion steps sound like equal steps
+        return m_maxCutoff * std::pow(MIN_CUTOFF / m_maxCutoff, occlusion);
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdint>
+
+#include "AudioBus.h"
+
+namespace Audio
+{
+    //voice channels filtered together, one per SIMD lane
+    constexpr std::uint32_t FILTER_BANK_WIDTH = 4;
+    //lanes batched before the bank runs, e.g. 8 stereo voices
+    constexpr std::uint32_t FILTER_BANK_LANES = 4 * FILTER_BANK_WIDTH;
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Per voice low-pass state, kept with the voice between blocks.
+    // A zero cutoff is a voice the bank hasn't seen yet
+    //////////////////////////////////////////////////////////////////////////
+    struct AudioFilterState
+    {
+        float           m_cutoff = 0.0f;            //smoothed, Hz
+        float           m_coeffs[5] = {};           //b0, b1, b2, a1, a2 at the end of the last block
+        float           m_z1[AUDIO_BUS_MAX_CHANNELS] = {};
+        float           m_z2[AUDIO_BUS_MAX_CHANNELS] = {};
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Occlusion low-pass for many voices at once. Voice channels are
+    // gathered into lanes and every group of FILTER_BANK_WIDTH lanes runs
+    // one vectorized biquad, coefficients and state in SoA layout. The
+    // cutoff follows the occlusion smoothly and coefficients ramp per sample,
+    // voices that are fully open bypass the bank
+    //////////////////////////////////////////////////////////////////////////
+    class AudioFilterBank
+    {
+    public:
+        AudioFilterBank();
+
+        AudioFilterBank( const AudioFilterBank& ) = delete;
+        AudioFilterBank& operator = ( const AudioFilterBank& ) = delete;
+
+        void                initialize( std::uint32_t sampleRate, std::uint32_t maxFrames = AUDIO_BUS_MAX_FRAMES );
+
+        /*
+            @brief: True if 'state' is settled fully open at 'occlusion', the
+            voice is mixed without filtering. Resets the state if so
+        */
+        bool                isBypassed( AudioFilterState& state, float occlusion ) const;
+
+        /*
+            @brief: Reserves 'numChannels' lanes for a voice, the caller writes
+            its channels to 'getLane( result + c )' before the next 'process'.
+            Returns ~0u if the lanes are taken, 'gains' are per channel
+        */
+        std::uint32_t       addVoice( AudioFilterState& state, float occlusion, std::uint32_t numChannels, const float* gains );
+        float*              getLane( std::uint32_t lane );
+        std::uint32_t       getNumFreeLanes() const;
+
+        /*
+            @brief: Filters 'numFrames' of every added voice, accumulates them
+            to 'dest' and writes their state back. Lanes are free afterwards
+        */
+        void                process( AudioBus& dest, std::uint32_t numFrames );
+
+    private:
+        struct alignas(16) LaneGroup
+        {
+            float           m_coeffs[5][FILTER_BANK_WIDTH];
+            float           m_targets[5][FILTER_BANK_WIDTH];
+            float           m_z1[FILTER_BANK_WIDTH];
+            float           m_z2[FILTER_BANK_WIDTH];
+        };
+
+        struct LaneInfo
+        {
+            AudioFilterState*   m_state;
+            std::uint32_t       m_channel;  //of the voice & output
+            float               m_gain;
+            float               m_occlusion;
+        };
+
+        /*
+            @brief: Runs NUM_GROUPS consecutive groups, 'lanes' holds their
+            FILTER_BANK_WIDTH lanes each
+        */
+        template<std::uint32_t NUM_GROUPS>
+        void                processGroups( LaneGroup* groups, float* const* lanes, std::uint32_t numFrames );
+        void                getCoefficients( float cutoff, float* coeffs ) const;
+        float               getTargetCutoff( float occlusion ) const;
+
+        AudioBus            m_lanes;
+        LaneGroup           m_groups[FILTER_BANK_LANES / FILTER_BANK_WIDTH];
+        LaneInfo            m_info[FILTER_BANK_LANES];
+        std::uint32_t       m_numLanes;
+        std::uint32_t       m_sampleRate;
+        float               m_maxCutoff;
+    };
+}
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cctype>
 #include "AudioHelper.h"
 
 namespace Audio
@@ -27,4 +29,19 @@ namespace Audio
         return numBytes / bps;
     }
 
+    eAudioType GetAudioType(const std::string& fileName)
+    {
+        const auto dot = fileName.find_last_of('.');
+        if (dot == std::string::npos)
+            return AUDIO_TYPE_NONE;
+
+        auto ext = fileName.substr(dot + 1);
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return char(std::tolower(static_cast<unsigned char>(c))); });
+        if (ext == "wav")
+            return AUDIO_TYPE_WAV;
+        if (ext == "ogg")
+            return AUDIO_TYPE_OGG;
+        return AUDIO_TYPE_NONE;
+    }
+
 }
\ No newline at end of file
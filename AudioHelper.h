@@ -1,4 +1,5 @@
 #pragma once
+#include <string>
 #include "AudioBuffer.h"
 #include "AudioConfig.h"
 
@@ -7,4 +8,5 @@ namespace Audio
 	float GetLength(std::uint32_t bufSize, std::uint32_t sampleRate, std::uint32_t bytesPerSample);
 	std::uint32_t GetBufferSize(std::uint32_t freq, std::uint32_t bytesPerSample, float time);
     std::uint32_t GetNumberOfSamples(std::uint32_t numBytes, const AudioConfig& format);
+    eAudioType GetAudioType(const std::string& fileName); //from the file extension
 }
\ No newline at end of file
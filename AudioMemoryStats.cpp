@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <unordered_map>
+
+#include <Common/Thread.h>
+
+#include "AudioMemoryStats.h"
+
+using namespace Common;
+
+namespace Audio
+{
+    namespace
+    {
+        struct CategoryCounters
+        {
+            std::atomic<std::uint64_t>  m_liveBytes{ 0 };
+            std::atomic<std::uint64_t>  m_peakBytes{ 0 };
+            std::atomic<std::uint64_t>  m_numAllocations{ 0 };
+            std::atomic<std::uint64_t>  m_budgetBytes{ 0 };
+        };
+
+        struct AssetCounters
+        {
+            std::uint64_t               m_liveBytes = 0;
+            std::uint64_t               m_peakBytes = 0;
+        };
+
+        //////////////////////////////////////////////////////////////////////////
+        //\Brief: Keeps a tracked buffer alive, the aliasing pointers handed out
+        // share its count so the bytes are freed with the last of them
+        //////////////////////////////////////////////////////////////////////////
+        struct TrackedBuffer
+        {
+            TrackedBuffer( const AudioBufferPtr& buffer, eAudioMemoryCategory category, const std::string& asset );
+            ~TrackedBuffer();
+
+            AudioBufferPtr              m_buffer;
+            eAudioMemoryCategory        m_category;
+            std::string                 m_asset;
+            std::size_t                 m_numBytes;
+        };
+
+        using TrackedBufferMap = std::unordered_map<const AudioBuffer*, std::pair<std::weak_ptr<AudioBuffer>, const TrackedBuffer*>>;
+
+        CategoryCounters    g_categories[AUDIO_MEMORY_CATEGORY_COUNT];
+
+        Mutex               g_assetMutex;
+        std::unordered_map<std::string, AssetCounters> g_assets;
+
+        Mutex               g_trackedMutex;
+        TrackedBufferMap    g_trackedBuffers;
+
+        const char*         CATEGORY_NAMES[AUDIO_MEMORY_CATEGORY_COUNT] = { "Asset", "Decoder", "Mixer", "Block" };
+
+        TrackedBuffer::TrackedBuffer(const AudioBufferPtr& buffer, eAudioMemoryCategory category, const std::string& asset)
+            : m_buffer( buffer )
+            , m_category( category )
+            , m_asset( asset )
+            , m_numBytes( buffer->capacity() )
+        {
+            TrackAudioAlloc(m_category, m_numBytes, m_asset.c_str());
+        }
+
+        TrackedBuffer::~TrackedBuffer()
+        {
+            TrackAudioFree(m_category, m_numBytes, m_asset.c_str());
+
+            //the buffer may have been tracked anew since the last alias expired
+            LockGuard lock(g_trackedMutex);
+            auto it = g_trackedBuffers.find(m_buffer.get());
+            if (it != std::end(g_trackedBuffers) && it->second.second == this)
+                g_trackedBuffers.erase(it);
+        }
+
+        std::string FormatBytes(std::uint64_t numBytes)
+        {
+            char result[32];
+            if (numBytes >= (1u << 20))
+                snprintf(result, sizeof(result), "%.2f MiB", static_cast<double>(numBytes) / (1u << 20));
+            else
+                snprintf(result, sizeof(result), "%.2f KiB", static_cast<double>(numBytes) / (1u << 10));
+            return result;
+        }
+    }
+
+    void TrackAudioAlloc(eAudioMemoryCategory category, std::size_t numBytes, const char* asset)
+    {
+        auto& counters = g_categories[category];
+        const auto live = counters.m_liveBytes.fetch_add(numBytes, std::memory_order_relaxed) + numBytes;
+        counters.m_numAllocations.fetch_add(1, std::memory_order_relaxed);
+
+        auto peak = counters.m_peakBytes.load(std::memory_order_relaxed);
+        while (live > peak && !counters.m_peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+            ;
+
+        if (!asset)
+            return;
+
+        LockGuard lock(g_assetMutex);
+        auto& assetCounters = g_assets[asset];
+        assetCounters.m_liveBytes += numBytes;
+        assetCounters.m_peakBytes = std::max(assetCounters.m_peakBytes, assetCounters.m_liveBytes);
+    }
+
+    void TrackAudioFree(eAudioMemoryCategory category, std::size_t numBytes, const char* asset)
+    {
+        auto& counters = g_categories[category];
+        counters.m_liveBytes.fetch_sub(numBytes, std::memory_order_relaxed);
+        counters.m_numAllocations.fetch_sub(1, std::memory_order_relaxed);
+
+        if (!asset)
+            return;
+
+        LockGuard lock(g_assetMutex);
+        auto it = g_assets.find(asset);
+        if (it != std::end(g_assets))
+            it->second.m_liveBytes -= std::min<std::uint64_t>(it->second.m_liveBytes, numBytes);
+    }
+
+    AudioBufferPtr TrackAudioBuffer(const AudioBufferPtr& buffer, eAudioMemoryCategory category, const std::string& asset)
+    {
+        if (!buffer)
+            return buffer;
+
+        LockGuard lock(g_trackedMutex);
+        auto& entry = g_trackedBuffers[buffer.get()];
+        if (auto tracked = entry.first.lock())
+            return tracked;
+
+        auto holder = std::make_shared<TrackedBuffer>(buffer, category, asset);
+        AudioBufferPtr result(holder, buffer.get());
+        entry.first  = result;
+        entry.second = holder.get();
+        return result;
+    }
+
+    AudioMemoryUsage GetAudioMemoryUsage(eAudioMemoryCategory category)
+    {
+        const auto& counters = g_categories[category];
+        AudioMemoryUsage result;
+        result.m_liveBytes      = counters.m_liveBytes.load(std::memory_order_relaxed);
+        result.m_peakBytes      = counters.m_peakBytes.load(std::memory_order_relaxed);
+        result.m_numAllocations = counters.m_numAllocations.load(std::memory_order_relaxed);
+        result.m_budgetBytes    = counters.m_budgetBytes.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    std::vector<AudioAssetMemoryUsage> GetAudioAssetMemoryUsage()
+    {
+        std::vector<AudioAssetMemoryUsage> result;
+        {
+            LockGuard lock(g_assetMutex);
+            result.reserve(g_assets.size());
+            for (const auto& iter : g_assets)
+            {
+                AudioAssetMemoryUsage usage;
+                usage.m_name      = iter.first;
+                usage.m_liveBytes = iter.second.m_liveBytes;
+                usage.m_peakBytes = iter.second.m_peakBytes;
+                result.push_back(std::move(usage));
+            }
+        }
+
+        std::sort(std::begin(result), std::end(result), [](const AudioAssetMemoryUsage& lhs, const AudioAssetMemoryUsage& rhs) {
+            return lhs.m_liveBytes != rhs.m_liveBytes ? lhs.m_liveBytes > rhs.m_liveBytes : lhs.m_peakBytes > rhs.m_peakBytes;
+        });
+        return result;
+    }
+
+    void SetAudioMemoryBudget(eAudioMemoryCategory category, std::uint64_t numBytes)
+    {
+        g_categories[category].m_budgetBytes.store(numBytes, std::memory_order_relaxed);
+    }
+
+    const char* GetAudioMemoryCategoryName(eAudioMemoryCategory category)
+    {
+        return category < AUDIO_MEMORY_CATEGORY_COUNT ? CATEGORY_NAMES[category] : "Unknown";
+    }
+
+    std::string GetAudioMemoryReport(std::uint32_t maxAssets)
+    {
+        std::string result = "Audio Memory\n";
+        for (std::uint32_t i = 0; i < AUDIO_MEMORY_CATEGORY_COUNT; ++i)
+        {
+            const auto category = static_cast<eAudioMemoryCategory>(i);
+            const auto usage = GetAudioMemoryUsage(category);
+            result += std::string("  ") + GetAudioMemoryCategoryName(category) + ": " + FormatBytes(usage.m_liveBytes) +
+                " live, " + FormatBytes(usage.m_peakBytes) + " peak, " + std::to_string(usage.m_numAllocations) + " allocations";
+            if (usage.m_budgetBytes) {
+                result += ", budget " + FormatBytes(usage.m_budgetBytes);
+                if (usage.m_peakBytes > usage.m_budgetBytes)
+                    result += " EXCEEDED";
+            }
+            result += "\n";
+        }
+
+        const auto assets = GetAudioAssetMemoryUsage();
+        const auto numAssets = std::min<std::size_t>(assets.size(), maxAssets);
+        if (numAssets)
+            result += "Assets( " + std::to_string(numAssets) + " of " + std::to_string(assets.size()) + " )\n";
+        for (std::size_t i = 0; i < numAssets; ++i)
+            result += "  " + assets[i].m_name + ": " + FormatBytes(assets[i].m_liveBytes) + " live, " + FormatBytes(assets[i].m_peakBytes) + " peak\n";
+        return result;
+    }
+}
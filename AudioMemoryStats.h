@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "AudioBuffer.h"
+
+namespace Audio
+{
+    enum eAudioMemoryCategory : std::uint32_t
+    {
+        AUDIO_MEMORY_ASSET = 0,     //sample data & mapped sound banks
+        AUDIO_MEMORY_DECODER,       //vorbis setups, decoder arenas & heap decoders
+        AUDIO_MEMORY_MIXER,         //mix buses
+        AUDIO_MEMORY_BLOCK,         //AudioBlock storage, rings & stack temporaries included
+        AUDIO_MEMORY_CATEGORY_COUNT
+    };
+
+    struct AudioMemoryUsage
+    {
+        std::uint64_t   m_liveBytes      = 0;
+        std::uint64_t   m_peakBytes      = 0;
+        std::uint64_t   m_numAllocations = 0; //live
+        std::uint64_t   m_budgetBytes    = 0; //0 if none
+    };
+
+    struct AudioAssetMemoryUsage
+    {
+        std::string     m_name;
+        std::uint64_t   m_liveBytes      = 0;
+        std::uint64_t   m_peakBytes      = 0;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Allocation accounting, category totals are lock free and safe
+    // on the audio thread. Bytes attributed to an asset take a lock, assets
+    // keep their peak after being unloaded
+    //////////////////////////////////////////////////////////////////////////
+    void                    TrackAudioAlloc( eAudioMemoryCategory category, std::size_t numBytes, const char* asset = nullptr );
+    void                    TrackAudioFree( eAudioMemoryCategory category, std::size_t numBytes, const char* asset = nullptr );
+
+    /*
+        @brief: Returns 'buffer' accounted to 'asset' until its last reference
+        is gone. A buffer is tracked once, the first name sticks
+    */
+    AudioBufferPtr          TrackAudioBuffer( const AudioBufferPtr& buffer, eAudioMemoryCategory category, const std::string& asset );
+
+    AudioMemoryUsage        GetAudioMemoryUsage( eAudioMemoryCategory category );
+
+    /*
+        @brief: Largest live usage first
+    */
+    std::vector<AudioAssetMemoryUsage>  GetAudioAssetMemoryUsage();
+
+    void                    SetAudioMemoryBudget( eAudioMemoryCategory category, std::uint64_t numBytes );
+    const char*             GetAudioMemoryCategoryName( eAudioMemoryCategory category );
+
+    /*
+        @brief: Every category and the 'maxAssets' largest assets, one per line.
+        Categories over budget are flagged
+    */
+    std::string             GetAudioMemoryReport( std::uint32_t maxAssets = 32 );
+}
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <IO/FileInputStream.h>
+#include "AudioHelper.h"
+#include "AudioMetadata.h"
+#include "WavFile.h"
+
+using namespace IO;
+
+namespace Audio
+{
+    namespace
+    {
+        constexpr std::size_t   OGG_PAGE_HEADER_SIZE = 27;
+        constexpr std::size_t   OGG_MAX_PAGE_SIZE    = OGG_PAGE_HEADER_SIZE + 255 + 255 * 255;
+        constexpr std::uint64_t OGG_NO_GRANULE       = ~std::uint64_t(0);
+        //packet type, "vorbis", version, channels, rate
+        constexpr std::size_t   VORBIS_ID_HEADER_SIZE = 1 + 6 + 4 + 1 + 4;
+
+        template<typename T>
+        T ReadLE(const std::uint8_t* data)
+        {
+            T result = 0;
+            for (int i = int(sizeof(T)) - 1; i >= 0; --i)
+                result = T(result << 8) | data[i];
+            return result;
+        }
+
+        bool ReadAt(FileInputStream& file, std::uint64_t offset, std::vector<std::uint8_t>& dest)
+        {
+            file.seek(static_cast<std::size_t>(offset));
+            return file.readData(dest.data(), dest.size()) == dest.size();
+        }
+
+        //size of the page at 'pos' including its body, 0 if it does not fit
+        std::size_t GetPageSize(const std::uint8_t* data, std::size_t pos, std::size_t size)
+        {
+            if (pos + OGG_PAGE_HEADER_SIZE > size || memcmp(&data[pos], "OggS", 4) != 0 || data[pos + 4] != 0)
+                return 0;
+
+            const std::size_t numSegments = data[pos + 26];
+            const std::size_t headerSize  = OGG_PAGE_HEADER_SIZE + numSegments;
+            if (pos + headerSize > size)
+                return 0;
+
+            std::size_t bodySize = 0;
+            for (std::size_t i = 0; i < numSegments; ++i)
+                bodySize += data[pos + OGG_PAGE_HEADER_SIZE + i];
+            return pos + headerSize + bodySize <= size ? headerSize + bodySize : 0;
+        }
+    }
+
+    float AudioMetadata::getLength() const
+    {
+        return m_sampleRate ? float(m_numSamples) / float(m_sampleRate) : 0.0f;
+    }
+
+    bool ProbeOgg(const std::string& fileName, AudioMetadata& metadata)
+    {
+        FileInputStream file(fileName);
+        if (!file.isOpen())
+            return false;
+
+        const auto fileSize = static_cast<std::uint64_t>(file.getFileSize());
+
+        //the identification header is the only packet of the first page
+        std::vector<std::uint8_t> head(static_cast<std::size_t>(std::min<std::uint64_t>(fileSize, OGG_PAGE_HEADER_SIZE + 255 + VORBIS_ID_HEADER_SIZE)));
+        if (head.size() < OGG_PAGE_HEADER_SIZE || !ReadAt(file, 0, head) || memcmp(head.data(), "OggS", 4) != 0)
+            return false;
+
+        const auto serial    = ReadLE<std::uint32_t>(&head[14]);
+        const auto packetPos = OGG_PAGE_HEADER_SIZE + head[26];
+        if (packetPos + VORBIS_ID_HEADER_SIZE > head.size())
+            return false;
+
+        const auto* packet = &head[packetPos];
+        if (packet[0] != 1 || memcmp(&packet[1], "vorbis", 6) != 0 || ReadLE<std::uint32_t>(&packet[7]) != 0)
+            return false;
+
+        const auto channels   = std::uint32_t(packet[11]);
+        const auto sampleRate = ReadLE<std::uint32_t>(&packet[12]);
+        if (!channels || !sampleRate)
+            return false;
+
+        //the last page of the stream lies within the last max page size bytes
+        const auto tailSize = static_cast<std::size_t>(std::min<std::uint64_t>(fileSize, OGG_MAX_PAGE_SIZE));
+        std::vector<std::uint8_t> tail(tailSize);
+        if (!ReadAt(file, fileSize - tailSize, tail))
+            return false;
+
+        std::uint64_t granule = OGG_NO_GRANULE;
+        for (std::size_t pos = tailSize - std::min(tailSize, OGG_PAGE_HEADER_SIZE) + 1; pos-- > 0; )
+        {
+            if (tail[pos] != 'O' || !GetPageSize(tail.data(), pos, tailSize))
+                continue;
+            if (ReadLE<std::uint32_t>(&tail[pos + 14]) != serial)
+                continue;
+
+            const auto pageGranule = ReadLE<std::uint64_t>(&tail[pos + 6]);
+            if (pageGranule != OGG_NO_GRANULE) {
+                granule = pageGranule;
+                break;
+            }
+        }
+        if (granule == OGG_NO_GRANULE || granule > 0xffffffffu)
+            return false;
+
+        metadata.m_type       = AUDIO_TYPE_OGG;
+        metadata.m_format     = audio_format_s16;
+        metadata.m_channels   = channels;
+        metadata.m_sampleRate = sampleRate;
+        metadata.m_numSamples = static_cast<std::uint32_t>(granule);
+        return true;
+    }
+
+    bool ProbeWav(const std::string& fileName, AudioMetadata& metadata)
+    {
+        FileInputStream file(fileName);
+        if (!file.isOpen())
+            return false;
+
+        bool succeed = false;
+        WavFile wav;
+        wav.m_header = file.read<WaveHeader>(&succeed);
+        if (!succeed)
+            return false;
+
+        const auto& header = wav.m_header;
+        if (memcmp("RIFF", header.m_riffText, 4) != 0 || memcmp("WAVE", header.m_waveText, 4) != 0)
+            return false;
+
+        metadata.m_type       = AUDIO_TYPE_WAV;
+        metadata.m_format     = wav.getSampleFormat();
+        metadata.m_channels   = header.m_channels;
+        metadata.m_sampleRate = header.m_frequency;
+        metadata.m_numSamples = header.m_blockAlign ? header.m_dataLength / header.m_blockAlign : 0;
+        return metadata.m_format != audio_format_unknown && metadata.m_channels;
+    }
+
+    bool ProbeAudioFile(const std::string& fileName, AudioMetadata& metadata)
+    {
+        switch (GetAudioType(fileName))
+        {
+        case AUDIO_TYPE_WAV: return ProbeWav(fileName, metadata);
+        case AUDIO_TYPE_OGG: return ProbeOgg(fileName, metadata);
+        default:             return false;
+        }
+    }
+}
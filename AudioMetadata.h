@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include "AudioConfig.h"
+
+namespace Audio
+{
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: What is known about an asset without loading or decoding it
+    //////////////////////////////////////////////////////////////////////////
+    struct AudioMetadata
+    {
+        float               getLength() const;
+
+        eAudioType          m_type       = AUDIO_TYPE_NONE;
+        std::uint32_t       m_format     = audio_format_unknown; //of the decoded samples
+        std::uint32_t       m_channels   = 0;
+        std::uint32_t       m_sampleRate = 0;
+        std::uint32_t       m_numSamples = 0; //per channel
+    };
+
+    /*
+        @brief: Reads the Vorbis identification header from the first page and
+        the length from the granule position of the last page, no decoder is
+        created and the rest of the file is never read
+    */
+    bool                ProbeOgg( const std::string& fileName, AudioMetadata& metadata );
+
+    /*
+        @brief: Reads the wave header only
+    */
+    bool                ProbeWav( const std::string& fileName, AudioMetadata& metadata );
+
+    /*
+        @brief: Probes by file extension, false for unknown types
+    */
+    bool                ProbeAudioFile( const std::string& fileName, AudioMetadata& metadata );
+}
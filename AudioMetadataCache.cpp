@@ -0,0 +1,152 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include <IO/FileInputStream.h>
+#include <IO/FileSystem.h>
+#include "AudioMetadataCache.h"
+
+using namespace Common;
+using namespace IO;
+
+namespace Audio
+{
+    namespace
+    {
+        constexpr std::uint32_t METADATA_CACHE_VERSION = 1;
+        constexpr std::uint32_t MAX_PATH_LENGTH        = 4096;
+
+        bool GetFileStamp(const std::string& fileName, std::uint64_t& fileSize, std::int64_t& writeTime)
+        {
+            fileSize = FileSystem::GetFileSize(fileName);
+            if (!fileSize)
+                return false;
+
+            //the IO layer has no timestamps
+            std::error_code error;
+            const auto time = std::filesystem::last_write_time(fileName, error);
+            if (error)
+                return false;
+
+            writeTime = static_cast<std::int64_t>(time.time_since_epoch().count());
+            return true;
+        }
+
+        template<typename T>
+        bool Read(FileInputStream& file, T& value)
+        {
+            bool succeed = false;
+            value = file.read<T>(&succeed);
+            return succeed;
+        }
+
+        template<typename T>
+        void Write(std::ofstream& file, const T& value)
+        {
+            file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+    }
+
+    bool AudioMetadataCache::load(const std::string& cacheFile)
+    {
+        FileInputStream file(cacheFile);
+        if (!file.isOpen())
+            return false;
+
+        std::uint32_t magic, version, numEntries;
+        if (!Read(file, magic) || memcmp(&magic, "AMDC", 4) != 0 ||
+            !Read(file, version) || version != METADATA_CACHE_VERSION ||
+            !Read(file, numEntries))
+            return false;
+
+        std::unordered_map<std::string, Entry> entries;
+        entries.reserve(numEntries);
+        for (std::uint32_t i = 0; i < numEntries; ++i)
+        {
+            std::uint32_t length;
+            if (!Read(file, length) || length > MAX_PATH_LENGTH)
+                return false;
+
+            std::string path(length, '\0');
+            if (length && file.readData(&path[0], length) != length)
+                return false;
+
+            Entry entry;
+            if (!Read(file, entry.m_fileSize) || !Read(file, entry.m_writeTime) ||
+                !Read(file, entry.m_metadata))
+                return false;
+
+            entries.emplace(std::move(path), entry);
+        }
+
+        LockGuard lock(m_mutex);
+        //entries probed before the load are newer
+        for (auto& entry : m_entries)
+            entries[entry.first] = entry.second;
+        m_entries.swap(entries);
+        return true;
+    }
+
+    bool AudioMetadataCache::save(const std::string& cacheFile) const
+    {
+        std::ofstream file(cacheFile, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+
+        LockGuard lock(m_mutex);
+        file.write("AMDC", 4);
+        Write(file, METADATA_CACHE_VERSION);
+        Write(file, static_cast<std::uint32_t>(m_entries.size()));
+        for (const auto& entry : m_entries)
+        {
+            Write(file, static_cast<std::uint32_t>(entry.first.size()));
+            file.write(entry.first.data(), static_cast<std::streamsize>(entry.first.size()));
+            Write(file, entry.second.m_fileSize);
+            Write(file, entry.second.m_writeTime);
+            Write(file, entry.second.m_metadata);
+        }
+
+        if (!file.flush())
+            return false;
+        m_dirty = false;
+        return true;
+    }
+
+    bool AudioMetadataCache::getMetadata(const std::string& fileName, AudioMetadata& metadata)
+    {
+        Entry entry;
+        if (!GetFileStamp(fileName, entry.m_fileSize, entry.m_writeTime))
+            return false;
+
+        {
+            LockGuard lock(m_mutex);
+            auto it = m_entries.find(fileName);
+            if (it != std::end(m_entries) && it->second.m_fileSize == entry.m_fileSize && it->second.m_writeTime == entry.m_writeTime) {
+                metadata = it->second.m_metadata;
+                return true;
+            }
+        }
+
+        //probe without holding the lock, other threads keep resolving cached entries
+        if (!ProbeAudioFile(fileName, entry.m_metadata))
+            return false;
+
+        LockGuard lock(m_mutex);
+        m_entries[fileName] = entry;
+        m_dirty = true;
+        metadata = entry.m_metadata;
+        return true;
+    }
+
+    bool AudioMetadataCache::isDirty() const
+    {
+        LockGuard lock(m_mutex);
+        return m_dirty;
+    }
+
+    std::uint32_t AudioMetadataCache::getNumEntries() const
+    {
+        LockGuard lock(m_mutex);
+        return static_cast<std::uint32_t>(m_entries.size());
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include <Common/Thread.h>
+
+#include "AudioMetadata.h"
+
+namespace Audio
+{
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Persistent path -> metadata map, entries are keyed by file size
+    // and modification time and reprobed only when either changed. Safe to
+    // query from several loader threads
+    //////////////////////////////////////////////////////////////////////////
+    class AudioMetadataCache
+    {
+    public:
+        AudioMetadataCache() = default;
+
+        AudioMetadataCache(const AudioMetadataCache&) = delete;
+        AudioMetadataCache& operator=(const AudioMetadataCache&) = delete;
+
+        /*
+            @brief: Loads a cache written by 'save', false if the file is missing
+            or was written by another version
+        */
+        bool                load( const std::string& cacheFile );
+        bool                save( const std::string& cacheFile ) const;
+
+        /*
+            @brief: Returns the cached metadata of 'fileName', probes the file if
+            it is not cached or changed since
+        */
+        bool                getMetadata( const std::string& fileName, AudioMetadata& metadata );
+
+        bool                isDirty() const;
+        std::uint32_t       getNumEntries() const;
+
+    private:
+        struct Entry
+        {
+            std::uint64_t       m_fileSize;
+            std::int64_t        m_writeTime;
+            AudioMetadata       m_metadata;
+        };
+
+        mutable Common::Mutex                       m_mutex;
+        std::unordered_map<std::string, Entry>      m_entries;
+        mutable bool                                m_dirty = false; //entries changed since the last load or save
+    };
+}
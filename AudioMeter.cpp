@@ -0,0 +1,552 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUDIO_METER_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "AudioException.h"
+#include "AudioMeter.h"
+
+using namespace Common;
+
+namespace Audio
+{
+    namespace
+    {
+        constexpr double        PI                   = 3.141592653589793;
+        constexpr float         METER_BLOCK_LENGTH   = 0.1f;    //seconds per reading
+        constexpr std::uint32_t MOMENTARY_BLOCKS     = 4;       //400 ms
+        constexpr std::uint32_t SHORT_TERM_BLOCKS    = 30;      //3 s
+        constexpr std::uint32_t SPECTRUM_SIZE        = 8192;    //~5.9 Hz per bin at 48 kHz
+        constexpr std::uint32_t TRUE_PEAK_TAPS       = 12;      //per phase of the 4x interpolator
+        constexpr float         SURROUND_WEIGHT      = 1.41f;   //+1.5 dB, BS.1770
+        constexpr float         METER_POLL_INTERVAL  = 0.025f;  //seconds
+
+        static_assert(sizeof(AudioMeterReading) % sizeof(std::uint32_t) == 0, "Meter reading must be a whole number of words");
+
+        /*
+            @brief: K-weighting of BS.1770 at any rate, a high shelf modelling
+            the head followed by the RLB high-pass. Per stage b0, b1, b2, a1, a2
+        */
+        void GetKWeighting(std::uint32_t sampleRate, double coeffs[2][5])
+        {
+            const auto shelfK = std::tan(PI * 1681.974450955533 / sampleRate);
+            const auto shelfQ = 0.7071752369554196;
+            const auto vh     = std::pow(10.0, 3.999843853973347 / 20.0);
+            const auto vb     = std::pow(vh, 0.4996667741545416);
+            const auto shelfA = 1.0 + shelfK / shelfQ + shelfK * shelfK;
+            coeffs[0][0] = (vh + vb * shelfK / shelfQ + shelfK * shelfK) / shelfA;
+            coeffs[0][1] = 2.0 * (shelfK * shelfK - vh) / shelfA;
+            coeffs[0][2] = (vh - vb * shelfK / shelfQ + shelfK * shelfK) / shelfA;
+            coeffs[0][3] = 2.0 * (shelfK * shelfK - 1.0) / shelfA;
+            coeffs[0][4] = (1.0 - shelfK / shelfQ + shelfK * shelfK) / shelfA;
+
+            const auto passK = std::tan(PI * 38.13547087602444 / sampleRate);
+            const auto passQ = 0.5003270373238773;
+            const auto passA = 1.0 + passK / passQ + passK * passK;
+            coeffs[1][0] = 1.0;
+            coeffs[1][1] = -2.0;
+            coeffs[1][2] = 1.0;
+            coeffs[1][3] = 2.0 * (passK * passK - 1.0) / passA;
+            coeffs[1][4] = (1.0 - passK / passQ + passK * passK) / passA;
+        }
+
+        /*
+            @brief: Channel weights of BS.1770 for the common layouts, the LFE
+            doesn't count and surround channels count 1.5 dB more
+        */
+        void GetChannelWeights(std::uint32_t numChannels, float* weights)
+        {
+            std::fill(weights, weights + AUDIO_BUS_MAX_CHANNELS, 0.0f);
+            std::fill(weights, weights + numChannels, 1.0f);
+            if (numChannels == 4 || numChannels == 5) {
+                weights[numChannels - 2] = SURROUND_WEIGHT;
+                weights[numChannels - 1] = SURROUND_WEIGHT;
+            }
+            else if (numChannels >= 6) {
+                weights[3] = 0.0f;
+                std::fill(weights + 4, weights + numChannels, SURROUND_WEIGHT);
+            }
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        //\Brief: 4x oversampling interpolator of the true peak, Hann windowed
+        // sinc split into 4 phases of TRUE_PEAK_TAPS taps. Phase 0 passes the
+        // sample itself, every tap holds the coefficients of all phases
+        //////////////////////////////////////////////////////////////////////////
+        struct TruePeakFilter
+        {
+            TruePeakFilter()
+            {
+                const auto center = TRUE_PEAK_TAPS * 2.0;
+                for (std::uint32_t phase = 0; phase < 4; ++phase)
+                {
+                    double sum = 0.0;
+                    for (std::uint32_t tap = 0; tap < TRUE_PEAK_TAPS; ++tap)
+                    {
+                        const auto t = (4.0 * tap + phase - center) / 4.0;
+                        const auto sinc = t == 0.0 ? 1.0 : std::sin(PI * t) / (PI * t);
+                        const auto window = 0.5 + 0.5 * std::cos(PI * t / (TRUE_PEAK_TAPS / 2.0 + 0.25));
+                        m_coeffs[tap][phase] = static_cast<float>(sinc * window);
+                        sum += sinc * window;
+                    }
+                    for (std::uint32_t tap = 0; tap < TRUE_PEAK_TAPS; ++tap)
+                        m_coeffs[tap][phase] = static_cast<float>(m_coeffs[tap][phase] / sum);
+                }
+            }
+
+            alignas(16) float   m_coeffs[TRUE_PEAK_TAPS][4];
+        };
+
+        const TruePeakFilter& GetTruePeakFilter()
+        {
+            static const TruePeakFilter filter;
+            return filter;
+        }
+
+        float ToDecibels(double power)
+        {
+            return power > 0.0 ? std::max(static_cast<float>(10.0 * std::log10(power)), METER_FLOOR) : METER_FLOOR;
+        }
+
+        float ToLoudness(double power)
+        {
+            return power > 0.0 ? std::max(static_cast<float>(-0.691 + 10.0 * std::log10(power)), METER_FLOOR) : METER_FLOOR;
+        }
+
+#ifdef AUDIO_METER_SSE2
+        /*
+            @brief: Transposed direct form II, 'c' holds b0, b1, b2, a1, a2
+        */
+        inline __m128 Biquad(__m128 x, const float (*c)[4], __m128& z1, __m128& z2)
+        {
+            const auto y = _mm_add_ps(_mm_mul_ps(_mm_load_ps(c[0]), x), z1);
+            z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_load_ps(c[1]), x), _mm_mul_ps(_mm_load_ps(c[3]), y)), z2);
+            z2 = _mm_sub_ps(_mm_mul_ps(_mm_load_ps(c[2]), x), _mm_mul_ps(_mm_load_ps(c[4]), y));
+            return y;
+        }
+#endif
+    }
+
+    AudioMeterReading::AudioMeterReading()
+        : m_numFrames( 0 )
+        , m_numChannels( 0 )
+        , m_momentary( METER_FLOOR )
+        , m_shortTerm( METER_FLOOR )
+        , m_maxTruePeak( METER_FLOOR )
+    {
+        std::fill(std::begin(m_truePeak), std::end(m_truePeak), METER_FLOOR);
+        std::fill(std::begin(m_spectrum), std::end(m_spectrum), METER_FLOOR);
+    }
+
+    float GetMeterBandFrequency(std::uint32_t band)
+    {
+        //1 kHz is band 17
+        return 1000.0f * std::pow(2.0f, (static_cast<float>(band) - 17.0f) / 3.0f);
+    }
+
+    AudioMeter::AudioMeter(const AudioConfig& format)
+        : m_format( format )
+        , m_numChannels( format.getNumChannels() )
+        , m_numQuads( (format.getNumChannels() + 3) / 4 )
+        , m_frameSize( format.getBytesPerSample() )
+        , m_sampleRate( format.getSampleRate() )
+        , m_blockFrames( 0 )
+        , m_blockPos( 0 )
+        , m_numFrames( 0 )
+        , m_powerPos( 0 )
+        , m_maxPeak( 0.0f )
+        , m_spectrumPos( 0 )
+        , m_spectrumScale( 0.0f )
+        , m_numDroppedFrames( 0 )
+        , m_sequence( 0 )
+        , m_running( false )
+    {
+        if (format.m_format != audio_format_f32 || !m_numChannels || m_numChannels > AUDIO_BUS_MAX_CHANNELS || !m_sampleRate)
+            throw AudioException("Meter Needs A FP32 Output Format");
+
+        m_blockFrames = std::max(static_cast<std::uint32_t>(m_sampleRate * METER_BLOCK_LENGTH + 0.5f), 1u);
+        m_scratch.resize(AUDIO_BUS_MAX_FRAMES * m_numChannels);
+        m_input.resize(m_numQuads * 4);
+
+        //loudness
+        double kWeighting[2][5];
+        GetKWeighting(m_sampleRate, kWeighting);
+        GetChannelWeights(m_numChannels, m_weights);
+        m_kWeighting.resize(m_numQuads);
+        for (auto& quad : m_kWeighting)
+        {
+            for (std::uint32_t stage = 0; stage < 2; ++stage)
+                for (std::uint32_t i = 0; i < 5; ++i)
+                    std::fill(std::begin(quad.m_coeffs[stage][i]), std::end(quad.m_coeffs[stage][i]), static_cast<float>(kWeighting[stage][i]));
+            memset(quad.m_z1, 0, sizeof(quad.m_z1));
+            memset(quad.m_z2, 0, sizeof(quad.m_z2));
+        }
+        std::fill(std::begin(m_blockPower), std::end(m_blockPower), 0.0);
+        m_powers.assign(SHORT_TERM_BLOCKS, 0.0);
+
+        //true peak
+        m_peakHistory.resize(m_numChannels, TRUE_PEAK_TAPS - 1 + AUDIO_BUS_MAX_FRAMES);
+        std::fill(std::begin(m_peaks), std::end(m_peaks), 0.0f);
+
+        //spectrum, bands without a bin of their own take the nearest one
+        m_fft = std::make_unique<AudioFFT>(SPECTRUM_SIZE);
+        m_spectrumHistory.resize(3, SPECTRUM_SIZE);
+        m_spectrum.resize(3, m_fft->getNumBins());
+        auto* window = m_spectrumHistory.getChannel(2);
+        for (std::uint32_t i = 0; i < SPECTRUM_SIZE; ++i)
+            window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * PI * i / SPECTRUM_SIZE));
+        m_spectrumScale = 32.0f / (3.0f * SPECTRUM_SIZE * SPECTRUM_SIZE);
+
+        const auto binsPerHz = static_cast<float>(SPECTRUM_SIZE) / m_sampleRate;
+        const auto numBins = m_fft->getNumBins() - 1; //nyquist excluded
+        for (std::uint32_t band = 0; band < METER_NUM_BANDS; ++band)
+        {
+            const auto center = GetMeterBandFrequency(band);
+            auto first = static_cast<std::uint32_t>(std::ceil(center * binsPerHz / std::pow(2.0f, 1.0f / 6.0f)));
+            auto end   = static_cast<std::uint32_t>(std::ceil(center * binsPerHz * std::pow(2.0f, 1.0f / 6.0f)));
+            if (first >= end) {
+                first = static_cast<std::uint32_t>(center * binsPerHz + 0.5f);
+                end   = first + 1;
+            }
+            m_bandBins[band][0] = std::min(std::max(first, 1u), numBins);
+            m_bandBins[band][1] = std::min(end, numBins);
+        }
+
+        AudioMeterReading reading;
+        reading.m_numChannels = m_numChannels;
+        publish(reading);
+    }
+
+    AudioMeter::~AudioMeter()
+    {
+        stop();
+    }
+
+    void AudioMeter::start()
+    {
+        if (m_running)
+            return;
+        m_running = true;
+        m_thread = std::thread(&AudioMeter::meterLoop, this);
+    }
+
+    void AudioMeter::stop()
+    {
+        {
+            std::unique_lock<Mutex> lock(m_wakeMutex);
+            m_running = false;
+        }
+        m_wake.notify_all();
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+
+    void AudioMeter::push(const void* data, std::uint32_t numFrames)
+    {
+        //no notify, the meter thread polls so the mix side never touches a lock
+        const auto numBytes = numFrames * m_frameSize;
+        if (m_ring.freeBytes() < numBytes) {
+            m_numDroppedFrames.fetch_add(numFrames, std::memory_order_relaxed);
+            return;
+        }
+        m_ring.writeData(data, numBytes);
+    }
+
+    AudioMeterReading AudioMeter::getReading() const
+    {
+        std::uint32_t words[SNAPSHOT_WORDS];
+        for (;;)
+        {
+            const auto sequence = m_sequence.load(std::memory_order_acquire);
+            if (sequence & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            for (std::uint32_t i = 0; i < SNAPSHOT_WORDS; ++i)
+                words[i] = m_snapshot[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_sequence.load(std::memory_order_relaxed) == sequence)
+                break;
+        }
+
+        AudioMeterReading reading;
+        memcpy(&reading, words, sizeof(reading));
+        return reading;
+    }
+
+    std::uint32_t AudioMeter::getNumDroppedFrames() const
+    {
+        return m_numDroppedFrames.load(std::memory_order_relaxed);
+    }
+
+    void AudioMeter::meterLoop()
+    {
+#ifdef AUDIO_METER_SSE2
+        //filter states decay into denormals once the mix goes silent
+        _mm_setcsr(_mm_getcsr() | 0x8040);
+#endif
+        while (m_running)
+        {
+            for (;;)
+            {
+                const auto available = m_ring.availableBytes() / m_frameSize;
+                const auto numFrames = std::min(std::min(available, AUDIO_BUS_MAX_FRAMES), m_blockFrames - m_blockPos);
+                if (!numFrames)
+                    break;
+
+                m_ring.readData(m_scratch.data(), numFrames * m_frameSize);
+                DeinterleaveToBus(m_scratch.data(), m_format, numFrames, m_input);
+                process(numFrames);
+            }
+
+            const auto timeout = std::chrono::duration<float>(METER_POLL_INTERVAL);
+            std::unique_lock<Mutex> lock(m_wakeMutex);
+            m_wake.wait_for(lock, timeout, [this]() {
+                return !m_running;
+            });
+        }
+    }
+
+    void AudioMeter::process(std::uint32_t numFrames)
+    {
+        processLoudness(numFrames);
+        processTruePeak(numFrames);
+        processSpectrum(numFrames);
+
+        m_numFrames += numFrames;
+        m_blockPos  += numFrames;
+        if (m_blockPos == m_blockFrames) {
+            finishBlock();
+            m_blockPos = 0;
+        }
+    }
+
+    void AudioMeter::processLoudness(std::uint32_t numFrames)
+    {
+        for (std::uint32_t q = 0; q < m_numQuads; ++q)
+        {
+            auto& quad = m_kWeighting[q];
+            const float* channels[4];
+            for (std::uint32_t c = 0; c < 4; ++c)
+                channels[c] = m_input.getChannel(4 * q + c);
+
+#ifdef AUDIO_METER_SSE2
+            //channels of the quad in lanes, frames transposed 4 at a time
+            auto z1Shelf = _mm_load_ps(quad.m_z1[0]);
+            auto z2Shelf = _mm_load_ps(quad.m_z2[0]);
+            auto z1Pass  = _mm_load_ps(quad.m_z1[1]);
+            auto z2Pass  = _mm_load_ps(quad.m_z2[1]);
+            auto sum     = _mm_setzero_ps();
+            const auto weigh = [&](__m128 x) {
+                const auto y = Biquad(Biquad(x, quad.m_coeffs[0], z1Shelf, z2Shelf), quad.m_coeffs[1], z1Pass, z2Pass);
+                sum = _mm_add_ps(sum, _mm_mul_ps(y, y));
+            };
+
+            std::uint32_t n = 0;
+            for (; n + 4 <= numFrames; n += 4)
+            {
+                auto x0 = _mm_load_ps(channels[0] + n);
+                auto x1 = _mm_load_ps(channels[1] + n);
+                auto x2 = _mm_load_ps(channels[2] + n);
+                auto x3 = _mm_load_ps(channels[3] + n);
+                _MM_TRANSPOSE4_PS(x0, x1, x2, x3);
+                weigh(x0);
+                weigh(x1);
+                weigh(x2);
+                weigh(x3);
+            }
+            for (; n < numFrames; ++n)
+                weigh(_mm_setr_ps(channels[0][n], channels[1][n], channels[2][n], channels[3][n]));
+
+            _mm_store_ps(quad.m_z1[0], z1Shelf);
+            _mm_store_ps(quad.m_z2[0], z2Shelf);
+            _mm_store_ps(quad.m_z1[1], z1Pass);
+            _mm_store_ps(quad.m_z2[1], z2Pass);
+
+            alignas(16) float sums[4];
+            _mm_store_ps(sums, sum);
+            for (std::uint32_t c = 0; c < 4 && 4 * q + c < m_numChannels; ++c)
+                m_blockPower[4 * q + c] += sums[c];
+#else
+            for (std::uint32_t c = 0; c < 4 && 4 * q + c < m_numChannels; ++c)
+            {
+                float sum = 0.0f;
+                for (std::uint32_t n = 0; n < numFrames; ++n)
+                {
+                    auto y = channels[c][n];
+                    for (std::uint32_t stage = 0; stage < 2; ++stage)
+                    {
+                        const float (&coeffs)[5][4] = quad.m_coeffs[stage];
+                        const auto x = y;
+                        y = coeffs[0][c] * x + quad.m_z1[stage][c];
+                        quad.m_z1[stage][c] = coeffs[1][c] * x - coeffs[3][c] * y + quad.m_z2[stage][c];
+                        quad.m_z2[stage][c] = coeffs[2][c] * x - coeffs[4][c] * y;
+                    }
+                    sum += y * y;
+                }
+                m_blockPower[4 * q + c] += sum;
+            }
+#endif
+        }
+    }
+
+    void AudioMeter::processTruePeak(std::uint32_t numFrames)
+    {
+        const auto& filter = GetTruePeakFilter();
+        constexpr std::uint32_t HISTORY = TRUE_PEAK_TAPS - 1;
+
+        for (std::uint32_t c = 0; c < m_numChannels; ++c)
+        {
+            auto* x = m_peakHistory.getChannel(c);
+            memcpy(x + HISTORY, m_input.getChannel(c), sizeof(float) * numFrames);
+
+#ifdef AUDIO_METER_SSE2
+            //the 4 phases of one input frame in lanes, even & odd taps summed
+            //apart to halve the dependency chain
+            const auto signMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+            auto peak = _mm_setzero_ps();
+            for (std::uint32_t n = 0; n < numFrames; ++n)
+            {
+                const auto* frame = x + HISTORY + n;
+                auto even = _mm_mul_ps(_mm_set1_ps(frame[0]), _mm_load_ps(filter.m_coeffs[0]));
+                auto odd  = _mm_mul_ps(_mm_set1_ps(frame[-1]), _mm_load_ps(filter.m_coeffs[1]));
+                for (std::uint32_t tap = 2; tap < TRUE_PEAK_TAPS; tap += 2) {
+                    even = _mm_add_ps(even, _mm_mul_ps(_mm_set1_ps(frame[-static_cast<int>(tap)]), _mm_load_ps(filter.m_coeffs[tap])));
+                    odd  = _mm_add_ps(odd, _mm_mul_ps(_mm_set1_ps(frame[-static_cast<int>(tap) - 1]), _mm_load_ps(filter.m_coeffs[tap + 1])));
+                }
+                peak = _mm_max_ps(peak, _mm_and_ps(_mm_add_ps(even, odd), signMask));
+            }
+            alignas(16) float peaks[4];
+            _mm_store_ps(peaks, peak);
+            auto channelPeak = std::max(std::max(peaks[0], peaks[1]), std::max(peaks[2], peaks[3]));
+#else
+            float channelPeak = 0.0f;
+            for (std::uint32_t n = 0; n < numFrames; ++n)
+            {
+                const auto* frame = x + HISTORY + n;
+                for (std::uint32_t phase = 0; phase < 4; ++phase)
+                {
+                    float y = 0.0f;
+                    for (std::uint32_t tap = 0; tap < TRUE_PEAK_TAPS; ++tap)
+                        y += frame[-static_cast<int>(tap)] * filter.m_coeffs[tap][phase];
+                    channelPeak = std::max(channelPeak, std::abs(y));
+                }
+            }
+#endif
+            m_peaks[c] = std::max(m_peaks[c], channelPeak);
+            memmove(x, x + numFrames, sizeof(float) * HISTORY);
+        }
+    }
+
+    void AudioMeter::processSpectrum(std::uint32_t numFrames)
+    {
+        //mono downmix into the ring of the last SPECTRUM_SIZE frames
+        auto* mono = m_spectrumHistory.getChannel(1);
+        const auto scale = 1.0f / m_numChannels;
+        for (std::uint32_t n = 0; n < numFrames; ++n)
+            mono[n] = m_input.getChannel(0)[n] * scale;
+        for (std::uint32_t c = 1; c < m_numChannels; ++c)
+        {
+            const auto* input = m_input.getChannel(c);
+            for (std::uint32_t n = 0; n < numFrames; ++n)
+                mono[n] += input[n] * scale;
+        }
+
+        auto* history = m_spectrumHistory.getChannel(0);
+        const auto first = std::min(numFrames, SPECTRUM_SIZE - m_spectrumPos);
+        memcpy(history + m_spectrumPos, mono, sizeof(float) * first);
+        memcpy(history, mono + first, sizeof(float) * (numFrames - first));
+        m_spectrumPos = (m_spectrumPos + numFrames) & (SPECTRUM_SIZE - 1);
+    }
+
+    void AudioMeter::finishBlock()
+    {
+        AudioMeterReading reading;
+        reading.m_numFrames   = m_numFrames;
+        reading.m_numChannels = m_numChannels;
+
+        //loudness over the sliding windows, silence before metering started
+        double power = 0.0;
+        for (std::uint32_t c = 0; c < m_numChannels; ++c) {
+            power += m_weights[c] * m_blockPower[c] / m_blockFrames;
+            m_blockPower[c] = 0.0;
+        }
+        m_powers[m_powerPos] = power;
+        m_powerPos = (m_powerPos + 1) % SHORT_TERM_BLOCKS;
+
+        double momentary = 0.0;
+        double shortTerm = 0.0;
+        for (std::uint32_t i = 0; i < SHORT_TERM_BLOCKS; ++i)
+        {
+            const auto blockPower = m_powers[(m_powerPos + SHORT_TERM_BLOCKS - 1 - i) % SHORT_TERM_BLOCKS];
+            if (i < MOMENTARY_BLOCKS)
+                momentary += blockPower;
+            shortTerm += blockPower;
+        }
+        reading.m_momentary = ToLoudness(momentary / MOMENTARY_BLOCKS);
+        reading.m_shortTerm = ToLoudness(shortTerm / SHORT_TERM_BLOCKS);
+
+        //true peak
+        for (std::uint32_t c = 0; c < m_numChannels; ++c) {
+            m_maxPeak = std::max(m_maxPeak, m_peaks[c]);
+            reading.m_truePeak[c] = ToDecibels(double(m_peaks[c]) * m_peaks[c]);
+            m_peaks[c] = 0.0f;
+        }
+        reading.m_maxTruePeak = ToDecibels(double(m_maxPeak) * m_maxPeak);
+
+        //spectrum of the last SPECTRUM_SIZE frames, Hann windowed
+        const auto* history = m_spectrumHistory.getChannel(0);
+        const auto* window  = m_spectrumHistory.getChannel(2);
+        auto* frame = m_spectrumHistory.getChannel(1);
+        for (std::uint32_t i = 0; i < SPECTRUM_SIZE; ++i)
+            frame[i] = history[(m_spectrumPos + i) & (SPECTRUM_SIZE - 1)] * window[i];
+
+        auto* re    = m_spectrum.getChannel(0);
+        auto* im    = m_spectrum.getChannel(1);
+        auto* binPower = m_spectrum.getChannel(2);
+        m_fft->forward(frame, re, im);
+
+        std::uint32_t k = 0;
+        const auto numBins = m_fft->getNumBins();
+#ifdef AUDIO_METER_SSE2
+        //padded to a multiple of 4
+        for (; k < numBins; k += 4)
+        {
+            const auto r = _mm_load_ps(re + k);
+            const auto i = _mm_load_ps(im + k);
+            _mm_store_ps(binPower + k, _mm_add_ps(_mm_mul_ps(r, r), _mm_mul_ps(i, i)));
+        }
+#endif
+        for (; k < numBins; ++k)
+            binPower[k] = re[k] * re[k] + im[k] * im[k];
+
+        for (std::uint32_t band = 0; band < METER_NUM_BANDS; ++band)
+        {
+            double bandPower = 0.0;
+            for (auto bin = m_bandBins[band][0]; bin < m_bandBins[band][1]; ++bin)
+                bandPower += binPower[bin];
+            reading.m_spectrum[band] = ToDecibels(bandPower * m_spectrumScale);
+        }
+
+        publish(reading);
+    }
+
+    void AudioMeter::publish(const AudioMeterReading& reading)
+    {
+        std::uint32_t words[SNAPSHOT_WORDS];
+        memcpy(words, &reading, sizeof(reading));
+
+        //only the meter thread writes, readers retry while the sequence is odd or changed
+        const auto sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::uint32_t i = 0; i < SNAPSHOT_WORDS; ++i)
+            m_snapshot[i].store(words[i], std::memory_order_relaxed);
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+}
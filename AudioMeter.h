@@ -0,0 +1,146 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <Common/Thread.h>
+
+#include "AudioBus.h"
+#include "AudioConfig.h"
+#include "AudioFFT.h"
+#include "AudioRingBuffer.h"
+
+namespace Audio
+{
+    //third octave bands from 20 Hz to 20 kHz
+    constexpr std::uint32_t METER_NUM_BANDS = 31;
+    //reported for silence instead of -inf, LUFS, dBTP & dBFS
+    constexpr float         METER_FLOOR     = -120.0f;
+    //256 KiB, 8192 frames of 8 fp32 channels
+    constexpr int           METER_RING_SIZE = 1 << 18;
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Meter values of the final mix, a new reading is published every
+    // 100 ms of audio. Loudness follows EBU R128 / ITU-R BS.1770
+    //////////////////////////////////////////////////////////////////////////
+    struct AudioMeterReading
+    {
+        AudioMeterReading();
+
+        std::uint64_t   m_numFrames;                            //metered up to this reading
+        std::uint32_t   m_numChannels;
+        float           m_momentary;                            //LUFS, last 400 ms
+        float           m_shortTerm;                            //LUFS, last 3 s
+        float           m_truePeak[AUDIO_BUS_MAX_CHANNELS];     //dBTP, since the previous reading
+        float           m_maxTruePeak;                          //dBTP, since metering started
+        float           m_spectrum[METER_NUM_BANDS];            //dBFS, a full scale sine reads 0
+    };
+
+    /*
+        @brief: Center frequency of a third octave band of the spectrum, Hz
+    */
+    float                   GetMeterBandFrequency( std::uint32_t band );
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Master bus metering on its own thread. The mix side only copies
+    // its output into a lock free ring, the meter thread K-weights it for
+    // loudness, oversamples it 4x for the true peak and runs an FFT for the
+    // third octave spectrum. Readings are published through a sequence
+    // lock, any thread reads the latest one without blocking the meter
+    //////////////////////////////////////////////////////////////////////////
+    class AudioMeter
+    {
+    public:
+        explicit AudioMeter( const AudioConfig& format );
+        ~AudioMeter();
+
+        AudioMeter( const AudioMeter& ) = delete;
+        AudioMeter& operator = ( const AudioMeter& ) = delete;
+
+        void                start();
+        void                stop();
+
+        /*
+            @brief: Mix side, copies 'numFrames' interleaved fp32 frames. The
+            block is dropped if the meter thread fell that far behind
+        */
+        void                push( const void* data, std::uint32_t numFrames );
+
+        /*
+            @brief: Any thread, the latest reading
+        */
+        AudioMeterReading   getReading() const;
+
+        std::uint32_t       getNumDroppedFrames() const;
+
+    private:
+        struct alignas(16) KWeightingQuad
+        {
+            float           m_coeffs[2][5][4];  //per stage b0, b1, b2, a1, a2, splat
+            float           m_z1[2][4];
+            float           m_z2[2][4];
+        };
+
+        void                meterLoop();
+
+        /*
+            @brief: Meters 'numFrames' of 'm_input', never across a 100 ms block
+        */
+        void                process( std::uint32_t numFrames );
+        void                processLoudness( std::uint32_t numFrames );
+        void                processTruePeak( std::uint32_t numFrames );
+        void                processSpectrum( std::uint32_t numFrames );
+
+        /*
+            @brief: A 100 ms block is complete, updates the loudness windows,
+            the spectrum and publishes the reading
+        */
+        void                finishBlock();
+        void                publish( const AudioMeterReading& reading );
+
+        static constexpr std::uint32_t  SNAPSHOT_WORDS = sizeof(AudioMeterReading) / sizeof(std::uint32_t);
+
+        AudioConfig                 m_format;
+        std::uint32_t               m_numChannels;
+        std::uint32_t               m_numQuads;
+        std::uint32_t               m_frameSize;
+        std::uint32_t               m_sampleRate;
+        std::uint32_t               m_blockFrames;      //100 ms
+        std::uint32_t               m_blockPos;
+        std::uint64_t               m_numFrames;
+
+        //meter thread only
+        std::vector<float>          m_scratch;          //interleaved, from the ring
+        AudioBus                    m_input;            //planar
+        float                       m_weights[AUDIO_BUS_MAX_CHANNELS];  //BS.1770 channel weights
+        std::vector<KWeightingQuad> m_kWeighting;       //4 channels per quad
+        double                      m_blockPower[AUDIO_BUS_MAX_CHANNELS];   //K-weighted sum of squares
+        std::vector<double>         m_powers;           //weighted mean square of the last 30 blocks
+        std::uint32_t               m_powerPos;
+
+        AudioBus                    m_peakHistory;      //per channel, the last taps - 1 frames ahead of the input
+        float                       m_peaks[AUDIO_BUS_MAX_CHANNELS];
+        float                       m_maxPeak;
+
+        std::unique_ptr<AudioFFT>   m_fft;
+        AudioBus                    m_spectrumHistory;  //mono downmix ring & the windowed frame
+        AudioBus                    m_spectrum;         //re, im, power
+        std::uint32_t               m_spectrumPos;
+        std::uint32_t               m_bandBins[METER_NUM_BANDS][2]; //first & end bin
+        float                       m_spectrumScale;
+
+        AudioRingBuffer<METER_RING_SIZE>        m_ring;     //mix side -> meter thread
+        std::atomic<std::uint32_t>              m_numDroppedFrames;
+
+        std::atomic<std::uint32_t>              m_sequence; //odd while a reading is written
+        std::atomic<std::uint32_t>              m_snapshot[SNAPSHOT_WORDS];
+
+        std::thread                             m_thread;
+        std::atomic<bool>                       m_running;
+        Common::Mutex                           m_wakeMutex;
+        std::condition_variable_any             m_wake;
+    };
+}
@@ -0,0 +1,167 @@
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "AudioException.h"
+#include "AudioMixThread.h"
+#include "AudioMixerBase.h"
+
+using namespace Common;
+
+namespace Audio
+{
+    namespace
+    {
+        constexpr float MIX_AHEAD_POLL_FRACTION = 0.25f; //poll interval in chunks
+
+        /*
+            @brief: Best effort, realtime scheduling needs privileges on posix
+            systems and the thread keeps its priority otherwise
+        */
+        void SetMixThreadPriority()
+        {
+#if defined(_WIN32)
+            SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+#else
+            sched_param param = {};
+            param.sched_priority = sched_get_priority_max(SCHED_FIFO) / 2;
+            pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+#endif
+        }
+    }
+
+    AudioMixThread::AudioMixThread(const RenderFunc& render, const AudioConfig& format, std::uint32_t chunkFrames, std::uint32_t headroomFrames)
+        : m_render( render )
+        , m_frameSize( format.getBytesPerSample() )
+        , m_chunkFrames( 0 )
+        , m_headroomFrames( 0 )
+        , m_minFillFrames( ~0u )
+        , m_numUnderruns( 0 )
+        , m_running( false )
+        , m_numChannels( format.getNumChannels() )
+        , m_sampleRate( format.getSampleRate() )
+    {
+        if (format.m_format != audio_format_f32 || !m_frameSize || !m_sampleRate)
+            throw AudioException("Mix Thread Needs A FP32 Output Format");
+
+        m_scratch.resize(AUDIO_MIX_MAX_FRAMES * m_numChannels);
+        setHeadroom(chunkFrames, headroomFrames);
+    }
+
+    AudioMixThread::~AudioMixThread()
+    {
+        stop();
+    }
+
+    void AudioMixThread::start()
+    {
+        if (m_running)
+            return;
+
+        //prime the ring so the device doesn't start on an underrun
+        fill();
+        m_running = true;
+        m_thread = std::thread(&AudioMixThread::mixLoop, this);
+    }
+
+    void AudioMixThread::stop()
+    {
+        {
+            std::unique_lock<Mutex> lock(m_wakeMutex);
+            m_running = false;
+        }
+        m_wake.notify_all();
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+
+    std::uint32_t AudioMixThread::read(std::uint32_t numFrames, void* data)
+    {
+        const auto fillFrames = getFillFrames();
+        auto minFill = m_minFillFrames.load(std::memory_order_relaxed);
+        while (fillFrames < minFill && !m_minFillFrames.compare_exchange_weak(minFill, fillFrames, std::memory_order_relaxed)) {}
+
+        const auto numRead = std::min(fillFrames, numFrames);
+        m_ring.readData(data, numRead * m_frameSize);
+        if (numRead < numFrames) {
+            memset(static_cast<char*>(data) + numRead * m_frameSize, 0, (numFrames - numRead) * m_frameSize);
+            m_numUnderruns.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        //no notify, the mix thread polls so the device callback never touches a lock
+        return numFrames;
+    }
+
+    void AudioMixThread::setHeadroom(std::uint32_t chunkFrames, std::uint32_t headroomFrames)
+    {
+        const auto ringFrames = m_ring.getByteSize() / m_frameSize;
+        //a chunk is rendered by one mixer pass
+        chunkFrames = std::min(std::max(chunkFrames, 1u), AUDIO_MIX_MAX_FRAMES);
+        m_chunkFrames.store(chunkFrames, std::memory_order_relaxed);
+        m_headroomFrames.store(std::min(std::max(headroomFrames, chunkFrames), ringFrames - chunkFrames), std::memory_order_relaxed);
+    }
+
+    std::uint32_t AudioMixThread::getHeadroom() const
+    {
+        return m_headroomFrames.load(std::memory_order_relaxed);
+    }
+
+    AudioMixAheadStats AudioMixThread::getStats()
+    {
+        AudioMixAheadStats stats;
+        stats.m_fillFrames     = getFillFrames();
+        stats.m_minFillFrames  = m_minFillFrames.exchange(~0u, std::memory_order_relaxed);
+        stats.m_headroomFrames = m_headroomFrames.load(std::memory_order_relaxed);
+        stats.m_numUnderruns   = m_numUnderruns.load(std::memory_order_relaxed);
+        if (stats.m_minFillFrames == ~0u)
+            stats.m_minFillFrames = stats.m_fillFrames;
+        return stats;
+    }
+
+    void AudioMixThread::mixLoop()
+    {
+        SetMixThreadPriority();
+        while (m_running)
+        {
+            fill();
+
+            //polls a few times per chunk, the headroom holds at least one chunk
+            //so the ring is topped up before the device drains it. Only 'stop' notifies
+            const auto timeout = std::chrono::duration<float>(MIX_AHEAD_POLL_FRACTION * m_chunkFrames.load(std::memory_order_relaxed) / m_sampleRate);
+            std::unique_lock<Mutex> lock(m_wakeMutex);
+            m_wake.wait_for(lock, timeout, [this]() {
+                return !m_running;
+            });
+        }
+    }
+
+    void AudioMixThread::fill()
+    {
+        const auto chunkFrames = m_chunkFrames.load(std::memory_order_relaxed);
+        while (getFillFrames() < m_headroomFrames.load(std::memory_order_relaxed))
+        {
+            //only this thread writes, the free space can only grow meanwhile
+            const auto numFrames = std::min(chunkFrames, m_ring.freeBytes() / m_frameSize);
+            if (!numFrames)
+                break;
+
+            const auto numMixed = std::min(m_render(numFrames, m_scratch.data()), numFrames);
+            if (numMixed < numFrames)
+                memset(m_scratch.data() + numMixed * m_numChannels, 0, (numFrames - numMixed) * m_frameSize);
+            m_ring.writeData(m_scratch.data(), numFrames * m_frameSize);
+        }
+    }
+
+    std::uint32_t AudioMixThread::getFillFrames() const
+    {
+        return m_ring.availableBytes() / m_frameSize;
+    }
+}
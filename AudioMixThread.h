@@ -0,0 +1,96 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <Common/Thread.h>
+
+#include "AudioConfig.h"
+#include "AudioRingBuffer.h"
+
+namespace Audio
+{
+    //128 KiB, 16384 stereo fp32 frames
+    constexpr int MIX_AHEAD_RING_SIZE = 1 << 17;
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Output ring fill counters, all in frames
+    //////////////////////////////////////////////////////////////////////////
+    struct AudioMixAheadStats
+    {
+        std::uint32_t       m_fillFrames     = 0; //currently buffered
+        std::uint32_t       m_minFillFrames  = 0; //lowest fill seen by the device since the last query
+        std::uint32_t       m_headroomFrames = 0; //fill the mix thread keeps up
+        std::uint32_t       m_numUnderruns   = 0; //device reads the ring couldn't satisfy
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Mixes on its own high priority thread into a lock free output
+    // ring, keeping 'headroom' frames ahead of the device. The device
+    // callback only copies out of the ring, so jitter in decoding or mixing
+    // is absorbed as long as it stays below the headroom
+    //////////////////////////////////////////////////////////////////////////
+    class AudioMixThread
+    {
+    public:
+        using RenderFunc = std::function<std::uint32_t(std::uint32_t numFrames, void* data)>;
+
+        /*
+            @brief: 'render' writes up to 'numFrames' interleaved fp32 frames of
+            'format' and returns # frames written, the rest is silence. It is
+            called in chunks of 'chunkFrames'
+        */
+        AudioMixThread( const RenderFunc& render, const AudioConfig& format, std::uint32_t chunkFrames, std::uint32_t headroomFrames );
+        ~AudioMixThread();
+
+        AudioMixThread(const AudioMixThread&) = delete;
+        AudioMixThread& operator=(const AudioMixThread&) = delete;
+
+        /*
+            @brief: Fills the headroom on the calling thread, then starts the
+            mix thread
+        */
+        void                start();
+        void                stop();
+
+        /*
+            @brief: Device callback, copies 'numFrames' frames to 'data' and
+            pads with silence if the ring runs dry. Returns 'numFrames'
+        */
+        std::uint32_t       read( std::uint32_t numFrames, void* data );
+
+        /*
+            @brief: The chunk is clamped to 'AUDIO_MIX_MAX_FRAMES', the headroom
+            to what the ring can hold next to one chunk
+        */
+        void                setHeadroom( std::uint32_t chunkFrames, std::uint32_t headroomFrames );
+
+        std::uint32_t       getHeadroom() const;
+        AudioMixAheadStats  getStats();
+
+    private:
+        void                mixLoop();
+        void                fill();
+        std::uint32_t       getFillFrames() const;
+
+        RenderFunc                              m_render;
+        std::uint32_t                           m_frameSize;
+        std::atomic<std::uint32_t>              m_chunkFrames;
+        std::atomic<std::uint32_t>              m_headroomFrames;
+        std::vector<float>                      m_scratch;      //mix thread only
+
+        AudioRingBuffer<MIX_AHEAD_RING_SIZE>    m_ring;         //mix thread -> device
+        std::atomic<std::uint32_t>              m_minFillFrames;
+        std::atomic<std::uint32_t>              m_numUnderruns;
+
+        std::thread                             m_thread;
+        std::atomic<bool>                       m_running;
+        Common::Mutex                           m_wakeMutex;
+        std::condition_variable_any             m_wake;
+        std::uint32_t                           m_numChannels;
+        std::uint32_t                           m_sampleRate;
+    };
+}
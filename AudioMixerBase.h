@@ -1,9 +1,15 @@
 #pragma once
 
 #include "AudioConfig.h"
+#include "AudioEffectBasePtr.h"
+#include "AudioVoiceTable.h"
 
 namespace Audio
 {
+    //frames a mixer renders in one pass, longer requests are split. Device
+    //periods & mix-ahead chunks are kept within it
+    constexpr std::uint32_t AUDIO_MIX_MAX_FRAMES = 2048;
+
     class AudioMixerBase
     {
     public:
@@ -14,14 +20,21 @@ namespace Audio
         */
         virtual bool            initialize(const AudioConfig&) = 0;        
 
+        /*
+            @brief: Effect on the send bus voices feed through their send level,
+            set before 'initialize'. False if the mixer has no send bus
+        */
+        virtual bool            setSendEffect( const AudioEffectBasePtr& ) { return false; }
+
         /*
             @brief: Update incoming sounds, e.g. adjust panning, or gain
         */
-        virtual bool            updateActiveSounds( const ActiveAudioVector& ) = 0;
+        virtual bool            updateActiveSounds( AudioVoiceList& ) = 0;
 
         /*
-            @brief: Mix all sounds together into a output buffer
+            @brief: Mix all sounds together into a output buffer, per voice
+            DSP state( e.g. filters ) advances
         */
-        virtual std::uint32_t   mixIncomingSounds(  const ActiveAudioVector&, std::uint32_t numSamples, void* data ) = 0;
+        virtual std::uint32_t   mixIncomingSounds(  AudioVoiceList&, std::uint32_t numSamples, void* data ) = 0;
     };
 }
\ No newline at end of file
@@ -1,5 +1,5 @@
 #pragma once
-
+#include <algorithm>
 
 #include <Engine/EngineContext.h>
 
@@ -8,8 +8,11 @@
 #include <Components/AudioListenerComponent.h>
 #include <Components/AudioComponent.h>
 
+#include "AudioBus.h"
+#include "AudioConversion.h"
+#include "AudioEffectBase.h"
+#include "AudioFilterBank.h"
 #include "AudioMixerBase.h"
-#include "AudioMixerHelper.h"
 #include "AudioSystem.h"
 
 using namespace Components;
@@ -77,104 +80,238 @@ namespace Audio
         bool            initialize(const AudioConfig& format) override
         {
             m_outputFormat = format;
+            //a voice block holds up to 'VOICE_BUS_FRAMES' input frames before resampling
+            m_voiceScratch.resize(1, VOICE_BUS_FRAMES * AUDIO_BUS_MAX_CHANNELS);
+            m_voiceBus.resize(AUDIO_BUS_MAX_CHANNELS, VOICE_BUS_FRAMES);
+            m_remixBus.resize(AUDIO_BUS_MAX_CHANNELS, VOICE_BUS_FRAMES);
+            m_resampleBus.resize(AUDIO_BUS_MAX_CHANNELS);
+            m_mixBus.resize(AUDIO_BUS_MAX_CHANNELS);
+            m_filterBank.initialize(format.m_sampleRate);
+            if (m_sendEffect) {
+                m_sendBus.resize(AUDIO_BUS_MAX_CHANNELS);
+                return m_sendEffect->initialize(format);
+            }
+            return true;
+        }
+
+        bool            setSendEffect(const AudioEffectBasePtr& effect) override
+        {
+            m_sendEffect = effect;
             return true;
         }
 
-        bool            updateActiveSounds(const ActiveAudioVector& aav) override
+        bool            updateActiveSounds(AudioVoiceList& voices) override
         {
             const auto& as = m_context->getSystem<AudioSystem>();
             const auto& outFormat = m_outputFormat;
             const auto& listener  = as->getListener();
             const auto pos = listener ? listener->getPosition() : Vector3f(0.0f);
 
-            for (const auto& iter : aav)
+            for (std::uint32_t i = 0; i < voices.size(); ++i)
             {
-                const auto info = GetMixInfo( pos, iter->getPosition() );
+                auto* sound = voices.m_sources[i];
+                const auto info = GetMixInfo( pos, sound->getPosition() );
                 const auto audioPan = outFormat.m_channels >= 2
                     ? AngleToAudioPan(info.m_angle) : 0.0f;
 
-                iter->setPanning(audioPan);
+                sound->setPanning(audioPan);
+                //gather hot state once, mixing reads the dense arrays only
+                const auto& inFormat = sound->getAudioFormat();
+                voices.m_formats[i] = inFormat;
+                //sources above 'MAX_SAMPLE_RATIO' times the output rate are slowed
+                //down, a new rate restarts the resampler
+                const auto ratio = std::min(static_cast<float>(inFormat.m_sampleRate) / static_cast<float>(outFormat.m_sampleRate), float(MAX_SAMPLE_RATIO));
+                if (voices.m_resamplers[i].m_ratio != ratio) {
+                    voices.m_resamplers[i] = AudioResampleState();
+                    voices.m_resamplers[i].m_ratio = ratio;
+                }
+                voices.m_pans[i]  = audioPan;
+                voices.m_gains[i] = sound->getAttenuation();
+                voices.m_flags[i] = ( voices.m_flags[i] & VOICE_FLAG_HELD ) |
+                                    ( sound->isPlaying() ? VOICE_FLAG_PLAYING : VOICE_FLAG_NONE ) |
+                                    ( sound->hasAudioFlag(AUDIO_NO_PANNING) ? VOICE_FLAG_NO_PANNING : VOICE_FLAG_NONE );
             }
             return true;
         };
 
 
-        std::uint32_t   mixIncomingSounds(const ActiveAudioVector& aav, std::uint32_t numSamples, void* data) override
+        std::uint32_t   mixIncomingSounds(AudioVoiceList& voices, std::uint32_t numSamples, void* data) override
         {
-            AudioBlockInternal result;
+            //longer requests are split into blocks the voice buses hold, this
+            //runs on the device callback and must not throw
+            const auto frameSize = m_outputFormat.getBytesPerSample();
+            auto* dest = static_cast<char*>(data);
+            std::uint32_t numMixed = 0;
+            for (std::uint32_t offset = 0; offset < numSamples; )
+            {
+                const auto numFrames = std::min(numSamples - offset, AUDIO_MIX_MAX_FRAMES);
+                if (mixBlock(voices, numFrames, dest + std::size_t(offset) * frameSize)) {
+                    //blocks nothing played in were left untouched
+                    memset(dest + std::size_t(numMixed) * frameSize, 0, std::size_t(offset - numMixed) * frameSize);
+                    numMixed = offset + numFrames;
+                }
+                offset += numFrames;
+            }
+            return numMixed;
+        }
 
+    private:
+        /*
+            @brief: Mixes up to 'AUDIO_MIX_MAX_FRAMES', returns 0 and leaves
+            'data' untouched if nothing played
+        */
+        std::uint32_t   mixBlock(AudioVoiceList& voices, std::uint32_t numSamples, void* data)
+        {
             const auto& outFormat = m_outputFormat;
             const auto outChanCount = outFormat.getNumChannels();
-            const auto numOutputSamples = numSamples * outChanCount;
+            auto* scratch = m_voiceScratch.getChannel(0);
+            const auto scratchBytes = m_voiceScratch.getMaxFrames() * std::uint32_t( sizeof(float) );
+
+            for (std::uint32_t c = 0; c < outChanCount; ++c)
+                memset(m_mixBus.getChannel(c), 0, sizeof(float) * numSamples);
+            if (m_sendEffect) {
+                for (std::uint32_t c = 0; c < outChanCount; ++c)
+                    memset(m_sendBus.getChannel(c), 0, sizeof(float) * numSamples);
+            }
 
             //mix all sources
             int numSoundSources = 0;
-            for (const auto& sound : aav)
+            for (std::uint32_t voice = 0; voice < voices.size(); ++voice)
             {
-                if (!sound->isPlaying())
+                const auto flags = voices.m_flags[voice];
+                if (!(flags & VOICE_FLAG_PLAYING) || (flags & VOICE_FLAG_HELD))
                     continue;
 
+                auto* sound = voices.m_sources[voice];
                 const bool isStereo = outChanCount == 2;
-                const bool ignorePan = sound->hasAudioFlag(AUDIO_NO_PANNING);
-
-                AudioBlockInternal  curAudioBlock; //working block
-                const auto& inFormat = sound->getAudioFormat();
-
-                //need to resample audio data?
-                float sampleRatio = 1.0f;
-                if (inFormat.m_sampleRate != outFormat.m_sampleRate)
-                    sampleRatio = static_cast<float>(inFormat.m_sampleRate) / static_cast<float>(outFormat.m_sampleRate);
+                const bool ignorePan = (flags & VOICE_FLAG_NO_PANNING) != 0;
 
+                //rejected when added, skipped here as the callback must not throw
+                const auto& inFormat = voices.m_formats[voice];
+                const auto inChanCount = inFormat.getNumChannels();
+                if (!IsBusFormat(inFormat))
+                    continue;
 
-                //read data from audio source
-                const auto bps = sound->getAudioFormat().getBytesPerSample();
-                auto numBytes = std::uint32_t(bps * numSamples * sampleRatio);
-                if (numBytes & 0x01) //don't read an odd number of from stream
-                    numBytes--;
-                sound->consume(curAudioBlock.getData(), numBytes);
+                float gains[AUDIO_BUS_MAX_CHANNELS];
+                std::fill(std::begin(gains), std::end(gains), 1.0f);
+                if (isStereo && !ignorePan)
+                    GetPanningGains(voices.m_pans[voice], voices.m_gains[voice], gains);
+                for (auto& gain : gains)
+                    gain *= voices.m_volumes[voice];
 
-                const auto inChanCount = inFormat.getNumChannels();
+                //asset prepared for the device at load time, accumulate as is
+                if (IsDeviceFormat(inFormat, outFormat))
+                {
+                    //a stream that ends early leaves silence
+                    const auto numBytes = std::min(numSamples * outFormat.getBytesPerSample(), scratchBytes);
+                    memset(scratch, 0, numBytes);
+                    sound->consume(scratch, numBytes);
+                    DeinterleaveToBus(scratch, inFormat, numSamples, m_voiceBus);
+                    mixVoice(voices, voice, m_voiceBus, numSamples, gains);
+                    numSoundSources++;
+                    continue;
+                }
 
-                //total amount of samples for input data
-                const auto numInputSamples = std::uint32_t(numSamples * inChanCount * sampleRatio);
-                //convert to input internal FP32 format            
-                curAudioBlock = ConvertAudioBlock(curAudioBlock, inFormat, outFormat, numInputSamples);
+                //input frames for this block, the resampler carries the fraction
+                //over. The clamped ratio keeps it within the voice bus
+                const auto bps = inFormat.getBytesPerSample();
+                auto& resampler = voices.m_resamplers[voice];
+                const bool resample = resampler.m_ratio != 1.0f;
+                const auto numInputFrames = std::min({ resample ? GetResampleInputFrames(resampler, numSamples) : numSamples,
+                                                       VOICE_BUS_FRAMES, scratchBytes / bps });
+
+                //read data from audio source, split into planar fp32 channels
+                const auto numBytes = numInputFrames * bps;
+                memset(scratch, 0, numBytes);
+                if (numBytes)
+                    sound->consume(scratch, numBytes);
+                DeinterleaveToBus(scratch, inFormat, numInputFrames, m_voiceBus);
+                const AudioBus* voiceBus = &m_voiceBus;
 
                 //Convert input stereo channel into mono, or mono to stereo
-                if (inFormat.getNumChannels() != outFormat.getNumChannels())
-                    curAudioBlock = ConvertChannel<float>(curAudioBlock, numInputSamples, inChanCount, outChanCount);
-
-                //apply panning to source
-                if (isStereo && !ignorePan)
-                {
-                    const float pan = sound->getPanning();
-                    const float atten = sound->getAttenuation();
-                    curAudioBlock = ApplyPanningInterleaved<float>(curAudioBlock, numSamples, pan, atten);
+                if (inChanCount != outChanCount) {
+                    RemixBus(*voiceBus, inChanCount, m_remixBus, outChanCount, numInputFrames);
+                    voiceBus = &m_remixBus;
                 }
 
-                //when arriving here, assume curAudioBlock has already the correct interleaved channels 
-                if (sampleRatio != 1.0f)  //resample audio format, depending on the input & output frequencies       
-                    curAudioBlock = ResampleAudioBlock<float>(curAudioBlock, numSamples, outChanCount, sampleRatio);
+                //resample audio format, depending on the input & output frequencies
+                if (resample) {
+                    ResampleBus(*voiceBus, numInputFrames, m_resampleBus, numSamples, outChanCount, resampler);
+                    voiceBus = &m_resampleBus;
+                }
 
-                //add to output
-                result = AddAudioBlock<float>(result, curAudioBlock, numOutputSamples);
+                //add to output, panning is applied as per channel gain
+                mixVoice(voices, voice, *voiceBus, numSamples, gains);
                 numSoundSources++; //increment # sources
             }
 
-            if (numSoundSources)
+            //filter & add the occluded voices still batched
+            m_filterBank.process(m_mixBus, numSamples);
+
+            //one effect for every voice on the send, it also runs without
+            //input so the tail rings out
+            if (m_sendEffect)
             {
-                const float invNumSounds = 1.0f / numSoundSources;
-                //finalBlock = ScaleAudioBlock<float>(finalBlock, numOutputSamples, invNumSounds);
-                memcpy(data, result.toPointer<float>(), sizeof(float) * numOutputSamples);
+                float unity[AUDIO_BUS_MAX_CHANNELS];
+                std::fill(std::begin(unity), std::end(unity), 1.0f);
+                m_sendEffect->process(m_sendBus, outChanCount, numSamples);
+                AccumulateBus(m_mixBus, m_sendBus, outChanCount, numSamples, unity);
+            }
+
+            if (numSoundSources || m_sendEffect)
+            {
+                //interleave at the device boundary
+                InterleaveBus(m_mixBus, outChanCount, numSamples, static_cast<float*>(data));
                 return numSamples;
             }
             return 0;
         }
 
-    private:
+        /*
+            @brief: Accumulates a voice at the output rate & channel count,
+            occluded voices are batched for the filter bank instead
+        */
+        void            mixVoice(AudioVoiceList& voices, std::uint32_t voice, const AudioBus& voiceBus, std::uint32_t numSamples, const float* gains)
+        {
+            const auto outChanCount = m_outputFormat.getNumChannels();
+
+            //sent before the occlusion filter, a hidden source still excites the room
+            const auto send = voices.m_sends[voice];
+            if (m_sendEffect && send > 0.0f) {
+                float sendGains[AUDIO_BUS_MAX_CHANNELS];
+                for (std::uint32_t c = 0; c < outChanCount; ++c)
+                    sendGains[c] = gains[c] * send;
+                AccumulateBus(m_sendBus, voiceBus, outChanCount, numSamples, sendGains);
+            }
+
+            auto& filter = voices.m_filters[voice];
+            const auto occlusion = voices.m_occlusions[voice];
+            if (m_filterBank.isBypassed(filter, occlusion)) {
+                AccumulateBus(m_mixBus, voiceBus, outChanCount, numSamples, gains);
+                return;
+            }
+
+            if (m_filterBank.getNumFreeLanes() < outChanCount)
+                m_filterBank.process(m_mixBus, numSamples);
+            const auto lane = m_filterBank.addVoice(filter, occlusion, outChanCount, gains);
+            for (std::uint32_t c = 0; c < outChanCount; ++c)
+                memcpy(m_filterBank.getLane(lane + c), voiceBus.getChannel(c), sizeof(float) * numSamples);
+        }
+
+        static constexpr std::uint32_t MAX_SAMPLE_RATIO = 4;
+        static constexpr std::uint32_t VOICE_BUS_FRAMES = MAX_SAMPLE_RATIO * AUDIO_MIX_MAX_FRAMES;
 
         EngineContext*  m_context;
         AudioConfig     m_outputFormat;
 
+        AudioBus        m_voiceScratch; //interleaved input of the current voice, one channel as raw storage
+        AudioBus        m_voiceBus;     //deinterleaved input of the current voice
+        AudioBus        m_remixBus;     //channel converted voice
+        AudioBus        m_resampleBus;  //voice at the output rate
+        AudioBus        m_mixBus;       //sum of all voices
+        AudioFilterBank m_filterBank;   //occlusion low-pass
+        AudioBus        m_sendBus;      //voices at their send level
+        AudioEffectBasePtr m_sendEffect;
+
     };
 }
\ No newline at end of file
@@ -0,0 +1,175 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include "AudioBlock.h"
+#include "AudioStream.h"
+
+namespace Audio
+{
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Up to two contiguous byte ranges of a ring buffer, the second
+    // one is only used when the range wraps around the end of the storage
+    //////////////////////////////////////////////////////////////////////////
+    template<typename T>
+    struct AudioSpan
+    {
+        std::uint32_t       getSize() const { return m_size[0] + m_size[1]; }
+
+        T*                  m_data[2] = { nullptr, nullptr };
+        std::uint32_t       m_size[2] = { 0, 0 };
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Lock free single producer / single consumer pcm ring buffer on
+    // top of AudioBlock storage. Positions run freely and are masked with
+    // BUF_MASK, so a full buffer holds all BUF_SIZE bytes. Data can either be
+    // copied with 'writeData'/'readData' or accessed in place through spans,
+    // which have to be committed afterwards
+    //////////////////////////////////////////////////////////////////////////
+    template<int BUF_SIZE>
+    class AudioRingBuffer
+    {
+        static_assert(BUF_SIZE > 0 && (BUF_SIZE & (BUF_SIZE - 1)) == 0, "AudioRingBuffer size must be a power of two");
+
+    public:
+        using Block = AudioBlock<BUF_SIZE>;
+
+        AudioRingBuffer()
+            : m_readPos( 0 )
+            , m_writePos( 0 )
+        {
+        }
+
+        AudioRingBuffer(const AudioRingBuffer&) = delete;
+        AudioRingBuffer& operator=(const AudioRingBuffer&) = delete;
+
+        inline constexpr std::uint32_t  getByteSize() const {
+            return BUF_SIZE;
+        }
+
+        /*
+            @brief: Bytes ready to be read, exact on the consumer thread
+        */
+        inline std::uint32_t            availableBytes() const {
+            return m_writePos.load(std::memory_order_acquire) - m_readPos.load(std::memory_order_relaxed);
+        }
+
+        /*
+            @brief: Bytes that can be written, exact on the producer thread
+        */
+        inline std::uint32_t            freeBytes() const {
+            return BUF_SIZE - ( m_writePos.load(std::memory_order_relaxed) - m_readPos.load(std::memory_order_acquire) );
+        }
+
+        /*
+            @brief: Drops all data, neither side may access the buffer meanwhile
+        */
+        void                            reset()
+        {
+            m_readPos.store(0, std::memory_order_relaxed);
+            m_writePos.store(0, std::memory_order_relaxed);
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        //\Brief: Producer side
+        //////////////////////////////////////////////////////////////////////////
+        AudioSpan<char>                 getWriteSpan( std::uint32_t maxBytes = BUF_SIZE )
+        {
+            const auto pos = m_writePos.load(std::memory_order_relaxed);
+            return makeSpan<char>(m_block.m_data.data(), pos, std::min(maxBytes, freeBytes()));
+        }
+
+        inline void                     commitWrite( std::uint32_t numBytes ) {
+            m_writePos.store(m_writePos.load(std::memory_order_relaxed) + numBytes, std::memory_order_release);
+        }
+
+        /*
+            @brief: Write data to the buffer, returns # bytes written
+        */
+        std::uint32_t                   writeData( const void* data, std::uint32_t numBytes )
+        {
+            const auto span = getWriteSpan(numBytes);
+            const auto* src = static_cast<const char*>(data);
+            memcpy(span.m_data[0], src, span.m_size[0]);
+            if (span.m_size[1])
+                memcpy(span.m_data[1], src + span.m_size[0], span.m_size[1]);
+            commitWrite(span.getSize());
+            return span.getSize();
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        //\Brief: Consumer side
+        //////////////////////////////////////////////////////////////////////////
+        AudioSpan<const char>           getReadSpan( std::uint32_t maxBytes = BUF_SIZE ) const
+        {
+            const auto pos = m_readPos.load(std::memory_order_relaxed);
+            return makeSpan<const char>(m_block.m_data.data(), pos, std::min(maxBytes, availableBytes()));
+        }
+
+        inline void                     commitRead( std::uint32_t numBytes ) {
+            m_readPos.store(m_readPos.load(std::memory_order_relaxed) + numBytes, std::memory_order_release);
+        }
+
+        /*
+            @brief: Read data from the buffer, returns # bytes read
+        */
+        std::uint32_t                   readData( void* dest, std::uint32_t numBytes )
+        {
+            const auto span = getReadSpan(numBytes);
+            auto* dst = static_cast<char*>(dest);
+            memcpy(dst, span.m_data[0], span.m_size[0]);
+            if (span.m_size[1])
+                memcpy(dst + span.m_size[0], span.m_data[1], span.m_size[1]);
+            commitRead(span.getSize());
+            return span.getSize();
+        }
+
+    private:
+        template<typename T, typename U>
+        static AudioSpan<T>             makeSpan( U* data, std::uint32_t pos, std::uint32_t numBytes )
+        {
+            const auto offset = pos & Block::BUF_MASK;
+            AudioSpan<T> span;
+            span.m_data[0] = data + offset;
+            span.m_size[0] = std::min<std::uint32_t>(numBytes, BUF_SIZE - offset);
+            span.m_data[1] = data;
+            span.m_size[1] = numBytes - span.m_size[0];
+            return span;
+        }
+
+        Block                                   m_block;
+        alignas(64) std::atomic<std::uint32_t>  m_readPos;  //written by the consumer only
+        alignas(64) std::atomic<std::uint32_t>  m_writePos; //written by the producer only
+    };
+
+    /*
+        @brief: Decodes up to 'maxBytes' from 'stream' straight into the free
+        space of 'ring', without an intermediate copy. 'frameSize' must divide
+        the ring size so no frame straddles the wrap point. Returns # bytes
+        written
+    */
+    template<int BUF_SIZE>
+    std::uint32_t WriteFromStream( AudioRingBuffer<BUF_SIZE>& ring, AudioStreamBase& stream, std::uint32_t frameSize, std::uint32_t maxBytes = BUF_SIZE )
+    {
+        assert(frameSize && BUF_SIZE % frameSize == 0);
+        const auto span = ring.getWriteSpan(maxBytes);
+
+        std::uint32_t result = 0;
+        for (int i = 0; i < 2; ++i)
+        {
+            const auto numBytes = span.m_size[i] - span.m_size[i] % frameSize;
+            if (!numBytes)
+                break;
+            const auto numRead = stream.getData(span.m_data[i], numBytes);
+            result += numRead;
+            if (numRead < numBytes)
+                break;
+        }
+        ring.commitWrite(result);
+        return result;
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+namespace Audio
+{
+    //tag of packed 3 byte audio_format_s24 samples
+    struct Packed24 {};
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Reads one sample of type 'T' as fp32, integers are scaled
+    // symmetrically( s16 / 32768 ), u8 is centered on 128. 'src' needs no
+    // alignment, shared by the load time conversion and the mix buses
+    //////////////////////////////////////////////////////////////////////////
+    template<typename T>
+    float SampleToFloat( const void* src );
+
+    template<>
+    inline float SampleToFloat<std::uint8_t>( const void* src )
+    {
+        return ( static_cast<float>( *static_cast<const std::uint8_t*>(src) ) - 128.0f ) * ( 1.0f / 128.0f );
+    }
+
+    template<>
+    inline float SampleToFloat<std::int16_t>( const void* src )
+    {
+        std::int16_t val;
+        memcpy(&val, src, sizeof(val));
+        return static_cast<float>(val) * ( 1.0f / 32768.0f );
+    }
+
+    template<>
+    inline float SampleToFloat<Packed24>( const void* src )
+    {
+        const auto* bytes = static_cast<const std::uint8_t*>(src);
+        const auto  val   = std::int32_t( std::uint32_t(bytes[0]) << 8 | std::uint32_t(bytes[1]) << 16 | std::uint32_t(bytes[2]) << 24 ) >> 8;
+        return static_cast<float>(val) * ( 1.0f / 8388608.0f );
+    }
+
+    template<>
+    inline float SampleToFloat<std::int32_t>( const void* src )
+    {
+        std::int32_t val;
+        memcpy(&val, src, sizeof(val));
+        return static_cast<float>( static_cast<double>(val) * ( 1.0 / 2147483648.0 ) );
+    }
+
+    template<>
+    inline float SampleToFloat<float>( const void* src )
+    {
+        float val;
+        memcpy(&val, src, sizeof(val));
+        return val;
+    }
+}
@@ -10,12 +10,17 @@ namespace Audio
 {
 
     AudioStreamBase::AudioStreamBase(const AudioBufferPtr& buffer, const AudioFormat& format)
-        : m_bufferPtr( buffer )
+        : AudioStreamBase( AudioMemory( buffer ), format )
+    {
+    }
+
+    AudioStreamBase::AudioStreamBase(const AudioMemory& memory, const AudioFormat& format)
+        : m_memory( memory )
         , m_format( format )       
         , m_bufPos( 0 )
         , m_looping(true)
     {
-        if ( buffer->empty() )
+        if ( memory.empty() )
             throw AudioException("Empty Audio Buffer");
      
     }
@@ -25,6 +30,13 @@ namespace Audio
 
     }
 
+    AudioStreamBase::AudioStreamBase(const AudioFormat& format)
+        : m_format( format )
+        , m_bufPos( 0 )
+        , m_looping( true )
+    {
+    }
+
     bool AudioStreamBase::seek(std::uint32_t sample)
     {
         std::uint32_t  idx = m_format.m_sampleRate * sample;
@@ -36,8 +48,8 @@ namespace Audio
 
     std::uint32_t AudioStreamBase::getData( void* dest, std::uint32_t numBytes )
     {
-        auto& audioBuf    = *m_bufferPtr;
-        auto bufSize      = (std::uint32_t)( audioBuf.size() );
+        const auto* audioBuf = m_memory.m_data;
+        auto bufSize      = (std::uint32_t)( m_memory.m_size );
         const auto* start = &audioBuf[0];
 
         assert( numBytes <= bufSize );
@@ -77,7 +89,12 @@ namespace Audio
 
     const AudioBufferPtr& AudioStreamBase::getBuffer() const
     {
-        return m_bufferPtr;
+        return m_memory.m_buffer;
+    }
+
+    const AudioMemory& AudioStreamBase::getMemory() const
+    {
+        return m_memory;
     }
 
     const AudioFormat& AudioStreamBase::getInternalFormat() const
@@ -88,7 +105,7 @@ namespace Audio
 
     std::uint32_t AudioStreamBase::getTotalSamples() const
     {
-        return static_cast<std::uint32_t>(m_bufferPtr->size()) / m_format.getBytesPerSample();
+        return static_cast<std::uint32_t>(m_memory.m_size) / m_format.getBytesPerSample();
     }
 
     bool AudioStreamBase::isLooping() const
@@ -15,6 +15,7 @@ namespace Audio
     public:
         AudioStreamBase();        
         AudioStreamBase( const AudioBufferPtr& buffer, const AudioFormat& format );
+        AudioStreamBase( const AudioMemory& memory, const AudioFormat& format );
         virtual ~AudioStreamBase() = default;
         
         virtual bool            seek( std::uint32_t sample );
@@ -22,27 +23,33 @@ namespace Audio
         virtual std::uint32_t   getSamplePos() const;              
 
 
-        const AudioBufferPtr&   getBuffer() const;
+        const AudioBufferPtr&   getBuffer() const; //empty if the asset is not an AudioBuffer
+        const AudioMemory&      getMemory() const;
         const AudioFormat&      getInternalFormat() const;
        
-        std::uint32_t           getTotalSamples() const;   
+        virtual std::uint32_t   getTotalSamples() const;   
 
         bool                    isLooping() const;
         void                    setLooping( bool val);
 
-        std::uint32_t           numBytesAvailable() const
+        virtual std::uint32_t   numBytesAvailable() const
         {
-            return static_cast<std::uint32_t>(m_bufferPtr->size()) - m_bufPos;
+            return static_cast<std::uint32_t>(m_memory.m_size) - m_bufPos;
         }
 
 
         
 
     protected:
+        /*
+            @brief: Streams without backing memory, e.g. live input
+        */
+        explicit AudioStreamBase( const AudioFormat& format );
+
        bool                     m_looping; //current loop iter
 
     private:       
-        AudioBufferPtr          m_bufferPtr; //shared with a sound resource
+        AudioMemory             m_memory; //shared with a sound resource
         AudioFormat             m_format;
         std::uint32_t           m_bufPos;          
        
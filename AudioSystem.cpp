@@ -1,6 +1,5 @@
 #include <chrono>
-#define MINI_AL_IMPLEMENTATION
-#include <al/mini_al.h>
+#include <thread>
 #include <Common/ReflectionRegister.h>
 #include <Common/Thread.h>
 #include <Math/GenMath.h>
@@ -21,7 +20,11 @@
 #include <Scene/AudioEmitterEntity.h>
 #include <Scene/AudioListenerEntity.h>
 
+#include "AudioBackendMiniAl.h"
+#include "AudioBackendNull.h"
+#include "AudioBus.h"
 #include "AudioException.h"
+#include "AudioMemoryStats.h"
 #include "AudioMixerDefault.h"
 #include "AudioSystem.h"
 
@@ -49,36 +52,34 @@ RTTR_REGISTRATION
     val.method("setListener", &AudioSystem::setListener);
     val.method("getListener", &AudioSystem::getListener);
     val.method("setMixer", &AudioSystem::setMixer);
+    val.method("setBackend", &AudioSystem::setBackend);
+    val.method("setSendEffect", &AudioSystem::setSendEffect);
+    val.method("getCaptureDevices", &AudioSystem::getCaptureDevices);
+    val.method("getMixPosition", &AudioSystem::getMixPosition);
+    val.method("scheduleAdd", &AudioSystem::scheduleAdd);
+    val.method("scheduleStart", &AudioSystem::scheduleStart);
+    val.method("scheduleStop", &AudioSystem::scheduleStop);
+    val.method("scheduleVolume", &AudioSystem::scheduleVolume);
+    val.method("setOcclusion", &AudioSystem::setOcclusion);
+    val.method("setSendLevel", &AudioSystem::setSendLevel);
+    val.method("getLatency", &AudioSystem::getLatency);
+    val.method("getPeriodSize", &AudioSystem::getPeriodSize);
+    val.method("getNumPeriods", &AudioSystem::getNumPeriods);
+    val.method("getNumXruns", &AudioSystem::getNumXruns);
+    val.method("getMixAheadStats", &AudioSystem::getMixAheadStats);
+    val.method("getMeterReading", &AudioSystem::getMeterReading);
+    val.method("getMemoryReport", &AudioSystem::getMemoryReport);
+    val.method("setPeriodSize", &AudioSystem::setPeriodSize);
 }
 
 namespace Audio
 {
     
-    void LogMessageOnFailAndThrow( Logger* logger, const std::string& msg, mal_result result)
+    namespace
     {
-        if ( MAL_SUCCESS != result )
-        {
-            logger->addMessage( msg.c_str(), LOG_LEVEL_ERROR );
-            throw AudioException( msg );
-        }
-    }
-
-    mal_uint32 onSendFramesToDevice( mal_device* pDevice, mal_uint32 sampleCount, void* pSamples )
-    {
-        auto* audioSys =  reinterpret_cast<AudioSystem*>(pDevice->pUserData);
-        return audioSys->updateAndMix(sampleCount, pSamples);
-    }
-
-    inline  void onDeviceStop( mal_device* devicePtr )
-    {
-        (devicePtr);
-    }    
-
-    void onAudiolog(mal_context* pContext, mal_device* pDevice, const char* message)
-    {
-        (void)pContext;
-        (void)pDevice;
-        printf("mini_al: %s\n", message);
+        constexpr std::uint32_t MIN_PERIOD_SIZE = 32;
+        constexpr float         XRUN_WINDOW     = 1.0f; //seconds the xrun rate is averaged over
+        constexpr std::uint32_t DEFAULT_MIX_AHEAD_CHUNK = 512; //if the backend doesn't report its period size
     }
 
 #pragma region pimpl
@@ -89,17 +90,22 @@ namespace Audio
     {
         friend class AudioSystem;
     public:
+        using Clock = std::chrono::steady_clock;
+
         pimpl(EngineContext* context)
-            : m_context(context)
+            : m_system( nullptr )
             , m_initialized(false)
             , m_running( false )
+            , m_numXruns( 0 )
+            , m_windowXruns( 0 )
+            , m_xrunWindow( 0.0f )
+            , m_context(context)
         {
         }
 
         ~pimpl()
         {
-            if( m_running )
-                shutDown();
+            shutDown();
         }
 
         bool start()
@@ -109,8 +115,21 @@ namespace Audio
             
             using namespace Log;
             const auto& logger = m_context->getSystem<Logger>();
+
+            //mixing ahead, the ring is primed before the backend asks for data
+            if (m_outputFormat.m_mixAheadPeriods)
+            {
+                if (!m_mixThread) {
+                    auto* audioSys = m_system;
+                    m_mixThread = std::make_unique<AudioMixThread>([audioSys](std::uint32_t numFrames, void* data) {
+                        return audioSys->updateAndMix(numFrames, data);
+                    }, m_outputFormat, getMixAheadChunk(), getMixAheadChunk() * m_outputFormat.m_mixAheadPeriods);
+                }
+                m_mixThread->start();
+            }
             
-            if (mal_device_start(&m_playBackDevice) != MAL_SUCCESS) {
+            m_lastCallback = Clock::time_point();
+            if (!m_backend->start()) {
                 logger->addMessage("Audio Device Failed", LOG_LEVEL_ERROR);
                 return false;
             }
@@ -121,74 +140,193 @@ namespace Audio
 
         void shutDown()
         {
-            if (!m_running)
+            if (!m_initialized)
                return;
 
-            mal_device_uninit(&m_playBackDevice);
-            mal_context_uninit(&m_audioContext);
+            m_backend->shutDown();
+            m_mixThread.reset();
+            m_meter.reset();
+            m_running     = false;
+            m_initialized = false;
+        }
+
+        /*
+            @brief: Backend thread
+        */
+        std::uint32_t onRender( std::uint32_t numFrames, void* data )
+        {
+            detectXrun();
+            if (m_mixThread)
+                return m_mixThread->read(numFrames, data);
+            return m_system->updateAndMix(numFrames, data);
+        }
+
+        /*
+            @brief: Backend thread. Every callback tops the device buffer up, if
+            the next one comes later than the whole buffer lasts the device ran dry
+        */
+        void detectXrun()
+        {
+            const auto now = Clock::now();
+            if (m_lastCallback != Clock::time_point() && now - m_lastCallback > m_bufferDuration)
+                m_numXruns.fetch_add(1, std::memory_order_relaxed);
+            m_lastCallback = now;
+        }
+
+        /*
+            @brief: Game thread, doubles the period size when the xrun rate
+            crosses the configured threshold
+        */
+        void checkXrunRate( float frameTime )
+        {
+            if (m_outputFormat.m_xrunThreshold <= 0.0f || !m_running)
+                return;
+
+            m_xrunWindow += frameTime;
+            if (m_xrunWindow < XRUN_WINDOW)
+                return;
+
+            const auto numXruns = m_numXruns.load(std::memory_order_relaxed);
+            const auto rate = (numXruns - m_windowXruns) / m_xrunWindow;
+            m_windowXruns = numXruns;
+            m_xrunWindow  = 0.0f;
+
+            const auto periodSize = getPeriodSize();
+            if (rate > m_outputFormat.m_xrunThreshold && periodSize < AUDIO_MIX_MAX_FRAMES)
+            {
+                const auto& logger = m_context->getSystem<Logger>();
+                logger->addMessage("Audio xrun rate " + std::to_string(rate) + "/s, growing period to " +
+                    std::to_string(periodSize * 2), LOG_LEVEL_INFO);
+                setPeriodSize(periodSize * 2);
+            }
+        }
+
+        /*
+            @brief: Game thread, reopens the output keeping the mixer state
+        */
+        bool setPeriodSize( std::uint32_t periodSize )
+        {
+            if (!m_initialized)
+                return false;
+
+            //the mixer renders a period in one pass
+            periodSize = std::min(std::max(periodSize, MIN_PERIOD_SIZE), AUDIO_MIX_MAX_FRAMES);
+            const bool wasRunning = m_running;
+
+            //the mix-ahead thread renders without the backend, stopped too so
+            //no voice is mixed while the output reopens
+            m_backend->stop();
+            if (m_mixThread)
+                m_mixThread->stop();
             m_running = false;
+
+            const auto result = m_backend->setPeriodSize(periodSize);
+            onOutputOpened();
+            if (m_mixThread)
+                m_mixThread->setHeadroom(getMixAheadChunk(), getMixAheadChunk() * m_outputFormat.m_mixAheadPeriods);
+            if (wasRunning)
+                start();
+            return result;
+        }
+
+        void onOutputOpened()
+        {
+            m_bufferDuration = std::chrono::duration<double>(getDeviceLatency());
+            m_lastCallback   = Clock::time_point();
+
+            const auto& logger = m_context->getSystem<Logger>();
+            logger->addMessage(std::string("Audio Backend: ") + m_backend->getName() + ", Period: " + std::to_string(getPeriodSize()) +
+                " x " + std::to_string(getNumPeriods()) + ", Latency: " + std::to_string(getLatency() * 1000.0f) + " ms", LOG_LEVEL_INFO);
+        }
+
+        float getDeviceLatency() const
+        {
+            const auto sampleRate = m_initialized ? m_backend->getSampleRate() : 0;
+            if (!sampleRate)
+                return 0.0f;
+            return getPeriodSize() * getNumPeriods() / static_cast<float>(sampleRate);
+        }
+
+        /*
+            @brief: Device buffer plus the headroom rendered ahead of it
+        */
+        float getLatency() const
+        {
+            auto latency = getDeviceLatency();
+            if (m_mixThread)
+                latency += m_mixThread->getHeadroom() / static_cast<float>(m_outputFormat.m_sampleRate);
+            return latency;
+        }
+
+        std::uint32_t getMixAheadChunk() const
+        {
+            const auto periodSize = getPeriodSize();
+            return periodSize ? periodSize : DEFAULT_MIX_AHEAD_CHUNK;
+        }
+
+        std::uint32_t getPeriodSize() const
+        {
+            return m_initialized ? m_backend->getPeriodSize() : 0;
         }
 
-        bool initialize( const AudioConfig& config )
+        std::uint32_t getNumPeriods() const
+        {
+            return m_initialized ? m_backend->getNumPeriods() : 0;
+        }
+
+        bool initialize( const AudioDeviceConfig& config )
         {
             m_outputFormat = config;
             const auto& logger   = m_context->getSystem<Logger>();
-            const auto& audioSys = m_context->getSystem<AudioSystem>();
+            m_system = m_context->getSystem<AudioSystem>();
                  
             logger->addMessage("Initializing Audio System", LOG_LEVEL_INFO );
             logger->addMessage("Audio Thread Id: " + std::to_string(Common::GetThreadId()));
 
-            //init context  config
-            m_audioContextConfig = mal_context_config_init(onAudiolog);
-
-            //determine send callback
-            mal_send_proc sendCb = onSendFramesToDevice;
-
-            //init device
-            m_audioDeviceConfig = mal_device_config_init_playback((mal_format)m_outputFormat.m_format,
-                m_outputFormat.m_channels, m_outputFormat.m_sampleRate, sendCb );
-            m_audioDeviceConfig.onStopCallback = onDeviceStop;
+            if (!m_backend)
+                m_backend = std::make_shared<BackendMiniAl>(m_context);
 
-            LogMessageOnFailAndThrow(logger, "mal_context_init",        mal_context_init(nullptr, 0, &m_audioContextConfig, &m_audioContext));
-            LogMessageOnFailAndThrow(logger, "mal_context_get_devices", mal_context_get_devices( &m_audioContext, &m_playbackDeviceInfos, &m_playbackDeviceCount,
-                &m_captureDeviceInfos, &m_captureDeviceCount));
+            if (config.m_flags & AUDIO_METERING) {
+                m_meter = std::make_unique<AudioMeter>(config);
+                m_meter->start();
+            }
 
-            //print device names
-            for (mal_uint32 i = 0; i < m_playbackDeviceCount; ++i) {
-                std::string deviceName = m_playbackDeviceInfos[i].name;
-                std::string msg = "Audio Device: " + std::to_string(i) + " " + deviceName;
-                logger->addMessage(msg.c_str(), (int)eLogLevel::LOG_LEVEL_INFO);
+            const auto render = [this](std::uint32_t numFrames, void* data) {
+                return onRender(numFrames, data);
+            };
+            if (!m_backend->initialize(config, render))
+            {
+                m_backend->shutDown();
+                if (!(config.m_flags & AUDIO_NULL_FALLBACK))
+                    throw AudioException(std::string("Audio Backend Failed: ") + m_backend->getName());
+
+                logger->addMessage(std::string("Audio Backend Failed: ") + m_backend->getName() + ", using null backend", LOG_LEVEL_INFO);
+                m_backend = std::make_shared<BackendNull>();
+                m_backend->initialize(config, render);
             }
 
-            //init sound generation
-            void* soundGen = audioSys;
-            
-            //init playback
-            LogMessageOnFailAndThrow(logger, "mal_device_init failed",
-                mal_device_init(nullptr, mal_device_type_playback, nullptr, &m_audioDeviceConfig, soundGen, &m_playBackDevice));
-            m_initialized = true;                
+            m_initialized = true;
+            onOutputOpened();
             logger->addMessage("Audio System Initialized", LOG_LEVEL_SUCCES );
             return m_initialized;
         }
+        AudioSystem*        m_system;
         bool                m_initialized;
         std::atomic<bool>   m_running;
 
-        mal_sine_wave       m_sineWave;       
-        mal_context         m_audioContext;
-        mal_context_config  m_audioContextConfig;
-
-        mal_decoder         m_decoder;
+        //xrun detection
+        std::atomic<std::uint32_t>      m_numXruns;
+        Clock::time_point               m_lastCallback;     //backend thread only
+        std::chrono::duration<double>   m_bufferDuration;
+        std::uint32_t                   m_windowXruns;      //m_numXruns when the window started
+        float                           m_xrunWindow;       //seconds
 
-        mal_device_info*    m_playbackDeviceInfos;
-        mal_uint32          m_playbackDeviceCount;
+        std::unique_ptr<AudioMixThread> m_mixThread;    //only when mixing ahead
+        std::unique_ptr<AudioMeter>     m_meter;        //only with AUDIO_METERING
+        AudioBackendBasePtr             m_backend;
+        AudioEffectBasePtr              m_sendEffect;
 
-        mal_device_info*    m_captureDeviceInfos;
-        mal_uint32          m_captureDeviceCount;
-
-        mal_device_config   m_audioDeviceConfig;
-        mal_device          m_playBackDevice;
-
-        AudioConfig         m_outputFormat;   
+        AudioDeviceConfig   m_outputFormat;   
         EngineContext*      m_context;
     };
 #pragma endregion
@@ -200,10 +338,16 @@ namespace Audio
     //////////////////////////////////////////////////////////////////////////
     AudioSystem::AudioSystem(EngineContext* context)
         : SystemBase(context)
+        , m_mixEpoch( 0 )
+        , m_numScheduledEvents( 0 )
+        , m_numReservedEvents( 0 )
+        , m_mixPosition( 0 )
+        , m_totalAudioTime( 0.0f )
         , m_impl(  std::make_unique<AudioSystem::pimpl>(context))       
         , m_mixer( std::make_shared<MixerDefault>(context))
-        , m_totalAudioTime( 0.0f )
     {
+        m_voices.reserve(MAX_VOICES);
+        m_mixVoices.reserve(MAX_VOICES);
         
         subscribeToEvent(CreateEventHandler( this, &AudioSystem::onAudioUpdate, "AUDIO_UPDATE"));
     }
@@ -214,12 +358,14 @@ namespace Audio
     }
 
 
-    bool AudioSystem::initialize(const AudioConfig& config)
+    bool AudioSystem::initialize(const AudioDeviceConfig& config)
     {
         assert(config.m_format == eAudioFormat::audio_format_f32);
         
         if (!m_mixer)
             throw AudioException("No Mixer Specified!");
+        if (m_impl->m_sendEffect && !m_mixer->setSendEffect(m_impl->m_sendEffect))
+            throw AudioException("Mixer Has No Send Bus");
 
         return m_mixer->initialize( config ) && 
                m_impl->initialize( config );              
@@ -239,17 +385,19 @@ namespace Audio
     ActiveAudioVector AudioSystem::getActiveSoundsLocked() const
     {
         LockGuard lock( m_modifyActiveSoundsMutex );
-        ActiveAudioVector result;
-        result.reserve(m_activeSounds.size());
-        for (const auto& as : m_activeSounds)
-            result.emplace_back(as);
-        return result;
+        return m_voices.getVoices().m_sources;
     }
 
     bool AudioSystem::removeAllAudioSourcesLocked()
     {
-        LockGuard lock(m_modifyActiveSoundsMutex);
-        m_activeSounds.clear();
+        std::uint64_t command = 0;
+        {
+            LockGuard lock(m_modifyActiveSoundsMutex);
+            m_voices.clear();
+            pushVoiceCommand(VOICE_COMMAND_CLEAR, nullptr, VoiceHandle());
+            command = m_numPushedCommands;
+        }
+        waitForVoiceRemoval(command);
         return true;
     }
 
@@ -269,59 +417,434 @@ namespace Audio
         m_mixer = mixer;
     }
 
+    void AudioSystem::setBackend(const AudioBackendBasePtr& backend)
+    {
+        if (m_impl->m_initialized)
+            throw AudioException("Audio Backend Already Initialized");
+        m_impl->m_backend = backend;
+    }
+
+    AudioBackendBasePtr AudioSystem::getBackend() const
+    {
+        return m_impl->m_backend;
+    }
+
+    void AudioSystem::setSendEffect(const AudioEffectBasePtr& effect)
+    {
+        if (m_impl->m_initialized)
+            throw AudioException("Audio Mixer Already Initialized");
+        m_impl->m_sendEffect = effect;
+    }
+
+    AudioEffectBasePtr AudioSystem::getSendEffect() const
+    {
+        return m_impl->m_sendEffect;
+    }
+
+    std::vector<std::string> AudioSystem::getCaptureDevices() const
+    {
+        return m_impl->m_backend ? m_impl->m_backend->getCaptureDevices() : std::vector<std::string>();
+    }
+
+    AudioCapturePtr AudioSystem::createCapture(const AudioDeviceConfig& format, std::uint32_t device)
+    {
+        return m_impl->m_backend ? m_impl->m_backend->createCapture(format, device) : nullptr;
+    }
+
     bool AudioSystem::addAudioSourceLocked( AudioSource* audio )
     {
         LockGuard lock(m_modifyActiveSoundsMutex);
-        if (containsAudioSource(audio))
+        if (!audio || !IsBusFormat(audio->getAudioFormat()) || m_voices.size() >= MAX_VOICES)
+            return false;
+        const auto voice = m_voices.add(audio);
+        if (!voice.isValid())
             return false;
-        m_activeSounds.insert(audio);
+        pushVoiceCommand(VOICE_COMMAND_ADD, audio, voice);
         return true;
     }
 
     bool AudioSystem::removeAudioSourceLocked( AudioSource* audio )
     {
-        LockGuard lock(m_modifyActiveSoundsMutex);
-        if (!containsAudioSource(audio))
-            return false;      
-        audio->pause();
-        m_activeSounds.erase(audio);
+        std::uint64_t command = 0;
+        {
+            LockGuard lock(m_modifyActiveSoundsMutex);
+            const auto voice = m_voices.getHandle(audio);
+            if (!voice.isValid())
+                return false;
+            audio->pause();
+            m_voices.remove(voice);
+            pushVoiceCommand(VOICE_COMMAND_REMOVE, audio, voice);
+            command = m_numPushedCommands;
+        }
+        //other game side callers may go on while the audio thread catches up
+        waitForVoiceRemoval(command);
         return true;
     }
 
+    float AudioSystem::getLatency() const
+    {
+        return m_impl->getLatency();
+    }
+
+    std::uint32_t AudioSystem::getPeriodSize() const
+    {
+        return m_impl->getPeriodSize();
+    }
+
+    std::uint32_t AudioSystem::getNumPeriods() const
+    {
+        return m_impl->getNumPeriods();
+    }
+
+    std::uint32_t AudioSystem::getNumXruns() const
+    {
+        return m_impl->m_numXruns.load(std::memory_order_relaxed);
+    }
+
+    AudioMixAheadStats AudioSystem::getMixAheadStats()
+    {
+        return m_impl->m_mixThread ? m_impl->m_mixThread->getStats() : AudioMixAheadStats();
+    }
+
+    AudioMeterReading AudioSystem::getMeterReading() const
+    {
+        return m_impl->m_meter ? m_impl->m_meter->getReading() : AudioMeterReading();
+    }
+
+    std::string AudioSystem::getMemoryReport() const
+    {
+        return GetAudioMemoryReport();
+    }
+
+    bool AudioSystem::setPeriodSize(std::uint32_t periodSize)
+    {
+        return m_impl->setPeriodSize(periodSize);
+    }
+
     void AudioSystem::onAudioUpdate(Engine::Event& evt)
     {
         auto frameTime = evt.getValue<float>("AUDIO_TIME_STEP");
-        for (const auto& it : m_activeSounds)
+        m_impl->checkXrunRate(frameTime);
+        //copy the mirror so sources may add or remove voices from their update,
+        //the lock is only shared with other game side callers
+        {
+            LockGuard lock(m_modifyActiveSoundsMutex);
+            flushVoiceCommands();
+            m_updateSources = m_voices.getVoices().m_sources;
+        }
+        for (const auto& it : m_updateSources)
             it->onAudioUpdate(frameTime);
         m_totalAudioTime += frameTime;
     }
 
     std::uint32_t AudioSystem::updateAndMix(std::uint32_t numSamples, void* data)
     {
-        //create a copy of current active sounds & work with that
-        auto aav = getActiveSoundsLocked();
-        if (!m_mixer->updateActiveSounds( aav ) )
+        //seq_cst pairs with the fence in 'waitForVoiceRemoval', either the game
+        //side sees the odd epoch or we see its remove command
+        m_mixEpoch.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        applyVoiceCommands();
+
+        auto& voices = m_mixVoices.getVoices();
+        const auto blockStart = m_mixPosition.load(std::memory_order_relaxed);
+        const auto frameSize  = m_impl->m_outputFormat.getBytesPerSample();
+        std::uint32_t result = 0;
+        if (m_mixer->updateActiveSounds( voices ) )
+        {
+            //split the block at every scheduled event
+            std::uint32_t offset = 0;
+            while (offset < numSamples)
+            {
+                applyScheduledEvents(blockStart + offset);
+                auto end = numSamples;
+                if (m_numScheduledEvents && m_scheduledEvents[0].m_time < blockStart + numSamples)
+                    end = static_cast<std::uint32_t>(m_scheduledEvents[0].m_time - blockStart);
+
+                //the mixer leaves the output untouched if nothing played
+                auto* segment = static_cast<char*>(data) + std::size_t(offset) * frameSize;
+                const auto numMixed = std::min(m_mixer->mixIncomingSounds( voices, end - offset, segment ), end - offset);
+                if (numMixed < end - offset)
+                    memset(segment + std::size_t(numMixed) * frameSize, 0, std::size_t(end - offset - numMixed) * frameSize);
+                offset = end;
+            }
+            result = numSamples;
+
+            //metered on its own thread, only copied here
+            if (m_impl->m_meter)
+                m_impl->m_meter->push(data, numSamples);
+        }
+
+        m_mixPosition.store(blockStart + numSamples, std::memory_order_release);
+        m_mixEpoch.fetch_add(1, std::memory_order_release);
+        return result;
+    }
+
+    std::uint64_t AudioSystem::getMixPosition() const
+    {
+        return m_mixPosition.load(std::memory_order_acquire);
+    }
+
+    bool AudioSystem::scheduleAdd(AudioSource* audio, std::uint64_t sampleTime)
+    {
+        LockGuard lock(m_modifyActiveSoundsMutex);
+        if (!audio || !IsBusFormat(audio->getAudioFormat()) || m_voices.size() >= MAX_VOICES || m_voices.contains(audio) || !reserveScheduledEvent())
+            return false;
+        const auto voice = m_voices.add(audio);
+        pushVoiceCommand(VOICE_COMMAND_ADD_HELD, audio, voice, sampleTime);
+        return true;
+    }
+
+    bool AudioSystem::scheduleStart(AudioSource* audio, std::uint64_t sampleTime)
+    {
+        return scheduleVoiceCommand(VOICE_COMMAND_START, audio, sampleTime, 0.0f);
+    }
+
+    bool AudioSystem::scheduleStop(AudioSource* audio, std::uint64_t sampleTime)
+    {
+        return scheduleVoiceCommand(VOICE_COMMAND_STOP, audio, sampleTime, 0.0f);
+    }
+
+    bool AudioSystem::scheduleVolume(AudioSource* audio, std::uint64_t sampleTime, float volume)
+    {
+        return scheduleVoiceCommand(VOICE_COMMAND_VOLUME, audio, sampleTime, volume);
+    }
+
+    bool AudioSystem::setOcclusion(AudioSource* audio, float occlusion)
+    {
+        return scheduleVoiceCommand(VOICE_COMMAND_OCCLUSION, audio, 0, occlusion);
+    }
+
+    bool AudioSystem::setSendLevel(AudioSource* audio, float level)
+    {
+        return scheduleVoiceCommand(VOICE_COMMAND_SEND, audio, 0, level);
+    }
+
+    bool AudioSystem::scheduleVoiceCommand(eVoiceCommand type, AudioSource* source, std::uint64_t time, float value)
+    {
+        LockGuard lock(m_modifyActiveSoundsMutex);
+        const auto voice = m_voices.getHandle(source);
+        if (!voice.isValid())
+            return false;
+
+        //occlusion & send apply on arrival, the others wait in the event queue
+        const bool isEvent = type != VOICE_COMMAND_OCCLUSION && type != VOICE_COMMAND_SEND;
+        if (isEvent && !reserveScheduledEvent())
+            return false;
+        pushVoiceCommand(type, source, voice, time, value);
+        return true;
+    }
+
+    bool AudioSystem::reserveScheduledEvent()
+    {
+        //only taken under 'm_modifyActiveSoundsMutex', the audio thread only releases
+        if (m_numReservedEvents.load(std::memory_order_relaxed) >= MAX_SCHEDULED_EVENTS)
             return false;
-        return m_mixer->mixIncomingSounds( aav, numSamples, data );
+        m_numReservedEvents.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool AudioSystem::pushVoiceCommand(eVoiceCommand type, AudioSource* source, VoiceHandle voice, std::uint64_t time, float value)
+    {
+        VoiceCommand cmd;
+        cmd.m_type   = type;
+        cmd.m_source = source;
+        cmd.m_voice  = voice;
+        cmd.m_time   = time;
+        cmd.m_value  = value;
+        m_pendingCommands.push_back(cmd);
+        ++m_numPushedCommands;
+        return flushVoiceCommands();
+    }
+
+    bool AudioSystem::flushVoiceCommands()
+    {
+        while (!m_pendingCommands.empty() && m_voiceCommands.freeBytes() >= sizeof(VoiceCommand)) {
+            m_voiceCommands.writeData(&m_pendingCommands.front(), sizeof(VoiceCommand));
+            m_pendingCommands.pop_front();
+            ++m_numFlushedCommands;
+        }
+        return m_pendingCommands.empty();
+    }
+
+    void AudioSystem::waitForVoiceRemoval(std::uint64_t command)
+    {
+        //a full queue only drains while the device runs, if it doesn't the
+        //audio thread isn't touching any voice either. The lock is only held
+        //for each retry, commands queued after ours don't hold us back
+        for (;;)
+        {
+            {
+                LockGuard lock(m_modifyActiveSoundsMutex);
+                flushVoiceCommands();
+                if (m_numFlushedCommands >= command || !m_impl->m_running)
+                    break;
+            }
+            std::this_thread::yield();
+        }
+
+        //a mix in flight may have started before the command was queued, the
+        //next one applies it before touching any voice
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const auto epoch = m_mixEpoch.load();
+        if (epoch & 1) {
+            while (m_mixEpoch.load(std::memory_order_acquire) == epoch)
+                std::this_thread::yield();
+        }
+    }
+
+    void AudioSystem::applyVoiceCommands()
+    {
+        //voices are looked up by the handle of the game side, the table is
+        //reserved for 'MAX_VOICES' so nothing here allocates
+        VoiceCommand cmd;
+        while (m_voiceCommands.readData(&cmd, sizeof(cmd)) == sizeof(cmd))
+        {
+            switch (cmd.m_type)
+            {
+            case VOICE_COMMAND_ADD:
+            {
+                const auto voice = m_mixVoices.add(cmd.m_source);
+                assert(voice == cmd.m_voice);
+                (void)voice;
+                break;
+            }
+            case VOICE_COMMAND_ADD_HELD:
+            {
+                //held from the block it arrives in, its start releases it
+                const auto voice = m_mixVoices.add(cmd.m_source);
+                assert(voice == cmd.m_voice);
+                const auto index = m_mixVoices.getIndex(voice);
+                if (index != ~0u)
+                    m_mixVoices.getVoices().m_flags[index] |= VOICE_FLAG_HELD;
+                auto start = cmd;
+                start.m_type = VOICE_COMMAND_START;
+                insertScheduledEvent(start, voice);
+                break;
+            }
+            case VOICE_COMMAND_REMOVE:
+                dropScheduledEvents(cmd.m_voice);
+                m_mixVoices.remove(cmd.m_voice);
+                break;
+            case VOICE_COMMAND_CLEAR:
+                m_mixVoices.clear();
+                m_numReservedEvents.fetch_sub(m_numScheduledEvents, std::memory_order_relaxed);
+                m_numScheduledEvents = 0;
+                break;
+            case VOICE_COMMAND_OCCLUSION:
+            {
+                //not scheduled, the filter smooths the change
+                const auto index = m_mixVoices.getIndex(cmd.m_voice);
+                if (index != ~0u)
+                    m_mixVoices.getVoices().m_occlusions[index] = cmd.m_value;
+                break;
+            }
+            case VOICE_COMMAND_SEND:
+            {
+                const auto index = m_mixVoices.getIndex(cmd.m_voice);
+                if (index != ~0u)
+                    m_mixVoices.getVoices().m_sends[index] = cmd.m_value;
+                break;
+            }
+            default:
+                //nothing changes before the event fires, a playing voice
+                //keeps playing until then
+                insertScheduledEvent(cmd, cmd.m_voice);
+                break;
+            }
+        }
+    }
+
+    void AudioSystem::insertScheduledEvent(const VoiceCommand& cmd, VoiceHandle voice)
+    {
+        //can't happen while every event was reserved, dropped rather than grown
+        if (m_numScheduledEvents == MAX_SCHEDULED_EVENTS) {
+            m_numReservedEvents.fetch_sub(1, std::memory_order_relaxed);
+            return;
+        }
+
+        ScheduledEvent evt;
+        evt.m_time  = cmd.m_time;
+        evt.m_type  = cmd.m_type;
+        evt.m_voice = voice;
+        evt.m_value = cmd.m_value;
+
+        //after events of the same time, so they apply in submission order
+        auto* first = m_scheduledEvents.data();
+        auto* last  = first + m_numScheduledEvents;
+        auto* it = std::upper_bound(first, last, evt.m_time,
+            [](std::uint64_t time, const ScheduledEvent& rhs) { return time < rhs.m_time; });
+        std::move_backward(it, last, last + 1);
+        *it = evt;
+        ++m_numScheduledEvents;
+    }
+
+    void AudioSystem::dropScheduledEvents(VoiceHandle voice)
+    {
+        if (!voice.isValid())
+            return;
+
+        auto* first = m_scheduledEvents.data();
+        auto* last  = first + m_numScheduledEvents;
+        auto* end = std::remove_if(first, last, [voice](const ScheduledEvent& evt) { return evt.m_voice == voice; });
+        const auto numDropped = static_cast<std::uint32_t>(last - end);
+        m_numScheduledEvents -= numDropped;
+        m_numReservedEvents.fetch_sub(numDropped, std::memory_order_relaxed);
+    }
+
+    void AudioSystem::applyScheduledEvents(std::uint64_t time)
+    {
+        auto& voices = m_mixVoices.getVoices();
+        auto* first = m_scheduledEvents.data();
+        auto* last  = first + m_numScheduledEvents;
+        auto* it = first;
+        for (; it != last && it->m_time <= time; ++it)
+        {
+            //stale if the voice was removed meanwhile
+            const auto index = m_mixVoices.getIndex(it->m_voice);
+            if (index == ~0u)
+                continue;
+
+            switch (it->m_type)
+            {
+            case VOICE_COMMAND_START:
+                voices.m_flags[index] &= ~VOICE_FLAG_HELD;
+                break;
+            case VOICE_COMMAND_STOP:
+                voices.m_flags[index] |= VOICE_FLAG_HELD;
+                break;
+            case VOICE_COMMAND_VOLUME:
+                voices.m_volumes[index] = it->m_value;
+                break;
+            }
+        }
+        const auto numApplied = static_cast<std::uint32_t>(it - first);
+        std::move(it, last, first);
+        m_numScheduledEvents -= numApplied;
+        m_numReservedEvents.fetch_sub(numApplied, std::memory_order_relaxed);
     }
 
     void AudioSystem::shutDown()
     {
         LockGuard lock(m_modifyActiveSoundsMutex);
-        m_activeSounds.clear();
+        m_impl->shutDown();
+        m_voices.clear();
+        m_pendingCommands.clear();
+        m_numFlushedCommands = m_numPushedCommands;
+        m_voiceCommands.reset();
+        m_mixVoices.clear();
+        m_numScheduledEvents = 0;
+        m_numReservedEvents.store(0, std::memory_order_relaxed);
     }
 
     bool AudioSystem::containsAudioSource(AudioSource* audio)
     {
-        auto it = m_activeSounds.find(audio);
-        return std::end(m_activeSounds) != it;
+        return m_voices.contains(audio);
     }
 
     bool AudioSystem::containsAudioSourceLocked(AudioSource* audio)
     {
         LockGuard lock(m_modifyActiveSoundsMutex);
-        auto it = m_activeSounds.find(audio);
-        return std::end(m_activeSounds) != it;
+        return m_voices.contains(audio);
     }
 
 }
\ No newline at end of file
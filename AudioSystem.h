@@ -1,12 +1,24 @@
 #pragma once
+#include <array>
+#include <atomic>
+#include <deque>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <Common/Thread.h>
 #include <Engine/SystemBase.h>
 #include <Components/AudioListenerComponentFwd.h>
 
+#include "AudioBackendBasePtr.h"
+#include "AudioCapturePtr.h"
 #include "AudioConfig.h"
+#include "AudioEffectBasePtr.h"
+#include "AudioMeter.h"
 #include "AudioMixerBasePtr.h"
+#include "AudioMixThread.h"
+#include "AudioRingBuffer.h"
+#include "AudioVoiceTable.h"
 
 namespace Audio
 {
@@ -31,7 +43,28 @@ namespace Audio
         //\Brief: Explicitly set mixer, must happen before 'init' call
         //////////////////////////////////////////////////////////////////////////
         void                    setMixer( const AudioMixerBasePtr& mixer );
-        bool                    initialize( const AudioConfig& config = GetDefaultAudioConfig() );
+
+        //////////////////////////////////////////////////////////////////////////
+        //\Brief: Explicitly set output backend, must happen before 'init' call.
+        // Defaults to the mini_al device backend
+        //////////////////////////////////////////////////////////////////////////
+        void                    setBackend( const AudioBackendBasePtr& backend );
+        AudioBackendBasePtr     getBackend() const;
+
+        //////////////////////////////////////////////////////////////////////////
+        //\Brief: Explicitly set the effect on the mixer's send bus, e.g. a
+        // reverb shared by every source, must happen before 'init' call
+        //////////////////////////////////////////////////////////////////////////
+        void                    setSendEffect( const AudioEffectBasePtr& effect );
+        AudioEffectBasePtr      getSendEffect() const;
+
+        //////////////////////////////////////////////////////////////////////////
+        //\Brief: Input devices of the backend, play captured audio through a
+        // CaptureAudioStream
+        //////////////////////////////////////////////////////////////////////////
+        std::vector<std::string>    getCaptureDevices() const;
+        AudioCapturePtr             createCapture( const AudioDeviceConfig& format, std::uint32_t device = 0 );
+        bool                    initialize( const AudioDeviceConfig& config = GetDefaultAudioConfig() );
         bool                    start();
 
         void                    setListener( AudioListener* listener );
@@ -46,7 +79,40 @@ namespace Audio
         Common::Mutex&          getSoundComponentMutex() const;
 
         //////////////////////////////////////////////////////////////////////////
-        //\Brief: Stream in new data
+        //\Brief: Device buffering as negotiated with the backend, which may
+        // differ from the requested config
+        //////////////////////////////////////////////////////////////////////////
+        float                   getLatency() const;
+        std::uint32_t           getPeriodSize() const;
+        std::uint32_t           getNumPeriods() const;
+        std::uint32_t           getNumXruns() const;
+
+        /*
+            @brief: Output ring counters when mixing ahead, all zero otherwise.
+            Resets the minimum fill
+        */
+        AudioMixAheadStats      getMixAheadStats();
+
+        /*
+            @brief: Latest meter reading of the output, needs AUDIO_METERING.
+            Lock free, safe to poll from UI & telemetry every frame
+        */
+        AudioMeterReading       getMeterReading() const;
+
+        /*
+            @brief: See GetAudioMemoryReport
+        */
+        std::string             getMemoryReport() const;
+
+        /*
+            @brief: Reopens the device with 'periodSize' frames per period, the
+            mixer & voices are kept. Game thread only
+        */
+        bool                    setPeriodSize( std::uint32_t periodSize );
+
+        //////////////////////////////////////////////////////////////////////////
+        //\Brief: Stream in new data, game thread only. Works on the game side
+        // mirror of the voice table, the audio thread is never waited on
         //////////////////////////////////////////////////////////////////////////
         void                    onAudioUpdate(Engine::Event& evt);
 
@@ -55,13 +121,156 @@ namespace Audio
         //////////////////////////////////////////////////////////////////////////
         std::uint32_t           updateAndMix( std::uint32_t numSamples, void* data );
 
+        //////////////////////////////////////////////////////////////////////////
+        //\Brief: Sample accurate scheduling on the output timeline. Times are
+        // absolute frames as counted by 'getMixPosition', the mixed block is
+        // split at every event. Events in the past apply at the start of the
+        // next block. Sources must have been added, game thread only. At most
+        // 'MAX_SCHEDULED_EVENTS' events wait at a time, scheduling more fails
+        //////////////////////////////////////////////////////////////////////////
+        std::uint64_t           getMixPosition() const;
+
+        /*
+            @brief: Adds the source held back until 'sampleTime'. Unlike adding
+            and then scheduling the start it never plays a block early
+        */
+        bool                    scheduleAdd( AudioSource* audio, std::uint64_t sampleTime );
+
+        /*
+            @brief: Releases a source held by 'scheduleAdd' or 'scheduleStop' at
+            'sampleTime', a playing source is left alone
+        */
+        bool                    scheduleStart( AudioSource* audio, std::uint64_t sampleTime );
+
+        /*
+            @brief: Holds the source back from 'sampleTime' on, it stays in the
+            voice table without consuming data
+        */
+        bool                    scheduleStop( AudioSource* audio, std::uint64_t sampleTime );
+
+        /*
+            @brief: Volume on top of the source attenuation from 'sampleTime' on
+        */
+        bool                    scheduleVolume( AudioSource* audio, std::uint64_t sampleTime, float volume );
+
+        /*
+            @brief: Low-pass occlusion of a source, 0 open to 1 fully occluded.
+            Applies from the next block, the filter glides to it. Game thread only
+        */
+        bool                    setOcclusion( AudioSource* audio, float occlusion );
+
+        /*
+            @brief: Level the source feeds the send effect with, 0 keeps it dry.
+            Applies from the next block. Game thread only
+        */
+        bool                    setSendLevel( AudioSource* audio, float level );
+
     private:
+        enum eVoiceCommand : std::uint32_t
+        {
+            VOICE_COMMAND_ADD,
+            VOICE_COMMAND_ADD_HELD,
+            VOICE_COMMAND_REMOVE,
+            VOICE_COMMAND_CLEAR,
+            VOICE_COMMAND_START,
+            VOICE_COMMAND_STOP,
+            VOICE_COMMAND_VOLUME,
+            VOICE_COMMAND_OCCLUSION,
+            VOICE_COMMAND_SEND
+        };
+
+        //////////////////////////////////////////////////////////////////////////
+        //\Brief: Change to the voice table, replayed by the audio thread on its
+        // own copy in the order it was made on the game side. Both tables see
+        // the same adds & removes so 'm_voice' is valid on either. 'm_time'
+        // and 'm_value' are only used by scheduled commands. Aligned so the
+        // size is a power of two on every platform
+        //////////////////////////////////////////////////////////////////////////
+        struct alignas(16) VoiceCommand
+        {
+            std::uint32_t       m_type;
+            float               m_value;
+            AudioSource*        m_source;
+            std::uint64_t       m_time;
+            VoiceHandle         m_voice;
+        };
+
+        //////////////////////////////////////////////////////////////////////////
+        //\Brief: Scheduled command waiting for its time, audio thread only
+        //////////////////////////////////////////////////////////////////////////
+        struct ScheduledEvent
+        {
+            std::uint64_t       m_time;
+            std::uint32_t       m_type;
+            VoiceHandle         m_voice;
+            float               m_value;
+        };
+
+        static constexpr int            VOICE_COMMAND_QUEUE_SIZE = 16384;
+        static constexpr std::uint32_t  MAX_VOICES               = 1024; //held without allocating on the audio thread, adding more fails
+        static constexpr std::uint32_t  MAX_SCHEDULED_EVENTS     = 256;
+        static_assert(VOICE_COMMAND_QUEUE_SIZE % sizeof(VoiceCommand) == 0, "VoiceCommand must not straddle the queue wrap point");
 
         void                    shutDown();
         bool                    containsAudioSource(AudioSource* audio);
 
-        mutable Common::Mutex   m_modifyActiveSoundsMutex;
-        ActiveAudioSet          m_activeSounds;
+        /*
+            @brief: Game side, queue a command for the audio thread. Commands the
+            queue can't hold yet stay pending and are retried on the next push or
+            update. Returns false if commands are still pending
+        */
+        bool                    pushVoiceCommand( eVoiceCommand type, AudioSource* source, VoiceHandle voice, std::uint64_t time = 0, float value = 0.0f );
+        bool                    scheduleVoiceCommand( eVoiceCommand type, AudioSource* source, std::uint64_t time, float value );
+        bool                    flushVoiceCommands();
+
+        /*
+            @brief: Game side, takes a slot of the event queue before a scheduled
+            command is queued, so the audio thread never runs out. False if full
+        */
+        bool                    reserveScheduledEvent();
+
+        /*
+            @brief: Game side, called without the lock. Returns once the queued
+            command 'command' was handed to the audio thread and that can no
+            longer reference a removed source
+        */
+        void                    waitForVoiceRemoval( std::uint64_t command );
+
+        /*
+            @brief: Audio thread, replay queued commands on 'm_mixVoices'
+        */
+        void                    applyVoiceCommands();
+
+        /*
+            @brief: Audio thread, apply scheduled events due at 'time'
+        */
+        void                    applyScheduledEvents( std::uint64_t time );
+
+        /*
+            @brief: Audio thread, queue a scheduled command in time order. The
+            slot was reserved on the game side
+        */
+        void                    insertScheduledEvent( const VoiceCommand& cmd, VoiceHandle voice );
+
+        /*
+            @brief: Audio thread, drops the events of a removed voice
+        */
+        void                    dropScheduledEvents( VoiceHandle voice );
+
+        mutable Common::Mutex   m_modifyActiveSoundsMutex;  //game side only, never taken by the audio thread
+        AudioVoiceTable         m_voices;                   //game side mirror, guarded by m_modifyActiveSoundsMutex
+        ActiveAudioVector       m_updateSources;            //onAudioUpdate copy of the mirror sources
+        std::deque<VoiceCommand> m_pendingCommands;         //guarded by m_modifyActiveSoundsMutex
+        std::uint64_t           m_numPushedCommands  = 0;   //guarded by m_modifyActiveSoundsMutex
+        std::uint64_t           m_numFlushedCommands = 0;   //guarded by m_modifyActiveSoundsMutex
+
+        AudioRingBuffer<VOICE_COMMAND_QUEUE_SIZE>   m_voiceCommands;    //game side -> audio thread
+        AudioVoiceTable                             m_mixVoices;        //audio thread only
+        std::atomic<std::uint32_t>                  m_mixEpoch;         //odd while the audio thread mixes
+        std::array<ScheduledEvent, MAX_SCHEDULED_EVENTS> m_scheduledEvents; //audio thread only, sorted by time
+        std::uint32_t                               m_numScheduledEvents; //audio thread only
+        std::atomic<std::uint32_t>                  m_numReservedEvents;  //queued or waiting, taken by the game side
+        std::atomic<std::uint64_t>                  m_mixPosition;      //frames mixed so far
         float                   m_totalAudioTime;
 
         class pimpl;
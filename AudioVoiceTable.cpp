@@ -0,0 +1,185 @@
+#include <algorithm>
+
+#include "AudioVoiceTable.h"
+
+namespace Audio
+{
+    namespace
+    {
+        constexpr std::uint32_t NO_VOICE = ~0u;
+
+        template<typename T>
+        void RemoveSwap(std::vector<T>& vec, std::uint32_t index)
+        {
+            vec[index] = vec.back();
+            vec.pop_back();
+        }
+    }
+
+    void AudioVoiceList::clear()
+    {
+        m_sources.clear();
+        m_formats.clear();
+        m_resamplers.clear();
+        m_gains.clear();
+        m_pans.clear();
+        m_volumes.clear();
+        m_occlusions.clear();
+        m_filters.clear();
+        m_sends.clear();
+        m_flags.clear();
+        m_handles.clear();
+    }
+
+    void AudioVoiceList::reserve(std::uint32_t numVoices)
+    {
+        m_sources.reserve(numVoices);
+        m_formats.reserve(numVoices);
+        m_resamplers.reserve(numVoices);
+        m_gains.reserve(numVoices);
+        m_pans.reserve(numVoices);
+        m_volumes.reserve(numVoices);
+        m_occlusions.reserve(numVoices);
+        m_filters.reserve(numVoices);
+        m_sends.reserve(numVoices);
+        m_flags.reserve(numVoices);
+        m_handles.reserve(numVoices);
+    }
+
+    VoiceHandle AudioVoiceTable::add(AudioSource* source)
+    {
+        if (!source || find(source) != NO_VOICE)
+            return VoiceHandle();
+
+        std::uint32_t index;
+        if (!m_freeSlots.empty()) {
+            index = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        }
+        else {
+            index = static_cast<std::uint32_t>(m_slots.size());
+            m_slots.push_back({ NO_VOICE, 0 });
+        }
+
+        auto& slot = m_slots[index];
+        slot.m_generation++;
+        slot.m_denseIndex = m_voices.size();
+
+        VoiceHandle handle;
+        handle.m_index      = index;
+        handle.m_generation = slot.m_generation;
+
+        m_voices.m_sources.push_back(source);
+        m_voices.m_formats.push_back(AudioConfig());
+        m_voices.m_resamplers.push_back(AudioResampleState());
+        m_voices.m_gains.push_back(1.0f);
+        m_voices.m_pans.push_back(0.0f);
+        m_voices.m_volumes.push_back(1.0f);
+        m_voices.m_occlusions.push_back(0.0f);
+        m_voices.m_filters.push_back(AudioFilterState());
+        m_voices.m_sends.push_back(0.0f);
+        m_voices.m_flags.push_back(VOICE_FLAG_NONE);
+        m_voices.m_handles.push_back(handle);
+        return handle;
+    }
+
+    bool AudioVoiceTable::remove(VoiceHandle handle)
+    {
+        const auto denseIndex = getIndex(handle);
+        if (denseIndex == NO_VOICE)
+            return false;
+
+        //move the last voice into the hole
+        const auto last = m_voices.size() - 1;
+        if (denseIndex != last)
+            m_slots[m_voices.m_handles[last].m_index].m_denseIndex = denseIndex;
+
+        RemoveSwap(m_voices.m_sources, denseIndex);
+        RemoveSwap(m_voices.m_formats, denseIndex);
+        RemoveSwap(m_voices.m_resamplers, denseIndex);
+        RemoveSwap(m_voices.m_gains,   denseIndex);
+        RemoveSwap(m_voices.m_pans,    denseIndex);
+        RemoveSwap(m_voices.m_volumes, denseIndex);
+        RemoveSwap(m_voices.m_occlusions, denseIndex);
+        RemoveSwap(m_voices.m_filters, denseIndex);
+        RemoveSwap(m_voices.m_sends, denseIndex);
+        RemoveSwap(m_voices.m_flags,   denseIndex);
+        RemoveSwap(m_voices.m_handles, denseIndex);
+
+        auto& slot = m_slots[handle.m_index];
+        slot.m_generation++;
+        slot.m_denseIndex = NO_VOICE;
+        m_freeSlots.push_back(handle.m_index);
+        return true;
+    }
+
+    bool AudioVoiceTable::remove(AudioSource* source)
+    {
+        return remove(getHandle(source));
+    }
+
+    void AudioVoiceTable::clear()
+    {
+        for (const auto& handle : m_voices.m_handles) {
+            auto& slot = m_slots[handle.m_index];
+            slot.m_generation++;
+            slot.m_denseIndex = NO_VOICE;
+            m_freeSlots.push_back(handle.m_index);
+        }
+        m_voices.clear();
+    }
+
+    void AudioVoiceTable::reserve(std::uint32_t numVoices)
+    {
+        m_voices.reserve(numVoices);
+        m_slots.reserve(numVoices);
+        m_freeSlots.reserve(numVoices);
+    }
+
+    bool AudioVoiceTable::contains(VoiceHandle handle) const
+    {
+        return getIndex(handle) != NO_VOICE;
+    }
+
+    bool AudioVoiceTable::contains(AudioSource* source) const
+    {
+        return find(source) != NO_VOICE;
+    }
+
+    VoiceHandle AudioVoiceTable::getHandle(AudioSource* source) const
+    {
+        const auto denseIndex = find(source);
+        return denseIndex != NO_VOICE ? m_voices.m_handles[denseIndex] : VoiceHandle();
+    }
+
+    std::uint32_t AudioVoiceTable::getIndex(VoiceHandle handle) const
+    {
+        if (!handle.isValid() || handle.m_index >= m_slots.size())
+            return NO_VOICE;
+
+        const auto& slot = m_slots[handle.m_index];
+        return slot.m_generation == handle.m_generation ? slot.m_denseIndex : NO_VOICE;
+    }
+
+    std::uint32_t AudioVoiceTable::find(AudioSource* source) const
+    {
+        const auto& sources = m_voices.m_sources;
+        const auto it = std::find(std::begin(sources), std::end(sources), source);
+        return it != std::end(sources) ? static_cast<std::uint32_t>(it - std::begin(sources)) : NO_VOICE;
+    }
+
+    std::uint32_t AudioVoiceTable::size() const
+    {
+        return m_voices.size();
+    }
+
+    const AudioVoiceList& AudioVoiceTable::getVoices() const
+    {
+        return m_voices;
+    }
+
+    AudioVoiceList& AudioVoiceTable::getVoices()
+    {
+        return m_voices;
+    }
+}
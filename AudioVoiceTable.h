@@ -0,0 +1,108 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "AudioConfig.h"
+#include "AudioFilterBank.h"
+
+namespace Audio
+{
+    enum eVoiceFlags : std::uint32_t
+    {
+        VOICE_FLAG_NONE       = 0x0,
+        VOICE_FLAG_PLAYING    = 0x01,
+        VOICE_FLAG_NO_PANNING = 0x02,
+        VOICE_FLAG_HELD       = 0x04  //held back by the scheduler, owned by AudioSystem & kept by mixers
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Generation checked reference to a voice, stays invalid once the
+    // voice is removed even if its slot is reused
+    //////////////////////////////////////////////////////////////////////////
+    struct VoiceHandle
+    {
+        bool                isValid() const { return m_generation != 0; }
+        bool                operator==(const VoiceHandle& rhs) const { return m_index == rhs.m_index && m_generation == rhs.m_generation; }
+        bool                operator!=(const VoiceHandle& rhs) const { return !(*this == rhs); }
+
+        std::uint32_t       m_index      = 0;
+        std::uint32_t       m_generation = 0; //0 is never handed out
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Dense per voice state in SoA layout, entry i of every array
+    // belongs to the same voice. Order is arbitrary but stable between
+    // adds and removes
+    //////////////////////////////////////////////////////////////////////////
+    struct AudioVoiceList
+    {
+        std::uint32_t               size() const { return static_cast<std::uint32_t>(m_sources.size()); }
+        bool                        empty() const { return m_sources.empty(); }
+        void                        clear();
+        void                        reserve( std::uint32_t numVoices );
+
+        std::vector<AudioSource*>   m_sources;  //read through 'consume', the source owns the stream position
+        std::vector<AudioConfig>    m_formats;  //input format of the stream
+        std::vector<AudioResampleState> m_resamplers; //input to output rate, advanced by the mixer
+        std::vector<float>          m_gains;    //attenuation
+        std::vector<float>          m_pans;     //-1 left, 1 right
+        std::vector<float>          m_volumes;  //scheduled volume, on top of the gain
+        std::vector<float>          m_occlusions; //0 open, 1 fully occluded
+        std::vector<AudioFilterState> m_filters; //occlusion filter, advanced by the mixer
+        std::vector<float>          m_sends;    //send bus level, 0 dry only
+        std::vector<std::uint32_t>  m_flags;    //eVoiceFlags
+        std::vector<VoiceHandle>    m_handles;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Slot map of active voices. Add and remove by handle are O(1),
+    // removal moves the last voice into the hole so the voice list stays
+    // dense and is iterated linearly. Lookups by source scan the dense list
+    //////////////////////////////////////////////////////////////////////////
+    class AudioVoiceTable
+    {
+    public:
+        AudioVoiceTable() = default;
+
+        /*
+            @brief: Returns an invalid handle if 'source' is already in the table
+        */
+        VoiceHandle                 add( AudioSource* source );
+        bool                        remove( VoiceHandle handle );
+        bool                        remove( AudioSource* source );
+        void                        clear();
+
+        /*
+            @brief: Preallocates room for 'numVoices', so adding up to that
+            many voices does not grow the arrays
+        */
+        void                        reserve( std::uint32_t numVoices );
+
+        bool                        contains( VoiceHandle handle ) const;
+        bool                        contains( AudioSource* source ) const;
+        VoiceHandle                 getHandle( AudioSource* source ) const;
+
+        /*
+            @brief: Dense index of a live voice into the voice list, ~0u if the
+            handle is stale
+        */
+        std::uint32_t               getIndex( VoiceHandle handle ) const;
+
+        std::uint32_t               size() const;
+        const AudioVoiceList&       getVoices() const;
+        AudioVoiceList&             getVoices();
+
+    private:
+        struct Slot
+        {
+            std::uint32_t           m_denseIndex;
+            std::uint32_t           m_generation; //odd while the slot is in use
+        };
+
+        std::uint32_t               find( AudioSource* source ) const;
+
+        AudioVoiceList              m_voices;
+        std::vector<Slot>           m_slots;    //indexed by VoiceHandle::m_index
+        std::vector<std::uint32_t>  m_freeSlots;
+    };
+}
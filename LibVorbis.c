@@ -128,6 +128,12 @@
 //     you'd ever want to do it except for debugging.
 // #define STB_VORBIS_NO_DEFER_FLOOR
 
+// STB_VORBIS_NO_SIMD
+//     On x86/x64 the inverse MDCT butterflies use SSE2, or AVX when the CPU
+//     and OS support it, selected at runtime. Define this to always use the
+//     scalar C loops.
+// #define STB_VORBIS_NO_SIMD
+
 
 
 
@@ -203,6 +209,18 @@
    #endif
 #endif
 
+#if !defined(STB_VORBIS_NO_SIMD) && (defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+   #define STB_VORBIS_SSE2
+   #include <emmintrin.h>
+   #include <immintrin.h>
+   #if defined(_MSC_VER) && !defined(__clang__)
+      #include <intrin.h>
+      #define STBV_TARGET_AVX
+   #else
+      #define STBV_TARGET_AVX   __attribute__((target("avx")))
+   #endif
+#endif
+
 #if STB_VORBIS_MAX_CHANNELS > 256
 #error "Value of STB_VORBIS_MAX_CHANNELS outside of allowed range"
 #endif
@@ -413,6 +431,11 @@ struct stb_vorbis
    Mapping *mapping;
    int mode_count;
    Mode mode_config[64];  // varies
+   int longest_floorlist;
+
+   // non-zero if the header tables above (and the twiddle/window/bit-reverse
+   // tables below) are borrowed from another decoder and must not be freed
+   uint8 shared_setup;
 
    uint32 total_samples;
 
@@ -1191,18 +1214,36 @@ static uint32 get_bits(vorb *f, int n)
 // expand the buffer to as many bits as possible without reading off end of packet
 // it might be nice to allow f->valid_bits and f->acc to be stored in registers,
 // e.g. cache them locally and decode locally
+static void prep_huffman_slow(vorb *f)
+{
+   do {
+      int z;
+      if (f->last_seg && !f->bytes_in_seg) return;
+      z = get8_packet_raw(f);
+      if (z == EOP) return;
+      f->acc += (unsigned) z << f->valid_bits;
+      f->valid_bits += 8;
+   } while (f->valid_bits <= 24);
+}
+
 static __forceinline void prep_huffman(vorb *f)
 {
    if (f->valid_bits <= 24) {
+      // fast path: when every byte needed to fill the accumulator is in the
+      // current segment, take them straight from memory instead of going
+      // through get8_packet_raw() one byte at a time
+      int n = (32 - f->valid_bits) >> 3;
       if (f->valid_bits == 0) f->acc = 0;
-      do {
-         int z;
-         if (f->last_seg && !f->bytes_in_seg) return;
-         z = get8_packet_raw(f);
-         if (z == EOP) return;
-         f->acc += (unsigned) z << f->valid_bits;
-         f->valid_bits += 8;
-      } while (f->valid_bits <= 24);
+      if (USE_MEMORY(f) && n <= f->bytes_in_seg && f->stream + n <= f->stream_end) {
+         f->bytes_in_seg -= n;
+         f->packet_bytes += n;
+         do {
+            f->acc += (unsigned) *f->stream++ << f->valid_bits;
+            f->valid_bits += 8;
+         } while (--n);
+      } else {
+         prep_huffman_slow(f);
+      }
    }
 }
 
@@ -1422,6 +1463,39 @@ static int codebook_decode_step(vorb *f, Codebook *c, float *output, int len, in
    return TRUE;
 }
 
+// adds one non-sequence VQ vector to the interleaved outputs, returns the new
+// channel index. stereo with both channels present is the common residue 2
+// case, so it steps through channel pairs without the per-element branches
+static __forceinline int codebook_accumulate_vector(Codebook *c, float **outputs, int ch, int c_inter, int *p_inter_p, int z, int effective, float last)
+{
+   int i = 0, p_inter = *p_inter_p;
+   if (ch == 2 && outputs[0] && outputs[1]) {
+      float *o0 = outputs[0], *o1 = outputs[1];
+      if (c_inter == 1 && effective > 0) {
+         o1[p_inter++] += CODEBOOK_ELEMENT_FAST(c,z) + last;
+         c_inter = 0;
+         i = 1;
+      }
+      for (; i+1 < effective; i += 2, ++p_inter) {
+         o0[p_inter] += CODEBOOK_ELEMENT_FAST(c,z+i  ) + last;
+         o1[p_inter] += CODEBOOK_ELEMENT_FAST(c,z+i+1) + last;
+      }
+      if (i < effective) {
+         o0[p_inter] += CODEBOOK_ELEMENT_FAST(c,z+i) + last;
+         c_inter = 1;
+      }
+   } else {
+      for (; i < effective; ++i) {
+         float val = CODEBOOK_ELEMENT_FAST(c,z+i) + last;
+         if (outputs[c_inter])
+            outputs[c_inter][p_inter] += val;
+         if (++c_inter == ch) { c_inter = 0; ++p_inter; }
+      }
+   }
+   *p_inter_p = p_inter;
+   return c_inter;
+}
+
 static int codebook_decode_deinterleave_repeat(vorb *f, Codebook *c, float **outputs, int ch, int *c_inter_p, int *p_inter_p, int len, int total_decode)
 {
    int c_inter = *c_inter_p;
@@ -1476,12 +1550,7 @@ static int codebook_decode_deinterleave_repeat(vorb *f, Codebook *c, float **out
                last = val;
             }
          } else {
-            for (i=0; i < effective; ++i) {
-               float val = CODEBOOK_ELEMENT_FAST(c,z+i) + last;
-               if (outputs[c_inter])
-                  outputs[c_inter][p_inter] += val;
-               if (++c_inter == ch) { c_inter = 0; ++p_inter; }
-            }
+            c_inter = codebook_accumulate_vector(c, outputs, ch, c_inter, &p_inter, z, effective, last);
          }
       }
 
@@ -1581,8 +1650,10 @@ static float inverse_db_table[256] =
 // have to divide in the setup? sigh.
 #ifndef STB_VORBIS_NO_DEFER_FLOOR
 #define LINE_OP(a,b)   a *= b
+#define LINE_OP_SSE2(p,v)   _mm_storeu_ps(p, _mm_mul_ps(_mm_loadu_ps(p), v))
 #else
 #define LINE_OP(a,b)   a = b
+#define LINE_OP_SSE2(p,v)   _mm_storeu_ps(p, v)
 #endif
 
 #ifdef STB_VORBIS_DIVIDE_TABLE
@@ -1591,6 +1662,65 @@ static float inverse_db_table[256] =
 int8 integer_divide_table[DIVTAB_NUMER][DIVTAB_DENOM]; // 2KB
 #endif
 
+#ifdef STB_VORBIS_SSE2
+// renders [x,x1) of a line four samples at a time. after 'k' steps the
+// bresenham error has carried floor(k*ady/adx) times, so advancing all four
+// lanes by four steps is a fixed slope plus at most one extra carry per lane,
+// which replaces the data-dependent branch with a compare. y still indexes
+// inverse_db_table one lane at a time, so the result is the same table value
+// and the same single multiply per sample as the scalar loop
+static void draw_line_sse2(float *output, int x, int x1, int y, int base, int sy, int ady, int adx)
+{
+   int k, err = 0, carry4 = (4*ady) / adx;
+   int lane_y[4], lane_err[4];
+   __m128i vy, verr;
+   const __m128i vadx      = _mm_set1_epi32(adx);
+   const __m128i vadx_m1   = _mm_set1_epi32(adx-1);
+   const __m128i vrem4     = _mm_set1_epi32(4*ady - carry4*adx);
+   const __m128i vstep4    = _mm_set1_epi32(4*base + carry4*(sy-base));
+   const __m128i vcarry    = _mm_set1_epi32(sy-base);
+
+   for (k=0; k < 4; ++k) {
+      lane_y[k] = y;
+      lane_err[k] = err;
+      err += ady;
+      if (err >= adx) {
+         err -= adx;
+         y += sy;
+      } else
+         y += base;
+   }
+   vy   = _mm_loadu_si128((__m128i *) lane_y);
+   verr = _mm_loadu_si128((__m128i *) lane_err);
+
+   for (; x+4 <= x1; x += 4) {
+      __m128i carry;
+      _mm_storeu_si128((__m128i *) lane_y, vy);
+      LINE_OP_SSE2(output+x, _mm_set_ps(inverse_db_table[lane_y[3]], inverse_db_table[lane_y[2]],
+                                        inverse_db_table[lane_y[1]], inverse_db_table[lane_y[0]]));
+      verr  = _mm_add_epi32(verr, vrem4);
+      carry = _mm_cmpgt_epi32(verr, vadx_m1);
+      verr  = _mm_sub_epi32(verr, _mm_and_si128(carry, vadx));
+      vy    = _mm_add_epi32(vy, _mm_add_epi32(vstep4, _mm_and_si128(carry, vcarry)));
+   }
+
+   // lane 0 now holds the state of the first sample not drawn yet
+   _mm_storeu_si128((__m128i *) lane_y, vy);
+   _mm_storeu_si128((__m128i *) lane_err, verr);
+   y = lane_y[0];
+   err = lane_err[0];
+   for (; x < x1; ++x) {
+      LINE_OP(output[x], inverse_db_table[y]);
+      err += ady;
+      if (err >= adx) {
+         err -= adx;
+         y += sy;
+      } else
+         y += base;
+   }
+}
+#endif
+
 static __forceinline void draw_line(float *output, int x0, int y0, int x1, int y1, int n)
 {
    int dy = y1 - y0;
@@ -1626,6 +1756,12 @@ static __forceinline void draw_line(float *output, int x0, int y0, int x1, int y
 #endif
    ady -= abs(base) * adx;
    if (x1 > n) x1 = n;
+#ifdef STB_VORBIS_SSE2
+   if (x1 - x >= 8 && stb_vorbis_get_simd_level() != STB_VORBIS_SIMD_NONE) {
+      draw_line_sse2(output, x, x1, y, base, sy, ady, adx);
+      return;
+   }
+#endif
    if (x < x1) {
       LINE_OP(output[x], inverse_db_table[y]);
       for (++x; x < x1; ++x) {
@@ -2222,6 +2358,259 @@ static void imdct_step3_inner_s_loop_ld654(int n, float *e, int i_off, float *A,
    }
 }
 
+#ifdef STB_VORBIS_SSE2
+// SIMD versions of the step 3 kernels above. A vector holds a run of
+// consecutive floats [-3..0] (or [-7..0]) of a block; each adjacent lane pair
+// is one complex butterfly, lane 2k holding the 'k11' and lane 2k+1 the 'k00'
+// term. The twiddle product is written as k*Ar + swap(k)*Ai with the sign of
+// the imaginary part folded into Ai, which rounds exactly like the scalar
+// expressions as long as the compiler does not contract them into FMAs.
+
+static __forceinline __m128 imdct_sign_mask_sse2(int s0, int s1, int s2, int s3)
+{
+   return _mm_castsi128_ps(_mm_setr_epi32(s0 ? 0x80000000 : 0, s1 ? 0x80000000 : 0, s2 ? 0x80000000 : 0, s3 ? 0x80000000 : 0));
+}
+
+// loads the twiddle pairs 'p_lo' (for lanes 0,1) and 'p_hi' (for lanes 2,3)
+static __forceinline void imdct_twiddle_sse2(const float *p_lo, const float *p_hi, __m128 sign, __m128 *ar, __m128 *ai)
+{
+   __m128 t = _mm_castpd_ps(_mm_loadh_pd(_mm_load_sd((const double *) p_lo), (const double *) p_hi));
+   *ar = _mm_shuffle_ps(t, t, _MM_SHUFFLE(2,2,0,0));
+   *ai = _mm_xor_ps(_mm_shuffle_ps(t, t, _MM_SHUFFLE(3,3,1,1)), sign);
+}
+
+static __forceinline __m128 imdct_rotate_sse2(__m128 k, __m128 ar, __m128 ai)
+{
+   return _mm_add_ps(_mm_mul_ps(k, ar), _mm_mul_ps(_mm_shuffle_ps(k, k, _MM_SHUFFLE(2,3,0,1)), ai));
+}
+
+static void imdct_step3_inner_r_loop_sse2(int lim, float *e, int d0, int k_off, float *A, int k1)
+{
+   __m128 sign = imdct_sign_mask_sse2(0,1,0,1);
+   float *e0 = e + d0;
+   float *e2 = e0 + k_off;
+   int i;
+
+   for (i=lim >> 2; i > 0; --i) {
+      __m128 ar_hi, ai_hi, ar_lo, ai_lo;
+      __m128 a_hi = _mm_loadu_ps(e0 - 3), a_lo = _mm_loadu_ps(e0 - 7);
+      __m128 b_hi = _mm_loadu_ps(e2 - 3), b_lo = _mm_loadu_ps(e2 - 7);
+      __m128 k_hi = _mm_sub_ps(a_hi, b_hi), k_lo = _mm_sub_ps(a_lo, b_lo);
+      imdct_twiddle_sse2(A + k1, A, sign, &ar_hi, &ai_hi);
+      imdct_twiddle_sse2(A + k1*3, A + k1*2, sign, &ar_lo, &ai_lo);
+      _mm_storeu_ps(e0 - 3, _mm_add_ps(a_hi, b_hi));
+      _mm_storeu_ps(e0 - 7, _mm_add_ps(a_lo, b_lo));
+      _mm_storeu_ps(e2 - 3, imdct_rotate_sse2(k_hi, ar_hi, ai_hi));
+      _mm_storeu_ps(e2 - 7, imdct_rotate_sse2(k_lo, ar_lo, ai_lo));
+      e0 -= 8;
+      e2 -= 8;
+      A += k1*4;
+   }
+}
+
+static void imdct_step3_iter0_loop_sse2(int n, float *e, int i_off, int k_off, float *A)
+{
+   assert((n & 3) == 0);
+   imdct_step3_inner_r_loop_sse2(n, e, i_off, k_off, A, 8);
+}
+
+static void imdct_step3_inner_s_loop_sse2(int n, float *e, int i_off, int k_off, float *A, int a_off, int k0)
+{
+   __m128 sign = imdct_sign_mask_sse2(0,1,0,1);
+   __m128 ar_hi, ai_hi, ar_lo, ai_lo;
+   float *ee0 = e  +i_off;
+   float *ee2 = ee0+k_off;
+   int i;
+
+   imdct_twiddle_sse2(A + a_off, A, sign, &ar_hi, &ai_hi);
+   imdct_twiddle_sse2(A + a_off*3, A + a_off*2, sign, &ar_lo, &ai_lo);
+
+   for (i=n; i > 0; --i) {
+      __m128 a_hi = _mm_loadu_ps(ee0 - 3), a_lo = _mm_loadu_ps(ee0 - 7);
+      __m128 b_hi = _mm_loadu_ps(ee2 - 3), b_lo = _mm_loadu_ps(ee2 - 7);
+      __m128 k_hi = _mm_sub_ps(a_hi, b_hi), k_lo = _mm_sub_ps(a_lo, b_lo);
+      _mm_storeu_ps(ee0 - 3, _mm_add_ps(a_hi, b_hi));
+      _mm_storeu_ps(ee0 - 7, _mm_add_ps(a_lo, b_lo));
+      _mm_storeu_ps(ee2 - 3, imdct_rotate_sse2(k_hi, ar_hi, ai_hi));
+      _mm_storeu_ps(ee2 - 7, imdct_rotate_sse2(k_lo, ar_lo, ai_lo));
+      ee0 -= k0;
+      ee2 -= k0;
+   }
+}
+
+// iter_54() on z[-7..0], hi = z[-3..0], lo = z[-7..-4]
+static __forceinline void iter_54_sse2(__m128 *hi, __m128 *lo)
+{
+   __m128 y = _mm_add_ps(*hi, *lo);   // y3 y2 y1 y0
+   __m128 k = _mm_sub_ps(*hi, *lo);   // k33 k22 k11 k00
+   *hi = _mm_add_ps(_mm_shuffle_ps(y, y, _MM_SHUFFLE(3,2,3,2)),
+                    _mm_xor_ps(_mm_shuffle_ps(y, y, _MM_SHUFFLE(1,0,1,0)), imdct_sign_mask_sse2(1,1,0,0)));
+   *lo = _mm_add_ps(_mm_shuffle_ps(k, k, _MM_SHUFFLE(3,2,3,2)),
+                    _mm_xor_ps(_mm_shuffle_ps(k, k, _MM_SHUFFLE(0,1,0,1)), imdct_sign_mask_sse2(0,1,1,0)));
+}
+
+static void imdct_step3_inner_s_loop_ld654_sse2(int n, float *e, int i_off, float *A, int base_n)
+{
+   int a_off = base_n >> 3;
+   __m128 A2 = _mm_set1_ps(A[0+a_off]);
+   __m128 sign = imdct_sign_mask_sse2(1,0,1,0);
+   float *z = e + i_off;
+   float *base = z - 16 * n;
+
+   while (z > base) {
+      __m128 h0 = _mm_loadu_ps(z -  3), h1 = _mm_loadu_ps(z -  7);
+      __m128 l0 = _mm_loadu_ps(z - 11), l1 = _mm_loadu_ps(z - 15);
+      __m128 d0 = _mm_sub_ps(h0, l0);   // d3 d2 d1 d0
+      __m128 d1 = _mm_sub_ps(h1, l1);   // d7 d6 d5 d4
+      __m128 s0 = _mm_shuffle_ps(d0, d0, _MM_SHUFFLE(2,3,0,1));
+      __m128 s1 = _mm_shuffle_ps(d1, d1, _MM_SHUFFLE(2,3,0,1));
+      __m128 t;
+
+      h0 = _mm_add_ps(h0, l0);
+      h1 = _mm_add_ps(h1, l1);
+
+      // (d3-d2)*A2, (d2+d3)*A2, d1, d0
+      t  = _mm_mul_ps(_mm_move_ss(_mm_add_ps(d0, s0), _mm_sub_ps(d0, s0)), A2);
+      l0 = _mm_shuffle_ps(t, d0, _MM_SHUFFLE(3,2,1,0));
+
+      // -(d6+d7)*A2, (d7-d6)*A2, -d4, d5
+      t  = _mm_mul_ps(_mm_move_ss(_mm_sub_ps(s1, d1), _mm_add_ps(d1, s1)), A2);
+      l1 = _mm_xor_ps(_mm_shuffle_ps(t, s1, _MM_SHUFFLE(3,2,1,0)), sign);
+
+      iter_54_sse2(&h0, &h1);
+      iter_54_sse2(&l0, &l1);
+
+      _mm_storeu_ps(z -  3, h0);
+      _mm_storeu_ps(z -  7, h1);
+      _mm_storeu_ps(z - 11, l0);
+      _mm_storeu_ps(z - 15, l1);
+      z -= 16;
+   }
+}
+
+// AVX versions process a whole [-7..0] run in one register
+static STBV_TARGET_AVX __forceinline __m256 imdct_rotate_avx(__m256 k, __m256 ar, __m256 ai)
+{
+   return _mm256_add_ps(_mm256_mul_ps(k, ar), _mm256_mul_ps(_mm256_permute_ps(k, _MM_SHUFFLE(2,3,0,1)), ai));
+}
+
+static STBV_TARGET_AVX __forceinline void imdct_twiddle_avx(const float *p0, const float *p1, const float *p2, const float *p3, __m256 *ar, __m256 *ai)
+{
+   // lanes 0,1 use pair p3 ... lanes 6,7 use pair p0
+   __m128 lo = _mm_castpd_ps(_mm_loadh_pd(_mm_load_sd((const double *) p3), (const double *) p2));
+   __m128 hi = _mm_castpd_ps(_mm_loadh_pd(_mm_load_sd((const double *) p1), (const double *) p0));
+   __m256 t  = _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+   __m256 sign = _mm256_castsi256_ps(_mm256_setr_epi32(0, 0x80000000, 0, 0x80000000, 0, 0x80000000, 0, 0x80000000));
+   *ar = _mm256_permute_ps(t, _MM_SHUFFLE(2,2,0,0));
+   *ai = _mm256_xor_ps(_mm256_permute_ps(t, _MM_SHUFFLE(3,3,1,1)), sign);
+}
+
+static STBV_TARGET_AVX void imdct_step3_inner_r_loop_avx(int lim, float *e, int d0, int k_off, float *A, int k1)
+{
+   float *e0 = e + d0;
+   float *e2 = e0 + k_off;
+   int i;
+
+   for (i=lim >> 2; i > 0; --i) {
+      __m256 ar, ai;
+      __m256 a = _mm256_loadu_ps(e0 - 7);
+      __m256 b = _mm256_loadu_ps(e2 - 7);
+      __m256 k = _mm256_sub_ps(a, b);
+      imdct_twiddle_avx(A, A + k1, A + k1*2, A + k1*3, &ar, &ai);
+      _mm256_storeu_ps(e0 - 7, _mm256_add_ps(a, b));
+      _mm256_storeu_ps(e2 - 7, imdct_rotate_avx(k, ar, ai));
+      e0 -= 8;
+      e2 -= 8;
+      A += k1*4;
+   }
+}
+
+static STBV_TARGET_AVX void imdct_step3_iter0_loop_avx(int n, float *e, int i_off, int k_off, float *A)
+{
+   assert((n & 3) == 0);
+   imdct_step3_inner_r_loop_avx(n, e, i_off, k_off, A, 8);
+}
+
+static STBV_TARGET_AVX void imdct_step3_inner_s_loop_avx(int n, float *e, int i_off, int k_off, float *A, int a_off, int k0)
+{
+   __m256 ar, ai;
+   float *ee0 = e  +i_off;
+   float *ee2 = ee0+k_off;
+   int i;
+
+   imdct_twiddle_avx(A, A + a_off, A + a_off*2, A + a_off*3, &ar, &ai);
+
+   for (i=n; i > 0; --i) {
+      __m256 a = _mm256_loadu_ps(ee0 - 7);
+      __m256 b = _mm256_loadu_ps(ee2 - 7);
+      __m256 k = _mm256_sub_ps(a, b);
+      _mm256_storeu_ps(ee0 - 7, _mm256_add_ps(a, b));
+      _mm256_storeu_ps(ee2 - 7, imdct_rotate_avx(k, ar, ai));
+      ee0 -= k0;
+      ee2 -= k0;
+   }
+}
+
+static int stbv_cpu_has_avx(void)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+   int info[4];
+   __cpuid(info, 1);
+   // AVX and OSXSAVE, then check the OS saves the ymm state
+   if ((info[2] & (1 << 28)) == 0 || (info[2] & (1 << 27)) == 0) return FALSE;
+   return (_xgetbv(0) & 6) == 6;
+#else
+   __builtin_cpu_init();
+   return __builtin_cpu_supports("avx");
+#endif
+}
+#endif // STB_VORBIS_SSE2
+
+typedef struct
+{
+   void (*iter0_loop)(int n, float *e, int i_off, int k_off, float *A);
+   void (*inner_r_loop)(int lim, float *e, int d0, int k_off, float *A, int k1);
+   void (*inner_s_loop)(int n, float *e, int i_off, int k_off, float *A, int a_off, int k0);
+   void (*inner_s_loop_ld654)(int n, float *e, int i_off, float *A, int base_n);
+} imdct_kernels;
+
+static const imdct_kernels imdct_kernels_by_level[] =
+{
+   { imdct_step3_iter0_loop, imdct_step3_inner_r_loop, imdct_step3_inner_s_loop, imdct_step3_inner_s_loop_ld654 },
+#ifdef STB_VORBIS_SSE2
+   { imdct_step3_iter0_loop_sse2, imdct_step3_inner_r_loop_sse2, imdct_step3_inner_s_loop_sse2, imdct_step3_inner_s_loop_ld654_sse2 },
+   { imdct_step3_iter0_loop_avx,  imdct_step3_inner_r_loop_avx,  imdct_step3_inner_s_loop_avx,  imdct_step3_inner_s_loop_ld654_sse2 },
+#endif
+};
+
+// -1 until the first decoder picks the best supported level; like crc_table,
+// racing initializations all store the same value
+static int imdct_simd_level = -1;
+
+static int simd_level_supported(void)
+{
+#ifdef STB_VORBIS_SSE2
+   return stbv_cpu_has_avx() ? STB_VORBIS_SIMD_AVX : STB_VORBIS_SIMD_SSE2;
+#else
+   return STB_VORBIS_SIMD_NONE;
+#endif
+}
+
+int stb_vorbis_set_simd_level(int level)
+{
+   int supported = simd_level_supported();
+   if (level < STB_VORBIS_SIMD_NONE) level = STB_VORBIS_SIMD_NONE;
+   imdct_simd_level = level > supported ? supported : level;
+   return imdct_simd_level;
+}
+
+int stb_vorbis_get_simd_level(void)
+{
+   if (imdct_simd_level < 0)
+      imdct_simd_level = simd_level_supported();
+   return imdct_simd_level;
+}
+
 static void inverse_mdct(float *buffer, int n, vorb *f, int blocktype)
 {
    int n2 = n >> 1, n4 = n >> 2, n8 = n >> 3, l;
@@ -2232,6 +2621,7 @@ static void inverse_mdct(float *buffer, int n, vorb *f, int blocktype)
    float *u=NULL,*v=NULL;
    // twiddle factors
    float *A = f->A[blocktype];
+   const imdct_kernels *kernels = &imdct_kernels_by_level[stb_vorbis_get_simd_level()];
 
    // IMDCT algorithm from "The use of multirate filter banks for coding of high quality digital audio"
    // See notes about bugs in that paper in less-optimal implementation 'inverse_mdct_old' after this function.
@@ -2333,14 +2723,14 @@ static void inverse_mdct(float *buffer, int n, vorb *f, int blocktype)
    // switch between them halfway.
 
    // this is iteration 0 of step 3
-   imdct_step3_iter0_loop(n >> 4, u, n2-1-n4*0, -(n >> 3), A);
-   imdct_step3_iter0_loop(n >> 4, u, n2-1-n4*1, -(n >> 3), A);
+   kernels->iter0_loop(n >> 4, u, n2-1-n4*0, -(n >> 3), A);
+   kernels->iter0_loop(n >> 4, u, n2-1-n4*1, -(n >> 3), A);
 
    // this is iteration 1 of step 3
-   imdct_step3_inner_r_loop(n >> 5, u, n2-1 - n8*0, -(n >> 4), A, 16);
-   imdct_step3_inner_r_loop(n >> 5, u, n2-1 - n8*1, -(n >> 4), A, 16);
-   imdct_step3_inner_r_loop(n >> 5, u, n2-1 - n8*2, -(n >> 4), A, 16);
-   imdct_step3_inner_r_loop(n >> 5, u, n2-1 - n8*3, -(n >> 4), A, 16);
+   kernels->inner_r_loop(n >> 5, u, n2-1 - n8*0, -(n >> 4), A, 16);
+   kernels->inner_r_loop(n >> 5, u, n2-1 - n8*1, -(n >> 4), A, 16);
+   kernels->inner_r_loop(n >> 5, u, n2-1 - n8*2, -(n >> 4), A, 16);
+   kernels->inner_r_loop(n >> 5, u, n2-1 - n8*3, -(n >> 4), A, 16);
 
    l=2;
    for (; l < (ld-3)>>1; ++l) {
@@ -2348,7 +2738,7 @@ static void inverse_mdct(float *buffer, int n, vorb *f, int blocktype)
       int lim = 1 << (l+1);
       int i;
       for (i=0; i < lim; ++i)
-         imdct_step3_inner_r_loop(n >> (l+4), u, n2-1 - k0*i, -k0_2, A, 1 << (l+3));
+         kernels->inner_r_loop(n >> (l+4), u, n2-1 - k0*i, -k0_2, A, 1 << (l+3));
    }
 
    for (; l < ld-6; ++l) {
@@ -2359,7 +2749,7 @@ static void inverse_mdct(float *buffer, int n, vorb *f, int blocktype)
       float *A0 = A;
       i_off = n2-1;
       for (r=rlim; r > 0; --r) {
-         imdct_step3_inner_s_loop(lim, u, i_off, -k0_2, A0, k1, k0);
+         kernels->inner_s_loop(lim, u, i_off, -k0_2, A0, k1, k0);
          A0 += k1*4;
          i_off -= 8;
       }
@@ -2370,7 +2760,7 @@ static void inverse_mdct(float *buffer, int n, vorb *f, int blocktype)
    //       the big win comes from getting rid of needless flops
    //         due to the constants on pass 5 & 4 being all 1 and 0;
    //       combining them to be simultaneous to improve cache made little difference
-   imdct_step3_inner_s_loop_ld654(n >> 5, u, n2-1, A, n);
+   kernels->inner_s_loop_ld654(n >> 5, u, n2-1, A, n);
 
    // output is u
 
@@ -2695,7 +3085,15 @@ static int do_floor(vorb *f, Mapping *map, int i, int n, float *target, YTYPE *f
       }
       if (lx < n2) {
          // optimization of: draw_line(target, lx,ly, n,ly, n2);
-         for (j=lx; j < n2; ++j)
+         j = lx;
+         #ifdef STB_VORBIS_SSE2
+         if (stb_vorbis_get_simd_level() != STB_VORBIS_SIMD_NONE) {
+            __m128 v = _mm_set1_ps(inverse_db_table[ly]);
+            for (; j+4 <= n2; j += 4)
+               LINE_OP_SSE2(target+j, v);
+         }
+         #endif
+         for (; j < n2; ++j)
             LINE_OP(target[j], inverse_db_table[ly]);
          CHECK(f);
       }
@@ -2958,7 +3356,14 @@ static int vorbis_decode_packet_rest(vorb *f, int *len, Mode *m, int left_start,
       if (really_zero_channel[i]) {
          memset(f->channel_buffers[i], 0, sizeof(*f->channel_buffers[i]) * n2);
       } else {
-         for (j=0; j < n2; ++j)
+         j = 0;
+         #ifdef STB_VORBIS_SSE2
+         if (stb_vorbis_get_simd_level() != STB_VORBIS_SIMD_NONE) {
+            for (; j+4 <= n2; j += 4)
+               _mm_storeu_ps(f->channel_buffers[i]+j, _mm_mul_ps(_mm_loadu_ps(f->channel_buffers[i]+j), _mm_loadu_ps(f->floor_buffers[i]+j)));
+         }
+         #endif
+         for (; j < n2; ++j)
             f->channel_buffers[i][j] *= f->floor_buffers[i][j];
       }
    }
@@ -3175,6 +3580,24 @@ static int is_whole_packet_present(stb_vorbis *f, int end_page)
 }
 #endif // !STB_VORBIS_NO_PUSHDATA_API
 
+// per-channel decode state; this is the only part of the setup that is
+// mutated while decoding, so it is never shared between decoders
+static int init_channel_buffers(vorb *f)
+{
+   int i;
+   for (i=0; i < f->channels; ++i) {
+      f->channel_buffers[i] = (float *) setup_malloc(f, sizeof(float) * f->blocksize_1);
+      f->previous_window[i] = (float *) setup_malloc(f, sizeof(float) * f->blocksize_1/2);
+      f->finalY[i]          = (int16 *) setup_malloc(f, sizeof(int16) * f->longest_floorlist);
+      if (f->channel_buffers[i] == NULL || f->previous_window[i] == NULL || f->finalY[i] == NULL) return error(f, VORBIS_outofmem);
+      #ifdef STB_VORBIS_NO_DEFER_FLOOR
+      f->floor_buffers[i]   = (float *) setup_malloc(f, sizeof(float) * f->blocksize_1/2);
+      if (f->floor_buffers[i] == NULL) return error(f, VORBIS_outofmem);
+      #endif
+   }
+   return TRUE;
+}
+
 static int start_decoder(vorb *f)
 {
    uint8 header[6], x,y;
@@ -3661,17 +4084,9 @@ static int start_decoder(vorb *f)
    flush_packet(f);
 
    f->previous_length = 0;
+   f->longest_floorlist = longest_floorlist;
 
-   for (i=0; i < f->channels; ++i) {
-      f->channel_buffers[i] = (float *) setup_malloc(f, sizeof(float) * f->blocksize_1);
-      f->previous_window[i] = (float *) setup_malloc(f, sizeof(float) * f->blocksize_1/2);
-      f->finalY[i]          = (int16 *) setup_malloc(f, sizeof(int16) * longest_floorlist);
-      if (f->channel_buffers[i] == NULL || f->previous_window[i] == NULL || f->finalY[i] == NULL) return error(f, VORBIS_outofmem);
-      #ifdef STB_VORBIS_NO_DEFER_FLOOR
-      f->floor_buffers[i]   = (float *) setup_malloc(f, sizeof(float) * f->blocksize_1/2);
-      if (f->floor_buffers[i] == NULL) return error(f, VORBIS_outofmem);
-      #endif
-   }
+   if (!init_channel_buffers(f)) return FALSE;
 
    if (!init_blocksize(f, 0, f->blocksize_0)) return FALSE;
    if (!init_blocksize(f, 1, f->blocksize_1)) return FALSE;
@@ -3727,6 +4142,7 @@ static int start_decoder(vorb *f)
 static void vorbis_deinit(stb_vorbis *p)
 {
    int i,j;
+   if (p->shared_setup) goto free_channels;
    if (p->residue_config) {
       for (i=0; i < p->residue_count; ++i) {
          Residue *r = p->residue_config+i;
@@ -3759,6 +4175,14 @@ static void vorbis_deinit(stb_vorbis *p)
          setup_free(p, p->mapping[i].chan);
       setup_free(p, p->mapping);
    }
+   for (i=0; i < 2; ++i) {
+      setup_free(p, p->A[i]);
+      setup_free(p, p->B[i]);
+      setup_free(p, p->C[i]);
+      setup_free(p, p->window[i]);
+      setup_free(p, p->bit_reverse[i]);
+   }
+free_channels:
    CHECK(p);
    for (i=0; i < p->channels && i < STB_VORBIS_MAX_CHANNELS; ++i) {
       setup_free(p, p->channel_buffers[i]);
@@ -3768,13 +4192,6 @@ static void vorbis_deinit(stb_vorbis *p)
       #endif
       setup_free(p, p->finalY[i]);
    }
-   for (i=0; i < 2; ++i) {
-      setup_free(p, p->A[i]);
-      setup_free(p, p->B[i]);
-      setup_free(p, p->C[i]);
-      setup_free(p, p->window[i]);
-      setup_free(p, p->bit_reverse[i]);
-   }
    #ifndef STB_VORBIS_NO_STDIO
    if (p->close_on_free) fclose(p->f);
    #endif
@@ -4611,6 +5028,86 @@ stb_vorbis * stb_vorbis_open_memory(const unsigned char *data, int len, int *err
    return NULL;
 }
 
+stb_vorbis * stb_vorbis_open_memory_shared(const unsigned char *data, int len, const stb_vorbis *setup, int *error, const stb_vorbis_alloc *alloc)
+{
+   stb_vorbis *f, p;
+   int i;
+   if (data == NULL || setup == NULL) return NULL;
+   if (IS_PUSH_MODE(setup)) { if (error) *error = VORBIS_invalid_api_mixing; return NULL; }
+   vorbis_init(&p, alloc);
+   p.stream = (uint8 *) data;
+   p.stream_end = (uint8 *) data + len;
+   p.stream_start = (uint8 *) p.stream;
+   p.stream_len = len;
+   p.push_mode = FALSE;
+
+   // borrow everything start_decoder() derived from the three header packets
+   p.shared_setup = TRUE;
+   p.sample_rate = setup->sample_rate;
+   p.channels = setup->channels;
+   p.blocksize_0 = setup->blocksize_0;
+   p.blocksize_1 = setup->blocksize_1;
+   p.blocksize[0] = setup->blocksize[0];
+   p.blocksize[1] = setup->blocksize[1];
+   p.codebook_count = setup->codebook_count;
+   p.codebooks = setup->codebooks;
+   p.floor_count = setup->floor_count;
+   memcpy(p.floor_types, setup->floor_types, sizeof(p.floor_types));
+   p.floor_config = setup->floor_config;
+   p.residue_count = setup->residue_count;
+   memcpy(p.residue_types, setup->residue_types, sizeof(p.residue_types));
+   p.residue_config = setup->residue_config;
+   p.mapping_count = setup->mapping_count;
+   p.mapping = setup->mapping;
+   p.mode_count = setup->mode_count;
+   memcpy(p.mode_config, setup->mode_config, sizeof(p.mode_config));
+   p.longest_floorlist = setup->longest_floorlist;
+   for (i=0; i < 2; ++i) {
+      p.A[i] = setup->A[i];
+      p.B[i] = setup->B[i];
+      p.C[i] = setup->C[i];
+      p.window[i] = setup->window[i];
+      p.bit_reverse[i] = setup->bit_reverse[i];
+   }
+   p.temp_memory_required = setup->temp_memory_required;
+   p.first_audio_page_offset = setup->first_audio_page_offset;
+   // the last page probe comes with the length, seeking bisects up to it
+   p.total_samples = setup->total_samples;
+   p.p_last = setup->p_last;
+
+   if (init_channel_buffers(&p)) {
+      if (p.alloc.alloc_buffer && p.setup_offset + sizeof(p) + p.temp_memory_required > (unsigned) p.temp_offset) {
+         p.error = VORBIS_outofmem;
+      } else {
+         f = vorbis_alloc(&p);
+         if (f) {
+            *f = p;
+            stb_vorbis_seek_start(f);
+            if (error) *error = VORBIS__no_error;
+            return f;
+         }
+      }
+   }
+   if (error) *error = p.error;
+   vorbis_deinit(&p);
+   return NULL;
+}
+
+int stb_vorbis_get_shared_memory_required(const stb_vorbis *setup)
+{
+   // mirrors the setup_malloc() calls made by stb_vorbis_open_memory_shared()
+   int i, size = (sizeof(stb_vorbis) + 3) & ~3;
+   for (i=0; i < setup->channels; ++i) {
+      size += (sizeof(float) * setup->blocksize_1 + 3) & ~3;
+      size += (sizeof(float) * (setup->blocksize_1/2) + 3) & ~3;
+      size += (sizeof(int16) * setup->longest_floorlist + 3) & ~3;
+      #ifdef STB_VORBIS_NO_DEFER_FLOOR
+      size += (sizeof(float) * (setup->blocksize_1/2) + 3) & ~3;
+      #endif
+   }
+   return size + ((setup->temp_memory_required + 3) & ~3);
+}
+
 #ifndef STB_VORBIS_NO_INTEGER_CONVERSION
 #define PLAYBACK_MONO     1
 #define PLAYBACK_LEFT     2
@@ -145,6 +145,24 @@ extern "C" {
     // of the memory buffer. In pushdata mode it returns 0.
     extern unsigned int stb_vorbis_get_file_offset(stb_vorbis *f);
 
+    ///////////   SIMD
+
+    enum STBVorbisSimdLevel
+    {
+        STB_VORBIS_SIMD_NONE,   // scalar C
+        STB_VORBIS_SIMD_SSE2,
+        STB_VORBIS_SIMD_AVX
+    };
+
+    extern int stb_vorbis_set_simd_level(int level);
+    // restrict the inverse MDCT kernels to 'level' or lower; the level is
+    // clamped to what the CPU supports and the level now in use is returned.
+    // affects all decoders, so only change it while nothing is decoding
+    // (e.g. to compare against the scalar path in tests).
+
+    extern int stb_vorbis_get_simd_level(void);
+    // the level in use, by default the best one the CPU supports
+
     ///////////   PUSHDATA API
 
 #ifndef STB_VORBIS_NO_PUSHDATA_API
@@ -240,6 +258,21 @@ extern "C" {
     // create an ogg vorbis decoder from an ogg vorbis stream in memory (note
     // this must be the entire stream!). on failure, returns NULL and sets *error
 
+    extern stb_vorbis * stb_vorbis_open_memory_shared(const unsigned char *data, int len,
+        const stb_vorbis *setup, int *error, const stb_vorbis_alloc *alloc_buffer);
+    // create a decoder for the same in-memory stream that 'setup' was opened on,
+    // without parsing the headers again. codebooks, floors, residues, mappings
+    // and the per-blocksize twiddle/window/bit-reverse tables are shared read-only
+    // with 'setup'; only the per-channel decode buffers are allocated. 'setup'
+    // must be a pulldata decoder and must outlive the returned decoder. it may
+    // be used from other threads concurrently as long as nobody decodes from it.
+
+    extern int stb_vorbis_get_shared_memory_required(const stb_vorbis *setup);
+    // returns the size of the alloc_buffer that stb_vorbis_open_memory_shared()
+    // needs for 'setup', including the temp memory used while decoding. a buffer
+    // of this size can be reused for another shared decoder once the previous
+    // one has been closed.
+
 #ifndef STB_VORBIS_NO_STDIO
     extern stb_vorbis * stb_vorbis_open_filename(const char *filename,
         int *error, const stb_vorbis_alloc *alloc_buffer);
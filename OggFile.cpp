@@ -1,11 +1,11 @@
 #include <IO/FileInputStream.h>
 #include <IO/FileSystem.h>
-#pragma warning(push, 3)
-#include "LibVorbis.h"
-#pragma warning( pop )
 #include "AudioBuffer.h"
 #include "AudioException.h"
+#include "AudioMemoryStats.h"
+#include "AudioMetadataCache.h"
 #include "OggFile.h"
+#include "VorbisSetup.h"
 
 using namespace IO;
 
@@ -18,8 +18,12 @@ namespace Audio
             throw AudioException("Not A Vorbis File");
     }
 
-    bool OggFile::read(const std::string& fileName)
+    bool OggFile::read(const std::string& fileName, AudioMetadataCache* cache)
     {
+        AudioMetadata metadata;
+        if (!cache || !cache->getMetadata(fileName, metadata) || metadata.m_type != AUDIO_TYPE_OGG)
+            metadata.m_numSamples = 0;
+
         bool succeed = false;
         FileInputStream fis(fileName);
         if (!fis.isOpen())
@@ -29,23 +33,23 @@ namespace Audio
         if (!fileSize)
             return false;
         
-        fs_data fileData(fileSize);
-        succeed = fis.readData(fileData, fileSize) == fileSize;
+        auto waveData = std::make_shared<AudioBuffer>( fileSize );
+        succeed = fis.readData(waveData->data(), fileSize) == fileSize;
         if (!succeed)
             return false;
+        waveData = TrackAudioBuffer(waveData, AUDIO_MEMORY_ASSET, fileName);
 
-        int errCode;
-        auto* vorbis = stb_vorbis_open_memory( fileData.data(), (int)fileSize, &errCode, nullptr);
-        if ( !vorbis || errCode )
+        try {
+            m_setup = VorbisSetup::Acquire(waveData, metadata.m_numSamples);
+        }
+        catch (const AudioException&) {
             return false;
+        }
 
-        auto info     = stb_vorbis_get_info(vorbis);
-        m_totalLength = stb_vorbis_stream_length_in_seconds(vorbis);
-        m_frequency   = info.sample_rate;
-        m_numChannels = info.channels;       
-        m_waveData    = std::make_shared<AudioBuffer>( fileSize );
-        memcpy(m_waveData->data(), fileData.data(), fileSize);
-        stb_vorbis_close(vorbis);
+        m_totalLength = m_setup->getTotalLength();
+        m_frequency   = m_setup->getSampleRate();
+        m_numChannels = m_setup->getNumChannels();
+        m_waveData    = waveData;
                 
         return true;
     }
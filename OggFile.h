@@ -3,10 +3,12 @@
 #include <string>
 #include <vector>
 #include "AudioFileBase.h"
+#include "VorbisSetupPtr.h"
 
 namespace Audio
 {
-    
+    class AudioMetadataCache;
+
     struct OggFile : public AudioFileBase
     {
         OggFile() 
@@ -18,10 +20,15 @@ namespace Audio
 
         OggFile( const std::string& fileName );
 
-        bool                read(const std::string& fileName);
+        /*
+            @brief: With a 'cache' the length comes from the cached probe of
+            the file instead of a search for the last page
+        */
+        bool                read(const std::string& fileName, AudioMetadataCache* cache = nullptr);
         
         std::uint32_t       m_numChannels;
         std::uint32_t       m_frequency;              
+        VorbisSetupPtr      m_setup; //parsed headers, shared with streams of this file
     };
     
   
@@ -0,0 +1,291 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
+#include "AudioException.h"
+#include "AudioHelper.h"
+#include "AudioMemoryStats.h"
+#include "AudioStream.h"
+#include "AdpcmAudioStream.h"
+#include "AdpcmCodec.h"
+#include "SoundBank.h"
+#include "VorbisAudioStream.h"
+#include "VorbisSetup.h"
+
+namespace Audio
+{
+    namespace
+    {
+        //////////////////////////////////////////////////////////////////////////
+        //\Brief: Read-only mapping of a whole file, unmapped on destruction
+        //////////////////////////////////////////////////////////////////////////
+        class MappedFile
+        {
+        public:
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+#ifdef _WIN32
+            MappedFile(const std::string& fileName)
+            {
+                m_file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+                if (m_file == INVALID_HANDLE_VALUE)
+                    return;
+
+                LARGE_INTEGER size;
+                if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+                    return;
+
+                m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (!m_mapping)
+                    return;
+
+                m_data = static_cast<const std::int8_t*>( MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) );
+                if (m_data)
+                    m_size = static_cast<std::uint64_t>(size.QuadPart);
+            }
+
+            ~MappedFile()
+            {
+                untrack();
+                if (m_data)
+                    UnmapViewOfFile(m_data);
+                if (m_mapping)
+                    CloseHandle(m_mapping);
+                if (m_file != INVALID_HANDLE_VALUE)
+                    CloseHandle(m_file);
+            }
+#else
+            MappedFile(const std::string& fileName)
+            {
+                const int fd = ::open(fileName.c_str(), O_RDONLY);
+                if (fd < 0)
+                    return;
+
+                struct stat info;
+                if (fstat(fd, &info) == 0 && info.st_size > 0) {
+                    void* data = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (data != MAP_FAILED) {
+                        m_data = static_cast<const std::int8_t*>(data);
+                        m_size = static_cast<std::uint64_t>(info.st_size);
+                    }
+                }
+                //the mapping stays valid after the descriptor is closed
+                ::close(fd);
+            }
+
+            ~MappedFile()
+            {
+                untrack();
+                if (m_data)
+                    munmap(const_cast<std::int8_t*>(m_data), static_cast<std::size_t>(m_size));
+            }
+#endif
+
+            const std::int8_t*  getData() const { return m_data; }
+            std::uint64_t       getSize() const { return m_size; }
+
+            /*
+                @brief: Accounts the whole mapping to 'asset' until destruction
+            */
+            void                track(const std::string& asset)
+            {
+                untrack();
+                m_asset = asset;
+                TrackAudioAlloc(AUDIO_MEMORY_ASSET, static_cast<std::size_t>(m_size), m_asset.c_str());
+            }
+
+        private:
+            void                untrack()
+            {
+                if (!m_asset.empty())
+                    TrackAudioFree(AUDIO_MEMORY_ASSET, static_cast<std::size_t>(m_size), m_asset.c_str());
+                m_asset.clear();
+            }
+
+#ifdef _WIN32
+            HANDLE              m_file    = INVALID_HANDLE_VALUE;
+            HANDLE              m_mapping = nullptr;
+#endif
+            const std::int8_t*  m_data    = nullptr;
+            std::uint64_t       m_size    = 0;
+            std::string         m_asset;
+        };
+
+        bool IsInRange(std::uint64_t offset, std::uint64_t size, std::uint64_t total)
+        {
+            return offset <= total && size <= total - offset;
+        }
+    }
+
+    SoundId GetSoundId(const std::string& name)
+    {
+        std::uint32_t hash = 2166136261u;
+        for (const auto c : name) {
+            hash ^= static_cast<std::uint8_t>(c);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    SoundBank::SoundBank()
+        : m_data( nullptr )
+        , m_size( 0 )
+        , m_header( nullptr )
+        , m_entries( nullptr )
+        , m_slots( nullptr )
+    {
+    }
+
+    SoundBank::SoundBank(const std::string& fileName)
+        : SoundBank()
+    {
+        if (!open(fileName))
+            throw AudioException("Not A Sound Bank");
+    }
+
+    bool SoundBank::open(const std::string& fileName)
+    {
+        close();
+
+        auto mapping = std::make_shared<MappedFile>(fileName);
+        const auto* data = mapping->getData();
+        const auto  size = mapping->getSize();
+        if (!data || size < sizeof(SoundBankHeader))
+            return false;
+
+        //verify header and tables, entries are trusted once the bank is open
+        const auto* header = reinterpret_cast<const SoundBankHeader*>(data);
+        if (memcmp("SBNK", header->m_magic, 4) != 0 || header->m_version != SOUND_BANK_VERSION)
+            return false;
+
+        const auto numSlots = header->m_numSlots;
+        if (!numSlots || (numSlots & (numSlots - 1)) || numSlots < header->m_numAssets ||
+            header->m_entriesOffset % alignof(SoundBankEntry) || header->m_slotsOffset % alignof(std::uint32_t) ||
+            !IsInRange(header->m_entriesOffset, std::uint64_t(header->m_numAssets) * sizeof(SoundBankEntry), size) ||
+            !IsInRange(header->m_slotsOffset, std::uint64_t(numSlots) * sizeof(std::uint32_t), size))
+            return false;
+
+        const auto* entries = reinterpret_cast<const SoundBankEntry*>(data + header->m_entriesOffset);
+        for (std::uint32_t i = 0; i < header->m_numAssets; ++i) {
+            if (!IsInRange(entries[i].m_offset, entries[i].m_size, size))
+                return false;
+        }
+
+        const auto* slots = reinterpret_cast<const std::uint32_t*>(data + header->m_slotsOffset);
+        for (std::uint32_t i = 0; i < numSlots; ++i) {
+            if (slots[i] != SOUND_BANK_NO_ENTRY && slots[i] >= header->m_numAssets)
+                return false;
+        }
+
+        mapping->track(fileName);
+        m_mapping = mapping;
+        m_data    = data;
+        m_size    = size;
+        m_header  = header;
+        m_entries = entries;
+        m_slots   = slots;
+        return true;
+    }
+
+    void SoundBank::close()
+    {
+        //streams created from the bank keep the mapping alive
+        m_mapping.reset();
+        m_data    = nullptr;
+        m_size    = 0;
+        m_header  = nullptr;
+        m_entries = nullptr;
+        m_slots   = nullptr;
+    }
+
+    bool SoundBank::isOpen() const
+    {
+        return m_header != nullptr;
+    }
+
+    std::uint32_t SoundBank::getNumAssets() const
+    {
+        return m_header ? m_header->m_numAssets : 0;
+    }
+
+    const SoundBankEntry* SoundBank::getEntry(std::uint32_t index) const
+    {
+        return index < getNumAssets() ? &m_entries[index] : nullptr;
+    }
+
+    const SoundBankEntry* SoundBank::find(SoundId id) const
+    {
+        if (!m_header)
+            return nullptr;
+
+        //linear probing, the writer keeps at least one free slot per asset
+        const auto mask = m_header->m_numSlots - 1;
+        for (std::uint32_t i = 0, slot = id & mask; i < m_header->m_numSlots; ++i, slot = (slot + 1) & mask) {
+            const auto index = m_slots[slot];
+            if (index == SOUND_BANK_NO_ENTRY)
+                return nullptr;
+            if (m_entries[index].m_id == id)
+                return &m_entries[index];
+        }
+        return nullptr;
+    }
+
+    const SoundBankEntry* SoundBank::find(const std::string& name) const
+    {
+        return find(GetSoundId(name));
+    }
+
+    AudioMemory SoundBank::getMemory(const SoundBankEntry& entry) const
+    {
+        return AudioMemory( m_data + entry.m_offset, static_cast<std::size_t>(entry.m_size), m_mapping );
+    }
+
+    AudioFormat SoundBank::getFormat(const SoundBankEntry& entry) const
+    {
+        AudioFormat format;
+        format.m_type       = static_cast<eAudioType>(entry.m_type);
+        format.m_format     = entry.m_format;
+        format.m_channels   = entry.m_channels;
+        format.m_sampleRate = entry.m_sampleRate;
+        format.m_usage      = static_cast<eAudioUsage>(entry.m_usage);
+        format.setLoopCount( entry.m_loopCount );
+        return format;
+    }
+
+    float SoundBank::getLength(const SoundBankEntry& entry) const
+    {
+        const auto frameSize = getFormat(entry).getBytesPerSample();
+        return GetLength( entry.m_numSamples * frameSize, entry.m_sampleRate, frameSize );
+    }
+
+    AudioStreamBasePtr SoundBank::createStream(SoundId id) const
+    {
+        const auto* entry = find(id);
+        if (!entry)
+            return nullptr;
+
+        const auto memory = getMemory(*entry);
+        const auto format = getFormat(*entry);
+        switch (entry->m_type)
+        {
+        case AUDIO_TYPE_WAV:
+            return std::make_shared<AudioStreamBase>( memory, format );
+        case AUDIO_TYPE_OGG:
+            return std::make_shared<VorbisAudioStream>( VorbisSetup::Acquire( memory ), format );
+        case AUDIO_TYPE_ADPCM:
+            return std::make_shared<AdpcmAudioStream>( memory, format );
+        default:
+            throw AudioException("Unsupported Sound Bank Asset");
+        }
+    }
+}
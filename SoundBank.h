@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <memory>
+
+#include "AudioConfig.h"
+#include "AudioBuffer.h"
+#include "AudioStreamBasePtr.h"
+
+namespace Audio
+{
+    using SoundId = std::uint32_t;
+
+    constexpr std::uint32_t SOUND_BANK_VERSION   = 1;
+    //payloads start on this boundary so decoders can use aligned loads
+    constexpr std::uint32_t SOUND_BANK_ALIGNMENT = 16;
+    constexpr std::uint32_t SOUND_BANK_NO_ENTRY  = ~0u;
+
+    /*
+        @brief: Hash of an asset name( FNV-1a ), the key sounds are resolved by
+    */
+    SoundId             GetSoundId( const std::string& name );
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Leading header of a sound bank file. It is followed by the
+    // entry table, the slot table and the asset payloads, all offsets are
+    // relative to the start of the file
+    //////////////////////////////////////////////////////////////////////////
+    struct SoundBankHeader
+    {
+        std::uint8_t        m_magic[4];      //"SBNK"
+        std::uint32_t       m_version;
+        std::uint32_t       m_numAssets;
+        std::uint32_t       m_numSlots;      //power of two
+        std::uint64_t       m_entriesOffset;
+        std::uint64_t       m_slotsOffset;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Per asset record, the payload is raw interleaved pcm for
+    // AUDIO_TYPE_WAV, an ogg file for AUDIO_TYPE_OGG and an ADPCM asset
+    // for AUDIO_TYPE_ADPCM
+    //////////////////////////////////////////////////////////////////////////
+    struct SoundBankEntry
+    {
+        SoundId             m_id;
+        std::uint32_t       m_type;          //eAudioType
+        std::uint32_t       m_format;        //eAudioFormat of the decoded samples
+        std::uint32_t       m_channels;
+        std::uint32_t       m_sampleRate;
+        std::uint32_t       m_usage;         //eAudioUsage
+        std::int32_t        m_loopCount;
+        std::uint32_t       m_numSamples;    //per channel
+        std::uint64_t       m_offset;
+        std::uint64_t       m_size;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Bank written by SoundBankWriter, mapped into memory with a single
+    // open. Sounds are looked up through an open addressed slot table and
+    // stream straight out of the mapping, which lives as long as the bank
+    // or any stream created from it
+    //////////////////////////////////////////////////////////////////////////
+    class SoundBank
+    {
+    public:
+        SoundBank();
+        SoundBank( const std::string& fileName );
+
+        bool                    open( const std::string& fileName );
+        void                    close();
+        bool                    isOpen() const;
+
+        std::uint32_t           getNumAssets() const;
+        const SoundBankEntry*   getEntry( std::uint32_t index ) const;
+
+        /*
+            @brief: Returns the entry of sound 'id', nullptr if the bank does not
+            contain it
+        */
+        const SoundBankEntry*   find( SoundId id ) const;
+        const SoundBankEntry*   find( const std::string& name ) const;
+
+        AudioMemory             getMemory( const SoundBankEntry& entry ) const;
+        AudioFormat             getFormat( const SoundBankEntry& entry ) const;
+        float                   getLength( const SoundBankEntry& entry ) const;
+
+        /*
+            @brief: Creates a stream reading from the mapped payload of sound 'id',
+            nullptr if the bank does not contain it
+        */
+        AudioStreamBasePtr      createStream( SoundId id ) const;
+
+    private:
+        std::shared_ptr<const void>     m_mapping; //keeps the file mapped
+        const std::int8_t*              m_data;
+        std::uint64_t                   m_size;
+        const SoundBankHeader*          m_header;
+        const SoundBankEntry*           m_entries;
+        const std::uint32_t*            m_slots;
+    };
+}
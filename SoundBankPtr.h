@@ -0,0 +1,8 @@
+#pragma once
+#include <memory>
+
+namespace Audio
+{
+    class SoundBank;
+    using SoundBankPtr = std::shared_ptr<SoundBank>;
+}
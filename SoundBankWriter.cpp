@@ -0,0 +1,153 @@
+#include <cstring>
+#include <fstream>
+
+#include "AudioException.h"
+#include "AdpcmCodec.h"
+#include "OggFile.h"
+#include "SoundBankWriter.h"
+#include "VorbisSetup.h"
+#include "WavFile.h"
+
+namespace Audio
+{
+    namespace
+    {
+        std::uint64_t AlignOffset(std::uint64_t offset)
+        {
+            return (offset + SOUND_BANK_ALIGNMENT - 1) & ~std::uint64_t(SOUND_BANK_ALIGNMENT - 1);
+        }
+    }
+
+    SoundId SoundBankWriter::add(const std::string& name, const AudioFormat& format, std::uint32_t numSamples, const AudioBufferPtr& payload)
+    {
+        if (!payload || payload->empty())
+            throw AudioException("Empty Audio Buffer");
+
+        const auto id = GetSoundId(name);
+        for (const auto& entry : m_entries) {
+            if (entry.m_id == id)
+                throw AudioException("Sound Id Collision: " + name);
+        }
+
+        SoundBankEntry entry = {};
+        entry.m_id          = id;
+        entry.m_type        = format.m_type;
+        entry.m_format      = format.m_format;
+        entry.m_channels    = format.m_channels;
+        entry.m_sampleRate  = format.m_sampleRate;
+        entry.m_usage       = format.m_usage;
+        entry.m_loopCount   = format.m_loopCount;
+        entry.m_numSamples  = numSamples;
+        entry.m_size        = payload->size();
+
+        m_entries.push_back(entry);
+        m_payloads.push_back(payload);
+        return id;
+    }
+
+    SoundId SoundBankWriter::add(const std::string& name, const WavFile& wav, eAudioUsage usage, int loopCount)
+    {
+        const auto& header = wav.m_header;
+        AudioFormat format;
+        format.m_type       = AUDIO_TYPE_WAV;
+        format.m_format     = wav.getSampleFormat();
+        format.m_channels   = header.m_channels;
+        format.m_sampleRate = header.m_frequency;
+        format.m_usage      = usage;
+        format.setLoopCount(loopCount);
+        if (format.m_format == audio_format_unknown || !format.m_channels || !wav.m_waveData)
+            throw AudioException("Unsupported Wave Format");
+
+        const auto frameSize = format.getBytesPerSample();
+        return add(name, format, std::uint32_t(wav.m_waveData->size() / frameSize), wav.m_waveData);
+    }
+
+    SoundId SoundBankWriter::add(const std::string& name, const OggFile& ogg, eAudioUsage usage, int loopCount)
+    {
+        AudioFormat format;
+        format.m_type       = AUDIO_TYPE_OGG;
+        format.m_format     = audio_format_s16;
+        format.m_channels   = ogg.m_numChannels;
+        format.m_sampleRate = ogg.m_frequency;
+        format.m_usage      = usage;
+        format.setLoopCount(loopCount);
+        if (!ogg.m_setup)
+            throw AudioException("Not A Vorbis File");
+
+        return add(name, format, ogg.m_setup->getTotalSamples(), ogg.m_waveData);
+    }
+
+    SoundId SoundBankWriter::addAdpcm(const std::string& name, const AudioBufferPtr& adpcm, eAudioUsage usage, int loopCount)
+    {
+        const auto* header = adpcm ? GetAdpcmHeader(adpcm->data(), adpcm->size()) : nullptr;
+        if (!header)
+            throw AudioException("Not An ADPCM Buffer");
+
+        AudioFormat format;
+        format.m_type       = AUDIO_TYPE_ADPCM;
+        format.m_format     = audio_format_s16;
+        format.m_channels   = header->m_numChannels;
+        format.m_sampleRate = header->m_sampleRate;
+        format.m_usage      = usage;
+        format.setLoopCount(loopCount);
+        return add(name, format, header->m_numSamples, adpcm);
+    }
+
+    std::uint32_t SoundBankWriter::getNumAssets() const
+    {
+        return static_cast<std::uint32_t>(m_entries.size());
+    }
+
+    bool SoundBankWriter::write(const std::string& fileName) const
+    {
+        const auto numAssets = getNumAssets();
+
+        //at most half the slots are used, keeps probe sequences short
+        std::uint32_t numSlots = 1;
+        while (numSlots < numAssets * 2)
+            numSlots <<= 1;
+
+        std::vector<std::uint32_t> slots(numSlots, SOUND_BANK_NO_ENTRY);
+        const auto mask = numSlots - 1;
+        for (std::uint32_t i = 0; i < numAssets; ++i) {
+            auto slot = m_entries[i].m_id & mask;
+            while (slots[slot] != SOUND_BANK_NO_ENTRY)
+                slot = (slot + 1) & mask;
+            slots[slot] = i;
+        }
+
+        SoundBankHeader header = {};
+        memcpy(header.m_magic, "SBNK", 4);
+        header.m_version        = SOUND_BANK_VERSION;
+        header.m_numAssets      = numAssets;
+        header.m_numSlots       = numSlots;
+        header.m_entriesOffset  = AlignOffset(sizeof(SoundBankHeader));
+        header.m_slotsOffset    = header.m_entriesOffset + std::uint64_t(numAssets) * sizeof(SoundBankEntry);
+
+        auto entries = m_entries;
+        auto offset  = header.m_slotsOffset + std::uint64_t(numSlots) * sizeof(std::uint32_t);
+        for (auto& entry : entries) {
+            entry.m_offset = AlignOffset(offset);
+            offset = entry.m_offset + entry.m_size;
+        }
+
+        std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+
+        const char padding[SOUND_BANK_ALIGNMENT] = {};
+        auto writeAt = [&file, &padding](std::uint64_t offset, const void* data, std::size_t size) {
+            const auto pos = static_cast<std::uint64_t>(file.tellp());
+            file.write(padding, static_cast<std::streamsize>(offset - pos));
+            file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        };
+
+        writeAt(0, &header, sizeof(header));
+        writeAt(header.m_entriesOffset, entries.data(), entries.size() * sizeof(SoundBankEntry));
+        writeAt(header.m_slotsOffset, slots.data(), slots.size() * sizeof(std::uint32_t));
+        for (std::size_t i = 0; i < entries.size(); ++i)
+            writeAt(entries[i].m_offset, m_payloads[i]->data(), m_payloads[i]->size());
+
+        return bool(file.flush());
+    }
+}
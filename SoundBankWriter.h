@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "AudioConfig.h"
+#include "AudioBuffer.h"
+#include "SoundBank.h"
+
+namespace Audio
+{
+    struct WavFile;
+    struct OggFile;
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Offline packer, collects assets and writes them into a single
+    // sound bank file that SoundBank maps at runtime
+    //////////////////////////////////////////////////////////////////////////
+    class SoundBankWriter
+    {
+    public:
+        /*
+            @brief: Adds an asset whose payload matches 'format.m_type', see
+            SoundBankEntry. Throws if the name collides with an added asset
+        */
+        SoundId             add( const std::string& name, const AudioFormat& format, std::uint32_t numSamples, const AudioBufferPtr& payload );
+
+        SoundId             add( const std::string& name, const WavFile& wav, eAudioUsage usage = AUDIO_USAGE_UNDEFINED, int loopCount = AUDIO_LOOP_INFINITE );
+        SoundId             add( const std::string& name, const OggFile& ogg, eAudioUsage usage = AUDIO_USAGE_UNDEFINED, int loopCount = AUDIO_LOOP_INFINITE );
+        SoundId             addAdpcm( const std::string& name, const AudioBufferPtr& adpcm, eAudioUsage usage = AUDIO_USAGE_UNDEFINED, int loopCount = AUDIO_LOOP_INFINITE );
+
+        std::uint32_t       getNumAssets() const;
+        bool                write( const std::string& fileName ) const;
+
+    private:
+        std::vector<SoundBankEntry>     m_entries;
+        std::vector<AudioBufferPtr>     m_payloads;
+    };
+}
@@ -0,0 +1,196 @@
+// Conformance check & benchmark of the vectorized Vorbis inverse MDCT.
+//
+// Builds on its own against the decoder source, the static kernels are
+// reached by including it:
+//
+//    cc -O2 -o VorbisSimdCheck Tools/VorbisSimdCheck.c -lm
+//    VorbisSimdCheck [file.ogg ...]
+//
+// Every block size from 64 to 8192 is transformed from the same random
+// input at each level stb_vorbis_set_simd_level() accepts on this CPU, the
+// result has to match the scalar path bit for bit. The best of several
+// runs is reported per block size & level. Streams given on the command
+// line are decoded whole at every level and compared the same way.
+// Returns non-zero on any mismatch.
+
+#include "../LibVorbis.c"
+
+// playback channel masks of the decoder, they clash with the vorb members
+#undef L
+#undef C
+#undef R
+
+#include <time.h>
+
+#define CHECK_MIN_LOG2  6
+#define CHECK_MAX_LOG2  13
+#define CHECK_RUNS      7
+#define CHECK_WORK      (1 << 22)   // transformed samples per timed run
+
+static const char *level_names[] = { "scalar", "sse2", "avx" };
+
+static double check_seconds(void)
+{
+   return (double) clock() / CLOCKS_PER_SEC;
+}
+
+static unsigned int check_random(unsigned int *state)
+{
+   *state = *state * 1664525u + 1013904223u;
+   return *state;
+}
+
+static int check_imdct(void)
+{
+   int lg, level, failed = 0;
+   int max_level = stb_vorbis_set_simd_level(STB_VORBIS_SIMD_AVX);
+
+   printf("%6s", "n");
+   for (level = STB_VORBIS_SIMD_NONE; level <= max_level; ++level)
+      printf(" %14s", level_names[level]);
+   printf("\n");
+
+   for (lg = CHECK_MIN_LOG2; lg <= CHECK_MAX_LOG2; ++lg) {
+      int i, n = 1 << lg;
+      unsigned int seed = (unsigned int) n;
+      float *input  = (float *) malloc(sizeof(float) * n);
+      float *ref    = (float *) malloc(sizeof(float) * n);
+      float *buffer = (float *) malloc(sizeof(float) * n);
+      double scalar_time = 0.0;
+      vorb f;
+
+      memset(&f, 0, sizeof(f));
+      if (!input || !ref || !buffer || !init_blocksize(&f, 0, n)) {
+         printf("out of memory\n");
+         return 1;
+      }
+      for (i = 0; i < n; ++i)
+         input[i] = (check_random(&seed) >> 8) / 8388608.0f - 1.0f;
+
+      printf("%6d", n);
+      for (level = STB_VORBIS_SIMD_NONE; level <= max_level; ++level) {
+         int run, iter, num_iters = CHECK_WORK / n;
+         double best = 1e30;
+
+         stb_vorbis_set_simd_level(level);
+         memcpy(buffer, input, sizeof(float) * n);
+         inverse_mdct(buffer, n, &f, 0);
+         if (level == STB_VORBIS_SIMD_NONE)
+            memcpy(ref, buffer, sizeof(float) * n);
+         else if (memcmp(ref, buffer, sizeof(float) * n)) {
+            printf(" %14s", "MISMATCH");
+            failed = 1;
+            continue;
+         }
+
+         for (run = 0; run < CHECK_RUNS; ++run) {
+            double start = check_seconds(), elapsed;
+            for (iter = 0; iter < num_iters; ++iter) {
+               memcpy(buffer, input, sizeof(float) * n);
+               inverse_mdct(buffer, n, &f, 0);
+            }
+            elapsed = (check_seconds() - start) / num_iters;
+            if (elapsed < best) best = elapsed;
+         }
+         if (level == STB_VORBIS_SIMD_NONE) {
+            scalar_time = best;
+            printf(" %11.0f ns", best * 1e9);
+         } else {
+            printf(" %8.0f ns %.2fx", best * 1e9, scalar_time / best);
+         }
+      }
+      printf("\n");
+
+      free(f.A[0]); free(f.B[0]); free(f.C[0]); free(f.window[0]); free(f.bit_reverse[0]);
+      free(input); free(ref); free(buffer);
+   }
+   stb_vorbis_set_simd_level(max_level);
+   return failed;
+}
+
+static float *check_decode(const unsigned char *data, int len, int *num_floats)
+{
+   int error, channels, n, total = 0, capacity = 1 << 20;
+   float *output = (float *) malloc(sizeof(float) * capacity);
+   stb_vorbis *v = stb_vorbis_open_memory(data, len, &error, NULL);
+   if (!v || !output) {
+      free(output);
+      if (v) stb_vorbis_close(v);
+      return NULL;
+   }
+   channels = v->channels;
+   for (;;) {
+      if (capacity - total < 4096 * channels) {
+         capacity *= 2;
+         output = (float *) realloc(output, sizeof(float) * capacity);
+      }
+      n = stb_vorbis_get_samples_float_interleaved(v, channels, output + total, capacity - total);
+      if (!n) break;
+      total += n * channels;
+   }
+   stb_vorbis_close(v);
+   *num_floats = total;
+   return output;
+}
+
+static int check_stream(const char *file_name)
+{
+   int level, failed = 0, len, ref_len = 0;
+   int max_level = stb_vorbis_get_simd_level();
+   float *ref;
+   unsigned char *data;
+   FILE *file = fopen(file_name, "rb");
+   if (!file) {
+      printf("%s: can't open\n", file_name);
+      return 1;
+   }
+   fseek(file, 0, SEEK_END);
+   len = (int) ftell(file);
+   fseek(file, 0, SEEK_SET);
+   data = (unsigned char *) malloc(len);
+   if (!data || fread(data, 1, len, file) != (size_t) len) {
+      fclose(file);
+      free(data);
+      printf("%s: can't read\n", file_name);
+      return 1;
+   }
+   fclose(file);
+
+   stb_vorbis_set_simd_level(STB_VORBIS_SIMD_NONE);
+   ref = check_decode(data, len, &ref_len);
+   if (!ref) {
+      printf("%s: can't decode\n", file_name);
+      free(data);
+      return 1;
+   }
+
+   printf("%s: %d samples, scalar", file_name, ref_len);
+   for (level = STB_VORBIS_SIMD_SSE2; level <= max_level; ++level) {
+      int num_floats = 0;
+      float *output;
+      stb_vorbis_set_simd_level(level);
+      output = check_decode(data, len, &num_floats);
+      if (!output || num_floats != ref_len || memcmp(ref, output, sizeof(float) * ref_len)) {
+         printf(", %s MISMATCH", level_names[level]);
+         failed = 1;
+      } else {
+         printf(", %s identical", level_names[level]);
+      }
+      free(output);
+   }
+   printf("\n");
+
+   stb_vorbis_set_simd_level(max_level);
+   free(ref);
+   free(data);
+   return failed;
+}
+
+int main(int argc, char **argv)
+{
+   int i, failed = check_imdct();
+   for (i = 1; i < argc; ++i)
+      failed |= check_stream(argv[i]);
+   printf(failed ? "FAILED\n" : "OK\n");
+   return failed;
+}
@@ -2,25 +2,28 @@
 #include "LibVorbis.h"
 #include "AudioException.h"
 #include "VorbisAudioStream.h"
+#include "VorbisSetup.h"
 
 namespace Audio
 {
 
-    VorbisAudioStream::VorbisAudioStream(const AudioBufferPtr& buffer, const  AudioFormat& format)
-        : AudioStreamBase( buffer, format )
+    VorbisAudioStream::VorbisAudioStream(const AudioMemory& memory, const  AudioFormat& format)
+        : VorbisAudioStream( VorbisSetup::Acquire( memory ), format )
+    {
+    }
+
+    VorbisAudioStream::VorbisAudioStream(const VorbisSetupPtr& setup, const  AudioFormat& format)
+        : AudioStreamBase( setup->getMemory(), format )
+        , m_setup( setup )
         , m_decoder( nullptr )
     {
-        int error;
-        m_decoder = stb_vorbis_open_memory( reinterpret_cast<const std::uint8_t*>( buffer->data()), (int)buffer->size(), &error, nullptr);
-        if (!m_decoder)
-            throw AudioException("Unable To Create Ogg Decoder");
+        m_decoder = m_setup->openDecoder();
     }
 
     VorbisAudioStream::~VorbisAudioStream()
     {
         if (m_decoder) {
-            auto* vorbis = static_cast<stb_vorbis*>(m_decoder);
-            stb_vorbis_close(vorbis);
+            m_setup->closeDecoder(m_decoder);
             m_decoder = nullptr;
         }
     }
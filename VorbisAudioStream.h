@@ -1,6 +1,7 @@
 #pragma once
 
 #include "AudioStream.h"
+#include "VorbisSetupPtr.h"
 
 
 namespace Audio
@@ -9,14 +10,16 @@ namespace Audio
     class VorbisAudioStream : public AudioStreamBase
     {
     public:
-        VorbisAudioStream(const AudioBufferPtr& buffer, const  AudioFormat& format);
+        VorbisAudioStream(const AudioMemory& memory, const  AudioFormat& format);
+        VorbisAudioStream(const VorbisSetupPtr& setup, const  AudioFormat& format);
         virtual ~VorbisAudioStream();
                
         bool            seek( std::uint32_t sample ) final override;
         std::uint32_t   getData( void* dest, std::uint32_t numBytes )  final override;
         
     private:
-        void* m_decoder;
+        VorbisSetupPtr  m_setup; //shared tables, must outlive the decoder
+        void*           m_decoder;
     };
 
 
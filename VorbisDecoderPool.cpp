@@ -0,0 +1,108 @@
+#include <algorithm>
+
+#include "AudioMemoryStats.h"
+#include "VorbisDecoderPool.h"
+
+using namespace Common;
+
+namespace Audio
+{
+    namespace
+    {
+        constexpr std::uint32_t ARENA_ALIGNMENT = 64;
+    }
+
+    VorbisDecoderPool::VorbisDecoderPool(std::uint32_t arenaBytes, std::uint32_t numArenas)
+        : m_arenaBytes( (arenaBytes + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1) )
+    {
+        m_stats.m_arenaBytes = m_arenaBytes;
+        reserve(numArenas);
+    }
+
+    VorbisDecoderPool::~VorbisDecoderPool()
+    {
+        for (const auto& slab : m_slabs)
+            TrackAudioFree(AUDIO_MEMORY_DECODER, getSlabSize(slab.m_numArenas));
+    }
+
+    void VorbisDecoderPool::reserve(std::uint32_t numArenas)
+    {
+        LockGuard lock(m_mutex);
+        if (numArenas <= m_stats.m_capacity)
+            return;
+
+        const auto numNew = numArenas - m_stats.m_capacity;
+        Slab slab;
+        //over-allocate so every arena in the slab can be aligned
+        slab.m_memory.reset(new char[getSlabSize(numNew)]);
+        TrackAudioAlloc(AUDIO_MEMORY_DECODER, getSlabSize(numNew));
+        const auto addr = reinterpret_cast<std::uintptr_t>(slab.m_memory.get());
+        slab.m_first = slab.m_memory.get() + ((ARENA_ALIGNMENT - (addr & (ARENA_ALIGNMENT - 1))) & (ARENA_ALIGNMENT - 1));
+        slab.m_numArenas = numNew;
+
+        //free list never grows beyond capacity, so release() does not allocate
+        m_freeArenas.reserve(numArenas);
+        for (std::uint32_t i = 0; i < numNew; ++i)
+            m_freeArenas.push_back(slab.m_first + std::size_t(i) * m_arenaBytes);
+
+        m_slabs.push_back(std::move(slab));
+        m_stats.m_capacity = numArenas;
+    }
+
+    char* VorbisDecoderPool::acquire()
+    {
+        LockGuard lock(m_mutex);
+        if (m_freeArenas.empty())
+            return nullptr;
+
+        auto* arena = m_freeArenas.back();
+        m_freeArenas.pop_back();
+        m_stats.m_inUse++;
+        m_stats.m_highWater = std::max(m_stats.m_highWater, m_stats.m_inUse);
+        return arena;
+    }
+
+    void VorbisDecoderPool::release(char* arena)
+    {
+        LockGuard lock(m_mutex);
+        m_freeArenas.push_back(arena);
+        m_stats.m_inUse--;
+    }
+
+    void VorbisDecoderPool::onAcquireFailed()
+    {
+        LockGuard lock(m_mutex);
+        m_stats.m_failedAcquisitions++;
+    }
+
+    char* VorbisDecoderPool::findArena(const void* ptr) const
+    {
+        LockGuard lock(m_mutex);
+        const auto* bytePtr = static_cast<const char*>(ptr);
+        for (const auto& slab : m_slabs)
+        {
+            const auto* end = slab.m_first + std::size_t(slab.m_numArenas) * m_arenaBytes;
+            if (bytePtr < slab.m_first || bytePtr >= end)
+                continue;
+            const auto index = std::size_t(bytePtr - slab.m_first) / m_arenaBytes;
+            return slab.m_first + index * m_arenaBytes;
+        }
+        return nullptr;
+    }
+
+    std::size_t VorbisDecoderPool::getSlabSize(std::uint32_t numArenas) const
+    {
+        return std::size_t(numArenas) * m_arenaBytes + ARENA_ALIGNMENT;
+    }
+
+    std::uint32_t VorbisDecoderPool::getArenaSize() const
+    {
+        return m_arenaBytes;
+    }
+
+    VorbisPoolStats VorbisDecoderPool::getStats() const
+    {
+        LockGuard lock(m_mutex);
+        return m_stats;
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <Common/Thread.h>
+
+namespace Audio
+{
+    constexpr std::uint32_t VORBIS_DEFAULT_POOL_SIZE = 4;
+
+    struct VorbisPoolStats
+    {
+        std::uint32_t   m_capacity           = 0; //# preallocated arenas
+        std::uint32_t   m_inUse              = 0;
+        std::uint32_t   m_highWater          = 0; //max # arenas in use at once
+        std::uint32_t   m_failedAcquisitions = 0; //# decoders that fell back to the heap
+        std::uint32_t   m_arenaBytes         = 0; //size of a single arena
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Preallocated, recycled stb_vorbis_alloc arenas of a fixed size,
+    // so opening/closing a decoder on the audio path does not hit the heap
+    //////////////////////////////////////////////////////////////////////////
+    class VorbisDecoderPool
+    {
+    public:
+        VorbisDecoderPool( std::uint32_t arenaBytes, std::uint32_t numArenas = VORBIS_DEFAULT_POOL_SIZE );
+        ~VorbisDecoderPool();
+
+        VorbisDecoderPool( const VorbisDecoderPool& ) = delete;
+        VorbisDecoderPool& operator = ( const VorbisDecoderPool& ) = delete;
+
+        /*
+            @brief: Preallocate arenas until at least 'numArenas' exist, should
+            not be called from the audio thread
+        */
+        void                reserve( std::uint32_t numArenas );
+
+        /*
+            @brief: Returns a free arena or nullptr when exhausted
+        */
+        char*               acquire();
+        void                release( char* arena );
+
+        /*
+            @brief: Records a decoder that could not be served from the pool
+        */
+        void                onAcquireFailed();
+
+        /*
+            @brief: Returns the arena that contains 'ptr', nullptr if 'ptr' is
+            not pool memory( e.g. a heap fallback decoder )
+        */
+        char*               findArena( const void* ptr ) const;
+        std::uint32_t       getArenaSize() const;
+        VorbisPoolStats     getStats() const;
+
+    private:
+        std::size_t         getSlabSize( std::uint32_t numArenas ) const;
+
+        struct Slab
+        {
+            std::unique_ptr<char[]> m_memory;
+            char*                   m_first;     //first aligned arena
+            std::uint32_t           m_numArenas;
+        };
+
+        mutable Common::Mutex   m_mutex;
+        std::vector<Slab>       m_slabs;
+        std::vector<char*>      m_freeArenas;
+        std::uint32_t           m_arenaBytes;
+        VorbisPoolStats         m_stats;
+    };
+}
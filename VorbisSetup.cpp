@@ -0,0 +1,312 @@
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <Common/Thread.h>
+
+#define STB_VORBIS_HEADER_ONLY
+#include "LibVorbis.h"
+#include "AudioException.h"
+#include "AudioMemoryStats.h"
+#include "VorbisSetup.h"
+
+using namespace Common;
+
+namespace Audio
+{
+    namespace
+    {
+        //setups that are still referenced by a file or stream, keyed by the memory they parse
+        using SetupCache = std::unordered_map<const void*, std::weak_ptr<VorbisSetup>>;
+
+        Mutex       g_setupCacheMutex;
+        SetupCache  g_setupCache;
+
+        //ranges shorter than this are not worth a worker thread
+        constexpr std::uint32_t MIN_DECODE_RANGE_SECONDS = 4;
+
+        constexpr std::size_t   OGG_PAGE_HEADER_SIZE     = 27;
+        constexpr std::uint64_t OGG_NO_GRANULE           = ~std::uint64_t(0);
+
+        //granule position( last sample ) of every audio page, in stream order
+        std::vector<std::uint64_t> GetPageGranules(const AudioMemory& memory)
+        {
+            std::vector<std::uint64_t> result;
+            const auto* data = reinterpret_cast<const std::uint8_t*>( memory.m_data );
+            const auto  size = memory.m_size;
+
+            std::size_t pos = 0;
+            while (pos + OGG_PAGE_HEADER_SIZE <= size && memcmp(&data[pos], "OggS", 4) == 0)
+            {
+                const std::size_t numSegments = data[pos + 26];
+                const std::size_t headerSize  = OGG_PAGE_HEADER_SIZE + numSegments;
+                if (pos + headerSize > size)
+                    break;
+
+                std::size_t bodySize = 0;
+                for (std::size_t i = 0; i < numSegments; ++i)
+                    bodySize += data[pos + OGG_PAGE_HEADER_SIZE + i];
+
+                std::uint64_t granule = 0;
+                for (int i = 7; i >= 0; --i)
+                    granule = (granule << 8) | data[pos + 6 + i];
+
+                //header pages have granule 0, pages without a packet end have none
+                if (granule != 0 && granule != OGG_NO_GRANULE)
+                    result.push_back(granule);
+
+                pos += headerSize + bodySize;
+            }
+            return result;
+        }
+
+        bool DecodeRange(stb_vorbis* vorbis, std::uint32_t numChannels, std::uint32_t start, std::uint32_t end, short* dest)
+        {
+            if (start && stb_vorbis_seek(vorbis, start) != 1)
+                return false;
+
+            auto remaining = end - start;
+            while (remaining)
+            {
+                const auto numShorts = int(std::min<std::uint32_t>(remaining, 1u << 16) * numChannels);
+                const auto samples   = stb_vorbis_get_samples_short_interleaved(vorbis, numChannels, dest, numShorts);
+                if (samples <= 0)
+                    return false;
+                dest      += samples * numChannels;
+                remaining -= samples;
+            }
+            return true;
+        }
+    }
+
+    VorbisSetup::VorbisSetup(const AudioMemory& memory, std::uint32_t totalSamples)
+        : m_memory( memory )
+        , m_setup( nullptr )
+        , m_totalSamples( totalSamples )
+    {
+        if (memory.empty())
+            throw AudioException("Empty Audio Buffer");
+
+        int error;
+        auto* vorbis = stb_vorbis_open_memory( reinterpret_cast<const std::uint8_t*>( memory.m_data ), (int)memory.m_size, &error, nullptr);
+        if (!vorbis || error)
+            throw AudioException("Not A Vorbis File");
+
+        //resolve the length once, shared decoders inherit it instead of seeking to the last page
+        if (!m_totalSamples)
+            m_totalSamples = stb_vorbis_stream_length_in_samples(vorbis);
+        m_setup = vorbis;
+        m_pool  = std::make_unique<VorbisDecoderPool>( stb_vorbis_get_shared_memory_required(vorbis) );
+        TrackAudioAlloc(AUDIO_MEMORY_DECODER, stb_vorbis_get_info(vorbis).setup_memory_required);
+    }
+
+    VorbisSetup::~VorbisSetup()
+    {
+        if (m_setup) {
+            TrackAudioFree(AUDIO_MEMORY_DECODER, stb_vorbis_get_info(static_cast<stb_vorbis*>(m_setup)).setup_memory_required);
+            stb_vorbis_close(static_cast<stb_vorbis*>(m_setup));
+            m_setup = nullptr;
+        }
+    }
+
+    VorbisSetupPtr VorbisSetup::Acquire(const AudioMemory& memory, std::uint32_t totalSamples)
+    {
+        LockGuard lock(g_setupCacheMutex);
+        auto it = g_setupCache.find(memory.m_data);
+        if (it != std::end(g_setupCache))
+        {
+            if (auto setup = it->second.lock())
+                return setup;
+        }
+
+        auto setup = std::make_shared<VorbisSetup>(memory, totalSamples);
+        //drop entries of assets that have been unloaded
+        for (auto iter = std::begin(g_setupCache); iter != std::end(g_setupCache); )
+        {
+            if (iter->second.expired())
+                iter = g_setupCache.erase(iter);
+            else
+                ++iter;
+        }
+        g_setupCache[memory.m_data] = setup;
+        return setup;
+    }
+
+    VorbisPoolStats VorbisSetup::GetPoolStats()
+    {
+        VorbisPoolStats result;
+        LockGuard lock(g_setupCacheMutex);
+        for (const auto& iter : g_setupCache)
+        {
+            auto setup = iter.second.lock();
+            if (!setup)
+                continue;
+            const auto stats = setup->getPoolStats();
+            result.m_capacity           += stats.m_capacity;
+            result.m_inUse              += stats.m_inUse;
+            result.m_highWater          += stats.m_highWater;
+            result.m_failedAcquisitions += stats.m_failedAcquisitions;
+            result.m_arenaBytes         += stats.m_arenaBytes * stats.m_capacity;
+        }
+        return result;
+    }
+
+    void* VorbisSetup::openDecoder() const
+    {
+        int error;
+        const auto* data   = reinterpret_cast<const std::uint8_t*>( m_memory.m_data );
+        const auto  size   = (int)m_memory.m_size;
+        const auto* setup  = static_cast<const stb_vorbis*>(m_setup);
+
+        stb_vorbis* vorbis = nullptr;
+        if (auto* arena = m_pool->acquire())
+        {
+            stb_vorbis_alloc alloc;
+            alloc.alloc_buffer = arena;
+            alloc.alloc_buffer_length_in_bytes = (int)m_pool->getArenaSize();
+            vorbis = stb_vorbis_open_memory_shared( data, size, setup, &error, &alloc );
+            if (!vorbis)
+                m_pool->release(arena);
+        }
+        else
+        {
+            m_pool->onAcquireFailed();
+            vorbis = stb_vorbis_open_memory_shared( data, size, setup, &error, nullptr );
+            if (vorbis)
+                TrackAudioAlloc(AUDIO_MEMORY_DECODER, m_pool->getArenaSize());
+        }
+
+        if (!vorbis)
+            throw AudioException("Unable To Create Ogg Decoder");
+        return vorbis;
+    }
+
+    void VorbisSetup::closeDecoder(void* decoder) const
+    {
+        //arena decoders live inside their arena, find it before the decoder is gone
+        auto* arena = m_pool->findArena(decoder);
+        stb_vorbis_close(static_cast<stb_vorbis*>(decoder));
+        if (arena)
+            m_pool->release(arena);
+        else
+            TrackAudioFree(AUDIO_MEMORY_DECODER, m_pool->getArenaSize());
+    }
+
+    void VorbisSetup::reserveDecoders(std::uint32_t numDecoders)
+    {
+        m_pool->reserve(numDecoders);
+    }
+
+    VorbisPoolStats VorbisSetup::getPoolStats() const
+    {
+        return m_pool->getStats();
+    }
+
+    AudioBufferPtr VorbisSetup::decodeAll(std::uint32_t maxThreads) const
+    {
+        const auto numChannels = getNumChannels();
+        const auto sampleRate  = getSampleRate();
+        if (!m_totalSamples)
+            throw AudioException("Unknown Vorbis Stream Length");
+
+        //split evenly by sample count, moved forward to the next page end so
+        //every range starts on a page boundary
+        if (!maxThreads)
+            maxThreads = std::max(1u, std::thread::hardware_concurrency());
+        const auto maxRanges = std::max(1u, m_totalSamples / (sampleRate * MIN_DECODE_RANGE_SECONDS));
+        const auto numRanges = std::min(maxThreads, maxRanges);
+
+        std::vector<std::uint32_t> bounds = { 0 };
+        if (numRanges > 1)
+        {
+            const auto granules = GetPageGranules(m_memory);
+            for (std::uint32_t i = 1; i < numRanges; ++i)
+            {
+                const auto target = std::uint64_t(m_totalSamples) * i / numRanges;
+                auto iter = std::lower_bound(std::begin(granules), std::end(granules), target);
+                if (iter != std::end(granules) && *iter > bounds.back() && *iter < m_totalSamples)
+                    bounds.push_back(static_cast<std::uint32_t>(*iter));
+            }
+        }
+        bounds.push_back(m_totalSamples);
+
+        auto result = std::make_shared<AudioBuffer>( std::size_t(m_totalSamples) * numChannels * sizeof(short) );
+        auto* dest  = reinterpret_cast<short*>( result->data() );
+
+        //each worker seeks its own decoder to the range start, the seek primes
+        //the overlap window from the previous packet so the seams are exact
+        //anything a worker throws is rethrown here once every worker joined
+        const auto numWorkers = bounds.size() - 1;
+        std::vector<char> succeeded(numWorkers, 0);
+        std::vector<std::exception_ptr> errors(numWorkers);
+        auto decodeRange = [&](std::size_t i)
+        {
+            try
+            {
+                auto* vorbis = openDecoder();
+                succeeded[i] = DecodeRange(static_cast<stb_vorbis*>(vorbis), numChannels, bounds[i], bounds[i + 1], dest + std::size_t(bounds[i]) * numChannels);
+                closeDecoder(vorbis);
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        };
+
+        //a range no thread could be started for is decoded on this one
+        std::vector<std::thread> workers;
+        workers.reserve(numWorkers - 1);
+        for (std::size_t i = 1; i < numWorkers; ++i)
+        {
+            try
+            {
+                workers.emplace_back(decodeRange, i);
+            }
+            catch (const std::system_error&)
+            {
+                decodeRange(i);
+            }
+        }
+        decodeRange(0);
+        for (auto& worker : workers)
+            worker.join();
+
+        for (const auto& error : errors) {
+            if (error)
+                std::rethrow_exception(error);
+        }
+        if (std::find(std::begin(succeeded), std::end(succeeded), 0) != std::end(succeeded))
+            throw AudioException("Unable To Decode Vorbis Stream");
+        return result;
+    }
+
+    const AudioMemory& VorbisSetup::getMemory() const
+    {
+        return m_memory;
+    }
+
+    std::uint32_t VorbisSetup::getSampleRate() const
+    {
+        return stb_vorbis_get_info(static_cast<stb_vorbis*>(m_setup)).sample_rate;
+    }
+
+    std::uint32_t VorbisSetup::getNumChannels() const
+    {
+        return static_cast<std::uint32_t>(stb_vorbis_get_info(static_cast<stb_vorbis*>(m_setup)).channels);
+    }
+
+    std::uint32_t VorbisSetup::getTotalSamples() const
+    {
+        return m_totalSamples;
+    }
+
+    float VorbisSetup::getTotalLength() const
+    {
+        const auto sampleRate = getSampleRate();
+        return sampleRate ? m_totalSamples / float(sampleRate) : 0.0f;
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+
+#include "AudioBuffer.h"
+#include "VorbisDecoderPool.h"
+#include "VorbisSetupPtr.h"
+
+namespace Audio
+{
+    //////////////////////////////////////////////////////////////////////////
+    //\Brief: Parsed Vorbis setup header( codebooks, floors, residues, mdct
+    // tables ) of a single asset, shared read-only by all streams decoding it
+    //////////////////////////////////////////////////////////////////////////
+    class VorbisSetup
+    {
+    public:
+        /*
+            @brief: A non zero 'totalSamples', e.g. from the metadata cache, is
+            trusted and spares the search for the last page. Decoders then
+            resolve the last page themselves on their first seek
+        */
+        VorbisSetup( const AudioMemory& memory, std::uint32_t totalSamples = 0 );
+        ~VorbisSetup();
+
+        VorbisSetup( const VorbisSetup& ) = delete;
+        VorbisSetup& operator = ( const VorbisSetup& ) = delete;
+
+        /*
+            @brief: Returns the setup for 'memory', parses the headers only if no
+            other live stream or file already did so
+        */
+        static VorbisSetupPtr   Acquire( const AudioMemory& memory, std::uint32_t totalSamples = 0 );
+
+        /*
+            @brief: Aggregated arena pool statistics of all loaded assets
+        */
+        static VorbisPoolStats  GetPoolStats();
+
+        /*
+            @brief: Creates a decoder that borrows the shared tables, must be
+            released with 'closeDecoder'. The decoder memory comes from a
+            recycled arena, or from the heap when the pool is exhausted
+        */
+        void*                   openDecoder() const;
+        void                    closeDecoder( void* decoder ) const;
+
+        /*
+            @brief: Preallocate arenas for 'numDecoders' simultaneous streams
+        */
+        void                    reserveDecoders( std::uint32_t numDecoders );
+        VorbisPoolStats         getPoolStats() const;
+
+        /*
+            @brief: Decodes the whole asset to interleaved s16 pcm. The
+            bitstream is split on page boundaries and the ranges are decoded
+            on up to 'maxThreads' workers( 0 = one per core ), each with its
+            own decoder. Throws AudioException if any range fails to decode
+        */
+        AudioBufferPtr          decodeAll( std::uint32_t maxThreads = 0 ) const;
+
+        const AudioMemory&      getMemory() const;
+        std::uint32_t           getSampleRate() const;
+        std::uint32_t           getNumChannels() const;
+        std::uint32_t           getTotalSamples() const;
+        float                   getTotalLength() const;
+
+    private:
+        AudioMemory             m_memory; //decoder reads from this memory
+        void*                   m_setup;
+        std::unique_ptr<VorbisDecoderPool> m_pool;
+        std::uint32_t           m_totalSamples;
+    };
+}
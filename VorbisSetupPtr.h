@@ -0,0 +1,8 @@
+#pragma once
+#include <memory>
+
+namespace Audio
+{
+    class VorbisSetup;
+    using VorbisSetupPtr = std::shared_ptr<VorbisSetup>;
+}
@@ -3,6 +3,7 @@
 #include "AudioBuffer.h"
 #include "AudioHelper.h"
 #include "AudioException.h"
+#include "AudioMemoryStats.h"
 #include "WavFile.h"
 
 using namespace IO;
@@ -43,10 +44,30 @@ namespace Audio
        m_waveData->resize(m_header.m_dataLength);       
        succeed = fis.readData(m_waveData->data(), m_waveData->size()) == m_header.m_dataLength;       
        m_totalLength = GetLength( std::uint32_t(m_waveData->size()), m_header.m_frequency, m_header.m_bits / 8);     
+       m_waveData = TrackAudioBuffer( m_waveData, AUDIO_MEMORY_ASSET, fileName );
 
        return succeed;
 
     }
 
+    eAudioFormat WavFile::getSampleFormat() const
+    {
+        constexpr std::uint16_t WAVE_FORMAT_PCM        = 1;
+        constexpr std::uint16_t WAVE_FORMAT_IEEE_FLOAT = 3;
+        if (m_header.m_format == WAVE_FORMAT_IEEE_FLOAT && m_header.m_bits == 32)
+            return audio_format_f32;
+        if (m_header.m_format != WAVE_FORMAT_PCM)
+            return audio_format_unknown;
+
+        switch (m_header.m_bits)
+        {
+        case 8:  return audio_format_u8;
+        case 16: return audio_format_s16;
+        case 24: return audio_format_s24;
+        case 32: return audio_format_s32;
+        default: return audio_format_unknown;
+        }
+    }
+
 }
 
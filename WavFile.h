@@ -2,6 +2,7 @@
 #include <string>
 #include <vector>
 #include "AudioFileBase.h"
+#include "eAudioFormat.h"
 
 
 namespace Audio
@@ -33,6 +34,12 @@ namespace Audio
 
         bool                read(const std::string& fileName);     
 
+        /*
+            @brief: Sample format of the data chunk, audio_format_unknown if it
+            is not plain pcm or float
+        */
+        eAudioFormat        getSampleFormat() const;
+
 
        
         WaveHeader          m_header;   